@@ -0,0 +1,223 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QObject>
+#include <QTest>
+
+#include <cstdlib>
+
+#include "blurhash.h"
+#include "blurhashimageprovider.h"
+
+using namespace Qt::StringLiterals;
+
+static const char testBlurhash[] = "LEHV6nWB2yk8pyo0adR*.7kCMdnj";
+
+class BlurhashTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void invalid();
+    void decodePixels_data();
+    void decodePixels();
+    void decodeAlpha();
+    void encode();
+    void encodeInvalid();
+    void providerCache();
+    void providerScaled();
+    void providerScaledEvicted();
+    void providerCacheSize();
+
+    void decodeBenchmark_data();
+    void decodeBenchmark();
+    void encodeBenchmark();
+    void providerBenchmark();
+};
+
+void BlurhashTest::invalid()
+{
+    QVERIFY(!isValidBlurhash("LEHV6n"));
+    QVERIFY(!decode("LEHV6n", 32, 32, 1, 3));
+}
+
+void BlurhashTest::decodePixels_data()
+{
+    QTest::addColumn<int>("x");
+    QTest::addColumn<int>("y");
+    QTest::addColumn<int>("r");
+    QTest::addColumn<int>("g");
+    QTest::addColumn<int>("b");
+
+    // Values from the reference implementation evaluating cos() for every pixel.
+    QTest::newRow("top left") << 0 << 0 << 135 << 164 << 177;
+    QTest::newRow("centre") << 16 << 16 << 158 << 125 << 108;
+    QTest::newRow("bottom right") << 31 << 31 << 133 << 142 << 147;
+    QTest::newRow("bottom left") << 5 << 27 << 141 << 144 << 143;
+    QTest::newRow("top right") << 27 << 5 << 144 << 164 << 175;
+}
+
+// The lookup tables may round differently to the reference implementation but never by more than 1.
+void BlurhashTest::decodePixels()
+{
+    QFETCH(int, x);
+    QFETCH(int, y);
+    QFETCH(int, r);
+    QFETCH(int, g);
+    QFETCH(int, b);
+
+    uint8_t *pixels = decode(testBlurhash, 32, 32, 1, 3);
+    QVERIFY(pixels);
+    const uint8_t *pixel = pixels + (y * 32 + x) * 3;
+    QVERIFY(std::abs(pixel[0] - r) <= 1);
+    QVERIFY(std::abs(pixel[1] - g) <= 1);
+    QVERIFY(std::abs(pixel[2] - b) <= 1);
+    free(pixels);
+}
+
+void BlurhashTest::decodeAlpha()
+{
+    uint8_t *pixels = decode(testBlurhash, 7, 5, 1, 4);
+    QVERIFY(pixels);
+    for (int i = 0; i < 7 * 5; i++) {
+        QCOMPARE(pixels[i * 4 + 3], uint8_t(255));
+    }
+    free(pixels);
+}
+
+// Encoding a decoded blurhash must match the reference implementation.
+void BlurhashTest::encode()
+{
+    uint8_t *pixels = decode(testBlurhash, 32, 32, 1, 4);
+    QVERIFY(pixels);
+    const auto hash = ::encode(pixels, 32, 32, 32 * 4, 4, 4, 3);
+    free(pixels);
+    QCOMPARE(hash, std::string("LIHV6ot875tRyZj[WBWq%gj[VsjZ"));
+    QVERIFY(isValidBlurhash(hash.c_str()));
+
+    pixels = decode(testBlurhash, 32, 32, 1, 3);
+    QCOMPARE(::encode(pixels, 32, 32, 32 * 3, 3, 1, 1), std::string("00HV6o"));
+    free(pixels);
+}
+
+void BlurhashTest::encodeInvalid()
+{
+    const uint8_t pixel[3] = {0, 0, 0};
+    QVERIFY(::encode(pixel, 1, 1, 3, 3, 0, 1).empty());
+    QVERIFY(::encode(pixel, 1, 1, 3, 3, 1, 10).empty());
+    QVERIFY(::encode(pixel, 0, 1, 3, 3, 1, 1).empty());
+    QVERIFY(::encode(nullptr, 1, 1, 3, 3, 1, 1).empty());
+}
+
+void BlurhashTest::providerCache()
+{
+    BlurhashImageProvider provider;
+    QSize size;
+    const auto image = provider.requestImage(QString::fromLatin1(testBlurhash), &size, QSize(32, 32));
+    QCOMPARE(size, QSize(32, 32));
+    QCOMPARE(image.size(), QSize(32, 32));
+    QCOMPARE(provider.misses(), 1ull);
+    QCOMPARE(provider.hits(), 0ull);
+
+    const auto cachedImage = provider.requestImage(QString::fromLatin1(testBlurhash), &size, QSize(32, 32));
+    QCOMPARE(cachedImage, image);
+    QCOMPARE(provider.misses(), 1ull);
+    QCOMPARE(provider.hits(), 1ull);
+    QCOMPARE(provider.hitRate(), 0.5);
+
+    // A different hash must never be served from the cache.
+    provider.requestImage(u"L6PZfSi_.AyE_3t7t7R**0o#DgR4"_s, &size, QSize(32, 32));
+    QCOMPARE(provider.misses(), 2ull);
+    QCOMPARE(provider.scaledHits(), 0ull);
+}
+
+void BlurhashTest::providerScaled()
+{
+    BlurhashImageProvider provider;
+    QSize size;
+    provider.requestImage(QString::fromLatin1(testBlurhash), &size, QSize(128, 128));
+    QCOMPARE(provider.misses(), 1ull);
+
+    const auto image = provider.requestImage(QString::fromLatin1(testBlurhash), &size, QSize(256, 192));
+    QCOMPARE(image.size(), QSize(256, 192));
+    QCOMPARE(provider.misses(), 1ull);
+    QCOMPARE(provider.scaledHits(), 1ull);
+
+    // The scaled image is cached for the next request at the same size.
+    provider.requestImage(QString::fromLatin1(testBlurhash), &size, QSize(256, 192));
+    QCOMPARE(provider.hits(), 1ull);
+
+    // Too small a decode can't be scaled up.
+    provider.requestImage(u"L6PZfSi_.AyE_3t7t7R**0o#DgR4"_s, &size, QSize(8, 8));
+    provider.requestImage(u"L6PZfSi_.AyE_3t7t7R**0o#DgR4"_s, &size, QSize(100, 100));
+    QCOMPARE(provider.misses(), 3ull);
+}
+
+void BlurhashTest::providerScaledEvicted()
+{
+    // Room for one 128x128 decode.
+    BlurhashImageProvider provider(128 * 128 * 3);
+    QSize size;
+    provider.requestImage(QString::fromLatin1(testBlurhash), &size, QSize(128, 128));
+    provider.requestImage(u"L6PZfSi_.AyE_3t7t7R**0o#DgR4"_s, &size, QSize(128, 128));
+    QCOMPARE(provider.misses(), 2ull);
+
+    // The first decode was evicted so there's nothing left to scale.
+    const auto image = provider.requestImage(QString::fromLatin1(testBlurhash), &size, QSize(256, 192));
+    QCOMPARE(image.size(), QSize(256, 192));
+    QCOMPARE(provider.misses(), 3ull);
+    QCOMPARE(provider.scaledHits(), 0ull);
+}
+
+void BlurhashTest::providerCacheSize()
+{
+    BlurhashImageProvider provider(64 * 64 * 3 * 2);
+    QSize size;
+    provider.requestImage(QString::fromLatin1(testBlurhash), &size, QSize(64, 64));
+    provider.requestImage(QString::fromLatin1(testBlurhash), &size, QSize(48, 48));
+    QVERIFY(provider.cacheSize() <= provider.maxCacheSize());
+
+    provider.requestImage(QString::fromLatin1(testBlurhash), &size, QSize(64, 32));
+    QVERIFY(provider.cacheSize() <= provider.maxCacheSize());
+
+    provider.setMaxCacheSize(0);
+    QCOMPARE(provider.cacheSize(), qsizetype(0));
+}
+
+void BlurhashTest::decodeBenchmark_data()
+{
+    QTest::addColumn<int>("size");
+
+    QTest::newRow("32x32") << 32;
+    QTest::newRow("256x256") << 256;
+}
+
+void BlurhashTest::decodeBenchmark()
+{
+    QFETCH(int, size);
+
+    QBENCHMARK {
+        free(decode(testBlurhash, size, size, 1, 3));
+    }
+}
+
+void BlurhashTest::encodeBenchmark()
+{
+    uint8_t *pixels = decode(testBlurhash, 32, 32, 1, 3);
+    QBENCHMARK {
+        ::encode(pixels, 32, 32, 32 * 3, 3, 4, 3);
+    }
+    free(pixels);
+}
+
+void BlurhashTest::providerBenchmark()
+{
+    BlurhashImageProvider provider;
+    QSize size;
+    QBENCHMARK {
+        provider.requestImage(QString::fromLatin1(testBlurhash), &size, QSize(256, 256));
+    }
+}
+
+QTEST_GUILESS_MAIN(BlurhashTest)
+#include "blurhashtest.moc"
@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QObject>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <KConfigGroup>
+#include <KSharedConfig>
+
+#include "downloadindex.h"
+
+using namespace Qt::StringLiterals;
+
+class DownloadIndexTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    QTemporaryDir dir;
+    QString existingPath;
+    QString missingPath;
+
+private Q_SLOTS:
+    void initTestCase();
+    void checkStoredDownloads();
+    void addDownload();
+    void removeDownload();
+    void deletedLater();
+    void syncSoon();
+};
+
+void DownloadIndexTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(dir.isValid());
+
+    existingPath = dir.filePath(u"existing.png"_s);
+    QFile file(existingPath);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("png");
+    file.close();
+    missingPath = dir.filePath(u"missing.png"_s);
+
+    // The index reads the stored downloads when first used.
+    auto config = KSharedConfig::openStateConfig(u"neochatdownloads"_s);
+    auto group = config->group(u"downloads"_s);
+    group.deleteGroup();
+    group.writePathEntry(u"kde.org/existing"_s, existingPath);
+    group.writePathEntry(u"kde.org/missing"_s, missingPath);
+    config->sync();
+}
+
+void DownloadIndexTest::checkStoredDownloads()
+{
+    auto &index = DownloadIndex::instance();
+    QSignalSpy spy(&index, &DownloadIndex::downloadChecked);
+
+    // Stored downloads are assumed to exist until they have been checked.
+    QCOMPARE(index.localPath(u"kde.org/existing"_s).value_or(QString()), existingPath);
+    QCOMPARE(index.localPath(u"kde.org/missing"_s).value_or(QString()), missingPath);
+    QVERIFY(!index.isVerified(u"kde.org/existing"_s));
+    QVERIFY(!index.localPath(u"kde.org/unknown"_s));
+
+    QVERIFY(spy.wait());
+    QTRY_COMPARE(spy.count(), 2);
+    for (const auto &arguments : spy) {
+        QCOMPARE(arguments[1].toBool(), arguments[0].toString() == u"kde.org/existing"_s);
+    }
+
+    QVERIFY(index.isVerified(u"kde.org/existing"_s));
+    QCOMPARE(index.localPath(u"kde.org/existing"_s).value_or(QString()), existingPath);
+    QVERIFY(!index.localPath(u"kde.org/missing"_s));
+
+    // Each download is only checked once.
+    QVERIFY(!spy.wait(100));
+    QCOMPARE(spy.count(), 2);
+}
+
+void DownloadIndexTest::addDownload()
+{
+    auto &index = DownloadIndex::instance();
+    const auto path = dir.filePath(u"new.png"_s);
+    index.addDownload(u"kde.org/new"_s, path);
+    QCOMPARE(index.localPath(u"kde.org/new"_s).value_or(QString()), path);
+    QVERIFY(index.isVerified(u"kde.org/new"_s));
+    QCOMPARE(KSharedConfig::openStateConfig(u"neochatdownloads"_s)->group(u"downloads"_s).readPathEntry(u"kde.org/new"_s, QString()), path);
+}
+
+void DownloadIndexTest::removeDownload()
+{
+    auto &index = DownloadIndex::instance();
+    index.removeDownload(u"kde.org/new"_s);
+    QVERIFY(!index.localPath(u"kde.org/new"_s));
+    QVERIFY(!KSharedConfig::openStateConfig(u"neochatdownloads"_s)->group(u"downloads"_s).hasKey(u"kde.org/new"_s));
+}
+
+void DownloadIndexTest::deletedLater()
+{
+    auto &index = DownloadIndex::instance();
+    index.setRecheckInterval(std::chrono::milliseconds(500));
+    const auto path = dir.filePath(u"deleted.png"_s);
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.close();
+
+    index.addDownload(u"kde.org/deleted"_s, path);
+    QCOMPARE(index.localPath(u"kde.org/deleted"_s).value_or(QString()), path);
+
+    // A verified file is trusted until the recheck interval has passed.
+    QVERIFY(QFile::remove(path));
+    QCOMPARE(index.localPath(u"kde.org/deleted"_s).value_or(QString()), path);
+    QTest::qWait(600);
+
+    // It is then checked in the background like a stored download.
+    QSignalSpy spy(&index, &DownloadIndex::downloadChecked);
+    QCOMPARE(index.localPath(u"kde.org/deleted"_s).value_or(QString()), path);
+    QVERIFY(!index.isVerified(u"kde.org/deleted"_s));
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy[0][0].toString(), u"kde.org/deleted"_s);
+    QCOMPARE(spy[0][1].toBool(), false);
+    QVERIFY(!index.localPath(u"kde.org/deleted"_s));
+    QVERIFY(!KSharedConfig::openStateConfig(u"neochatdownloads"_s)->group(u"downloads"_s).hasKey(u"kde.org/deleted"_s));
+
+    // A file that is still there stays.
+    QCOMPARE(index.localPath(u"kde.org/existing"_s).value_or(QString()), existingPath);
+    QTest::qWait(600);
+    spy.clear();
+    QCOMPARE(index.localPath(u"kde.org/existing"_s).value_or(QString()), existingPath);
+    QVERIFY(spy.wait());
+    QCOMPARE(spy[0][1].toBool(), true);
+    QVERIFY(index.isVerified(u"kde.org/existing"_s));
+}
+
+void DownloadIndexTest::syncSoon()
+{
+    auto &index = DownloadIndex::instance();
+    index.addDownload(u"kde.org/synced"_s, dir.filePath(u"synced.png"_s));
+
+    // Written without waiting for the index to be destroyed.
+    QVERIFY(index.isSyncPending());
+    QTRY_VERIFY(!index.isSyncPending());
+}
+
+QTEST_GUILESS_MAIN(DownloadIndexTest)
+#include "downloadindextest.moc"
@@ -0,0 +1,156 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QObject>
+#include <QTest>
+
+#include "emojiindex.h"
+#include "models/emojimodel.h"
+
+using namespace Qt::StringLiterals;
+
+class EmojiIndexTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static EmojiIndex testIndex();
+
+private Q_SLOTS:
+    void search_data();
+    void search();
+    void limit();
+    void emptyFilter();
+    void rank();
+    void emojiModel();
+
+    void buildBenchmark();
+    void searchBenchmark_data();
+    void searchBenchmark();
+};
+
+EmojiIndex EmojiIndexTest::testIndex()
+{
+    EmojiIndex index;
+    index.add(u"grinning"_s, u"grinning face"_s);
+    index.add(u"smile"_s, u"grinning face with smiling eyes"_s);
+    index.add(u"sweat_smile"_s, u"grinning face with sweat"_s);
+    index.add(u"smiley_cat"_s, u"grinning cat"_s);
+    index.add(u"cat"_s, u"cat"_s);
+    index.add(u"Thumbsup"_s, u"thumbs up"_s);
+    return index;
+}
+
+void EmojiIndexTest::search_data()
+{
+    QTest::addColumn<QString>("filter");
+    QTest::addColumn<QList<int>>("results");
+
+    QTest::newRow("exact first") << u"smile"_s << QList<int>{1, 3, 2};
+    QTest::newRow("single character") << u"w"_s << QList<int>{2, 1};
+    QTest::newRow("exact before word prefix") << u"cat"_s << QList<int>{4, 3};
+    QTest::newRow("description") << u"face"_s << QList<int>{0, 1, 2};
+    QTest::newRow("case insensitive") << u"THUMBS"_s << QList<int>{5};
+    QTest::newRow("long filter") << u"with smiling"_s << QList<int>{1};
+    QTest::newRow("no match") << u"xyz"_s << QList<int>{};
+    QTest::newRow("rare trigram missing") << u"grinning dog"_s << QList<int>{};
+}
+
+void EmojiIndexTest::search()
+{
+    QFETCH(QString, filter);
+    QFETCH(QList<int>, results);
+
+    QCOMPARE(testIndex().search(filter), results);
+}
+
+void EmojiIndexTest::limit()
+{
+    const auto index = testIndex();
+    QCOMPARE(index.search(u"grinning"_s, 2), QList<int>({0, 1}));
+    QCOMPARE(index.search(u"grinning"_s, 0), QList<int>());
+    QCOMPARE(index.search(u"grinning"_s).size(), 4);
+}
+
+void EmojiIndexTest::emptyFilter()
+{
+    const auto index = testIndex();
+    QCOMPARE(index.search({}), QList<int>({0, 1, 2, 3, 4, 5}));
+    QCOMPARE(index.search({}, 2), QList<int>({0, 1}));
+
+    EmojiIndex empty;
+    QVERIFY(empty.search({}).isEmpty());
+    QVERIFY(empty.search(u"a"_s).isEmpty());
+}
+
+void EmojiIndexTest::rank()
+{
+    const auto index = testIndex();
+    QCOMPARE(index.rank(1, u"smile"_s), EmojiIndex::ExactName);
+    QCOMPARE(index.rank(3, u"smile"_s), EmojiIndex::NamePrefix);
+    QCOMPARE(index.rank(2, u"smile"_s), EmojiIndex::NameWordPrefix);
+    QCOMPARE(index.rank(3, u"ley"_s), EmojiIndex::NameContains);
+    QCOMPARE(index.rank(0, u"face"_s), EmojiIndex::DescriptionWordPrefix);
+    QCOMPARE(index.rank(0, u"ace"_s), EmojiIndex::DescriptionContains);
+    QCOMPARE(index.rank(4, u"dog"_s), EmojiIndex::NoMatch);
+    QCOMPARE(index.rank(10, u"cat"_s), EmojiIndex::NoMatch);
+}
+
+void EmojiIndexTest::emojiModel()
+{
+    auto &model = EmojiModel::instance();
+    QVERIFY(model.rowCount() > 1000);
+
+    const auto results = EmojiModel::filterModelNoCustom(u"smile"_s);
+    QCOMPARE(results.size(), 10);
+    QCOMPARE(results[0].value<Emoji>().shortName, u"smile"_s);
+
+    const auto all = EmojiModel::filterModelNoCustom(u"smile"_s, false);
+    QVERIFY(all.size() > results.size());
+    for (const auto &result : all) {
+        const auto emoji = result.value<Emoji>();
+        QVERIFY(emoji.shortName.contains(u"smile"_s, Qt::CaseInsensitive) || emoji.description.contains(u"smile"_s, Qt::CaseInsensitive));
+    }
+
+    // Rows come straight from the flat table.
+    QCOMPARE(model.data(model.index(0), EmojiModel::ShortNameRole).toString(), u":grinning:"_s);
+    QVERIFY(!model.data(model.index(model.rowCount()), EmojiModel::ShortNameRole).isValid());
+}
+
+void EmojiIndexTest::buildBenchmark()
+{
+    const auto emojis = EmojiModel::filterModelNoCustom({}, false);
+    QBENCHMARK {
+        EmojiIndex index;
+        index.reserve(emojis.size());
+        for (const auto &variant : emojis) {
+            const auto emoji = variant.value<Emoji>();
+            index.add(emoji.shortName, emoji.description);
+        }
+    }
+}
+
+void EmojiIndexTest::searchBenchmark_data()
+{
+    QTest::addColumn<QString>("filter");
+
+    QTest::newRow("one character") << u"s"_s;
+    QTest::newRow("three characters") << u"smi"_s;
+    QTest::newRow("word") << u"face"_s;
+    QTest::newRow("long") << u"smiling face with"_s;
+    QTest::newRow("no match") << u"zzz"_s;
+}
+
+// Filtering the whole emoji table without a limit, as the emoji picker does.
+void EmojiIndexTest::searchBenchmark()
+{
+    QFETCH(QString, filter);
+
+    EmojiModel::instance();
+    QBENCHMARK {
+        EmojiModel::filterModelNoCustom(filter, false);
+    }
+}
+
+QTEST_GUILESS_MAIN(EmojiIndexTest)
+#include "emojiindextest.moc"
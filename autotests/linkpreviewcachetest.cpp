@@ -0,0 +1,191 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QDir>
+#include <QObject>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "linkpreviewcache.h"
+
+using namespace Qt::StringLiterals;
+
+class LinkPreviewCacheTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static LinkPreviewCache::Preview makePreview(const QString &title, const QDateTime &fetched = QDateTime::currentDateTime());
+
+private Q_SLOTS:
+    void memoryHit();
+    void diskHit();
+    void coalesce();
+    void expired();
+    void memoryLimit();
+    void memoryOnly();
+    void clear();
+};
+
+LinkPreviewCache::Preview LinkPreviewCacheTest::makePreview(const QString &title, const QDateTime &fetched)
+{
+    return {
+        .title = title,
+        .description = u"A description"_s,
+        .imageUrl = QUrl(u"mxc://kde.org/image"_s),
+        .fetched = fetched,
+    };
+}
+
+void LinkPreviewCacheTest::memoryHit()
+{
+    QTemporaryDir dir;
+    LinkPreviewCache cache(dir.path());
+    QSignalSpy spy(&cache, &LinkPreviewCache::previewLoaded);
+    const QUrl url(u"https://kde.org"_s);
+
+    cache.insert(url, makePreview(u"KDE"_s));
+    const auto preview = cache.preview(url, nullptr);
+    QVERIFY(preview);
+    QCOMPARE(preview->title, u"KDE"_s);
+    QCOMPARE(preview->imageUrl, QUrl(u"mxc://kde.org/image"_s));
+    // Answered straight away without a load.
+    QCOMPARE(spy.count(), 0);
+    QCOMPARE(cache.memoryHits(), 1ull);
+    QCOMPARE(cache.hitRate(), 1.0);
+    cache.waitForDisk();
+}
+
+void LinkPreviewCacheTest::diskHit()
+{
+    QTemporaryDir dir;
+    const QUrl url(u"https://kde.org"_s);
+    {
+        LinkPreviewCache cache(dir.path());
+        cache.insert(url, makePreview(u"KDE"_s));
+        cache.waitForDisk();
+    }
+
+    // A new cache, e.g. after a restart, finds it on disk.
+    LinkPreviewCache cache(dir.path());
+    QSignalSpy spy(&cache, &LinkPreviewCache::previewLoaded);
+    QVERIFY(!cache.preview(url, nullptr));
+    QVERIFY(spy.wait());
+    QCOMPARE(spy[0][0].toUrl(), url);
+    QCOMPARE(spy[0][1].value<LinkPreviewCache::Preview>().title, u"KDE"_s);
+
+    // And keeps it in memory from then on.
+    QVERIFY(cache.preview(url, nullptr));
+    QCOMPARE(cache.diskHits(), 1ull);
+    QCOMPARE(cache.memoryHits(), 1ull);
+    QCOMPARE(cache.misses(), 0ull);
+    cache.waitForDisk();
+}
+
+void LinkPreviewCacheTest::coalesce()
+{
+    QTemporaryDir dir;
+    const QUrl url(u"https://kde.org"_s);
+    {
+        LinkPreviewCache cache(dir.path());
+        cache.insert(url, makePreview(u"KDE"_s));
+        cache.waitForDisk();
+    }
+
+    LinkPreviewCache cache(dir.path());
+    QSignalSpy spy(&cache, &LinkPreviewCache::previewLoaded);
+    QVERIFY(!cache.preview(url, nullptr));
+    QVERIFY(!cache.preview(url, nullptr));
+    QVERIFY(!cache.preview(url, nullptr));
+
+    // The three requests share one load.
+    QVERIFY(spy.wait());
+    QVERIFY(!spy.wait(200));
+    QCOMPARE(spy.count(), 1);
+    cache.waitForDisk();
+}
+
+void LinkPreviewCacheTest::expired()
+{
+    QTemporaryDir dir;
+    const QUrl url(u"https://kde.org"_s);
+    {
+        LinkPreviewCache cache(dir.path());
+        cache.insert(url, makePreview(u"KDE"_s, QDateTime::currentDateTime().addSecs(-2 * 60 * 60)));
+        cache.waitForDisk();
+    }
+
+    LinkPreviewCache cache(dir.path());
+    cache.setTimeToLive(std::chrono::hours(1));
+    QSignalSpy spy(&cache, &LinkPreviewCache::previewLoaded);
+
+    // The expired preview on disk is ignored, without a connection the load ends there.
+    QVERIFY(!cache.preview(url, nullptr));
+    QVERIFY(!spy.wait(200));
+    QCOMPARE(cache.diskHits(), 0ull);
+    QCOMPARE(cache.misses(), 1ull);
+    QCOMPARE(cache.hitRate(), 0.0);
+    cache.waitForDisk();
+}
+
+void LinkPreviewCacheTest::memoryLimit()
+{
+    QTemporaryDir dir;
+    LinkPreviewCache cache(dir.path());
+    cache.setMaxMemory(1024);
+    QSignalSpy spy(&cache, &LinkPreviewCache::previewLoaded);
+
+    for (int i = 0; i < 100; ++i) {
+        cache.insert(QUrl(u"https://kde.org/%1"_s.arg(i)), makePreview(u"KDE %1"_s.arg(i)));
+    }
+    cache.waitForDisk();
+
+    // The most recent preview is still in memory, the first only on disk.
+    QVERIFY(cache.preview(QUrl(u"https://kde.org/99"_s), nullptr));
+    QVERIFY(!cache.preview(QUrl(u"https://kde.org/0"_s), nullptr));
+    QVERIFY(spy.wait());
+    QCOMPARE(spy[0][0].toUrl(), QUrl(u"https://kde.org/0"_s));
+    cache.waitForDisk();
+}
+
+void LinkPreviewCacheTest::memoryOnly()
+{
+    QTemporaryDir dir;
+    const QUrl url(u"https://kde.org"_s);
+    {
+        LinkPreviewCache cache(dir.path());
+        cache.insert(url, makePreview(u"KDE"_s), false);
+        QVERIFY(cache.preview(url, nullptr));
+        cache.waitForDisk();
+    }
+    QVERIFY(QDir(dir.path()).entryList(QDir::Files).isEmpty());
+
+    LinkPreviewCache cache(dir.path());
+    QSignalSpy spy(&cache, &LinkPreviewCache::previewLoaded);
+    QVERIFY(!cache.preview(url, nullptr));
+    QVERIFY(!spy.wait(200));
+    cache.waitForDisk();
+}
+
+void LinkPreviewCacheTest::clear()
+{
+    QTemporaryDir dir;
+    const auto path = dir.filePath(u"account"_s);
+    const QUrl url(u"https://kde.org"_s);
+
+    LinkPreviewCache cache(path);
+    cache.insert(url, makePreview(u"KDE"_s));
+    cache.clear();
+    cache.waitForDisk();
+
+    // Removed from memory and disk, including the write queued before clear().
+    QVERIFY(!QDir(path).exists());
+    QSignalSpy spy(&cache, &LinkPreviewCache::previewLoaded);
+    QVERIFY(!cache.preview(url, nullptr));
+    QVERIFY(!spy.wait(200));
+    cache.waitForDisk();
+}
+
+QTEST_GUILESS_MAIN(LinkPreviewCacheTest)
+#include "linkpreviewcachetest.moc"
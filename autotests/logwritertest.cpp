@@ -0,0 +1,184 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: LGPL-2.0-or-later
+
+#include <QDir>
+#include <QFile>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QThread>
+
+#include <memory>
+#include <vector>
+
+#include "logwriter.h"
+
+using namespace Qt::StringLiterals;
+
+class LogWriterTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QByteArray readFile(const QString &path);
+    static QString logPath(const QTemporaryDir &dir, int index);
+
+private Q_SLOTS:
+    void order();
+    void drainOnStop();
+    void rotateOnStart();
+    void rotateOnSize();
+    void queueLimit();
+};
+
+QByteArray LogWriterTest::readFile(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    return file.readAll();
+}
+
+QString LogWriterTest::logPath(const QTemporaryDir &dir, int index)
+{
+    return dir.filePath(u"test.log.%1"_s.arg(index));
+}
+
+void LogWriterTest::order()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LogWriter writer;
+    QVERIFY(writer.start(dir.path(), u"test.log"_s));
+    QCOMPARE(writer.fileName(), logPath(dir, 0));
+
+    constexpr int ThreadCount = 4;
+    constexpr int MessageCount = 5000;
+    std::vector<std::unique_ptr<QThread>> threads;
+    for (int thread = 0; thread < ThreadCount; ++thread) {
+        threads.emplace_back(QThread::create([&writer, thread]() {
+            for (int i = 0; i < MessageCount; ++i) {
+                writer.write(QByteArray::number(thread) + ' ' + QByteArray::number(i) + '\n');
+            }
+        }));
+        threads.back()->start();
+    }
+    for (const auto &thread : threads) {
+        QVERIFY(thread->wait());
+    }
+    writer.flush();
+
+    // The messages of each thread are written in the order they were logged.
+    const auto lines = readFile(logPath(dir, 0)).split('\n');
+    QList<int> next(ThreadCount, 0);
+    int count = 0;
+    for (const auto &line : lines) {
+        if (line.isEmpty()) {
+            continue;
+        }
+        const auto parts = line.split(' ');
+        QCOMPARE(parts.size(), 2);
+        const auto thread = parts[0].toInt();
+        QCOMPARE(parts[1].toInt(), next[thread]);
+        ++next[thread];
+        ++count;
+    }
+    QCOMPARE(count, ThreadCount * MessageCount);
+}
+
+void LogWriterTest::drainOnStop()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LogWriter writer;
+    QVERIFY(writer.start(dir.path(), u"test.log"_s));
+
+    QByteArray expected;
+    for (int i = 0; i < 1000; ++i) {
+        auto message = "message "_ba + QByteArray::number(i) + '\n';
+        expected += message;
+        writer.write(std::move(message));
+    }
+    // Everything queued is written before stop() returns.
+    writer.stop();
+    QCOMPARE(readFile(logPath(dir, 0)), expected);
+
+    // Nothing is written once stopped.
+    writer.write("late\n"_ba);
+    QCOMPARE(readFile(logPath(dir, 0)), expected);
+}
+
+void LogWriterTest::rotateOnStart()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    for (int i = 0; i < 3; ++i) {
+        QFile file(logPath(dir, i));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("old " + QByteArray::number(i) + '\n');
+    }
+
+    LogWriter writer(LogWriter::MaxFileSize, 3);
+    QVERIFY(writer.start(dir.path(), u"test.log"_s));
+    writer.stop();
+
+    // The previous logs moved up by one and the oldest was removed.
+    QCOMPARE(readFile(logPath(dir, 0)), QByteArray());
+    QCOMPARE(readFile(logPath(dir, 1)), "old 0\n"_ba);
+    QCOMPARE(readFile(logPath(dir, 2)), "old 1\n"_ba);
+    QVERIFY(!QFile::exists(logPath(dir, 3)));
+}
+
+void LogWriterTest::rotateOnSize()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LogWriter writer(100, 3);
+    QVERIFY(writer.start(dir.path(), u"test.log"_s));
+
+    // Rotation is checked after each batch, flushing makes every message one.
+    QByteArray expected;
+    for (int i = 0; i < 30; ++i) {
+        auto message = "message "_ba + QByteArray::number(i).rightJustified(2, '0') + '\n';
+        expected += message;
+        writer.write(std::move(message));
+        writer.flush();
+    }
+    writer.stop();
+
+    QVERIFY(!QFile::exists(logPath(dir, 3)));
+    QByteArray written;
+    for (int i = 2; i >= 0; --i) {
+        const auto data = readFile(logPath(dir, i));
+        if (i > 0) {
+            QVERIFY(data.size() >= 100);
+        }
+        written += data;
+    }
+    // The kept files are the newest messages, in order.
+    QVERIFY(!written.isEmpty());
+    QVERIFY(written.size() < expected.size());
+    QVERIFY(expected.endsWith(written));
+}
+
+void LogWriterTest::queueLimit()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LogWriter writer(LogWriter::MaxFileSize, LogWriter::MaxFiles, 10);
+    QVERIFY(writer.start(dir.path(), u"test.log"_s));
+
+    // Larger than the queue, so always dropped.
+    for (int i = 0; i < 3; ++i) {
+        writer.write(QByteArray(20, 'x') + '\n');
+    }
+    writer.stop();
+
+    const auto data = readFile(logPath(dir, 0));
+    QVERIFY(!data.contains('x'));
+    QVERIFY(data.contains("3 log messages were dropped"));
+}
+
+QTEST_GUILESS_MAIN(LogWriterTest)
+#include "logwritertest.moc"
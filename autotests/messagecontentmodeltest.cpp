@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: 2024 James Graham <james.h.graham@protonmail.com>
 // SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
+#include <QJsonArray>
+#include <QJsonObject>
 #include <QObject>
 #include <QSignalSpy>
 #include <QTest>
@@ -10,6 +12,7 @@
 #include <Quotient/roommember.h>
 #include <Quotient/syncdata.h>
 
+#include "models/contentmodeldispatcher.h"
 #include "models/messagecontentmodel.h"
 
 #include "testutils.h"
@@ -28,6 +31,10 @@ private Q_SLOTS:
     void initTestCase();
 
     void missingEvent();
+    void dispatchBenchmark_data();
+    void dispatchBenchmark();
+    void addedMessagesBenchmark_data();
+    void addedMessagesBenchmark();
 };
 
 void MessageContentModelTest::initTestCase()
@@ -57,5 +64,79 @@ void MessageContentModelTest::missingEvent()
     QCOMPARE(model1.data(model1.index(1), MessageContentModel::DisplayRole), u"<b>This is an example<br>text message</b>"_s);
 }
 
+void MessageContentModelTest::dispatchBenchmark_data()
+{
+    QTest::addColumn<int>("modelCount");
+
+    QTest::newRow("10 models") << 10;
+    QTest::newRow("100 models") << 100;
+    QTest::newRow("1000 models") << 1000;
+}
+
+// The cost of a room signal for a single event should stay flat however many content models are alive.
+void MessageContentModelTest::dispatchBenchmark()
+{
+    QFETCH(int, modelCount);
+
+    auto room = new TestUtils::TestRoom(connection, u"#benchmarkRoom%1:kde.org"_s.arg(modelCount), u"test-min-sync.json"_s);
+    std::vector<std::unique_ptr<MessageContentModel>> models;
+    for (int i = 0; i < modelCount; ++i) {
+        models.push_back(std::make_unique<MessageContentModel>(room, u"$%1:example.org"_s.arg(i)));
+    }
+    QCOMPARE(room->contentModelDispatcher()->modelCount(), qsizetype(modelCount));
+
+    QBENCHMARK {
+        for (int i = 0; i < 100; ++i) {
+            Q_EMIT room->updatedEvent(u"$153456789:example.org"_s);
+            Q_EMIT room->fileTransferProgress(u"$153456789:example.org"_s, 1, 2);
+        }
+    }
+
+    models.clear();
+    QCOMPARE(room->contentModelDispatcher()->modelCount(), qsizetype(0));
+}
+
+void MessageContentModelTest::addedMessagesBenchmark_data()
+{
+    dispatchBenchmark_data();
+}
+
+// A sync batch should cost one lookup per event, not one per event and model.
+void MessageContentModelTest::addedMessagesBenchmark()
+{
+    QFETCH(int, modelCount);
+
+    constexpr int BatchSize = 500;
+    auto room = new TestUtils::TestRoom(connection, u"#batchRoom%1:kde.org"_s.arg(modelCount), u"test-min-sync.json"_s);
+    QJsonArray events;
+    for (int i = 0; i < BatchSize; ++i) {
+        events += QJsonObject{
+            {"content"_L1, QJsonObject{{"body"_L1, u"Message %1"_s.arg(i)}, {"msgtype"_L1, "m.text"_L1}}},
+            {"event_id"_L1, u"$batch%1:example.org"_s.arg(i)},
+            {"origin_server_ts"_L1, qint64(1432735824654) + i},
+            {"room_id"_L1, room->id()},
+            {"sender"_L1, "@example:example.org"_L1},
+            {"type"_L1, "m.room.message"_L1},
+        };
+    }
+    room->update(SyncRoomData(room->id(), JoinState::Join, QJsonObject{{"timeline"_L1, QJsonObject{{"events"_L1, events}}}}));
+    QCOMPARE(room->timelineSize(), BatchSize + 1);
+
+    std::vector<std::unique_ptr<MessageContentModel>> models;
+    for (int i = 0; i < modelCount; ++i) {
+        models.push_back(std::make_unique<MessageContentModel>(room, u"$%1:example.org"_s.arg(i)));
+    }
+    QCOMPARE(room->contentModelDispatcher()->modelCount(), qsizetype(modelCount));
+
+    const int toIndex = room->maxTimelineIndex();
+    const int fromIndex = toIndex - BatchSize + 1;
+    QBENCHMARK {
+        Q_EMIT room->addedMessages(fromIndex, toIndex);
+    }
+
+    models.clear();
+    QCOMPARE(room->contentModelDispatcher()->modelCount(), qsizetype(0));
+}
+
 QTEST_MAIN(MessageContentModelTest)
 #include "messagecontentmodeltest.moc"
@@ -0,0 +1,211 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QCoreApplication>
+#include <QObject>
+#include <QPointer>
+#include <QTest>
+
+#include "modelcache.h"
+
+using namespace Qt::StringLiterals;
+
+class TestModel : public QObject
+{
+    Q_OBJECT
+
+public:
+    bool inUse = false;
+
+    [[nodiscard]] bool isInUse() const
+    {
+        return inUse;
+    }
+};
+
+class ModelCacheTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QPointer<TestModel> insert(ModelCache<TestModel> &cache, const QString &key);
+    static void releaseProtection();
+    static void deleteEvicted();
+
+private Q_SLOTS:
+    void cleanup();
+
+    void capacity();
+    void evictionOrder();
+    void inUse();
+    void allInUse();
+    void protectedUntilNextTurn();
+    void take();
+    void globalCapacity();
+};
+
+// Each insert is treated as happening in its own event loop turn.
+QPointer<TestModel> ModelCacheTest::insert(ModelCache<TestModel> &cache, const QString &key)
+{
+    releaseProtection();
+    return cache.insert(key, std::make_unique<TestModel>());
+}
+
+void ModelCacheTest::releaseProtection()
+{
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::MetaCall);
+}
+
+void ModelCacheTest::deleteEvicted()
+{
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+}
+
+void ModelCacheTest::cleanup()
+{
+    ModelCacheBase::setGlobalCapacity(0);
+}
+
+void ModelCacheTest::capacity()
+{
+    ModelCache<TestModel> cache(3);
+    for (int i = 0; i < 5; ++i) {
+        insert(cache, QString::number(i));
+    }
+    QCOMPARE(cache.size(), 3);
+    QCOMPARE(cache.evictions(), 2);
+    QCOMPARE(cache.keys(), (QList<QString>{u"4"_s, u"3"_s, u"2"_s}));
+
+    cache.setCapacity(1);
+    QCOMPARE(cache.keys(), QList<QString>{u"4"_s});
+    QCOMPARE(cache.evictions(), 4);
+}
+
+void ModelCacheTest::evictionOrder()
+{
+    ModelCache<TestModel> cache(3);
+    const auto first = insert(cache, u"a"_s);
+    const auto second = insert(cache, u"b"_s);
+    insert(cache, u"c"_s);
+
+    // Using a model makes it the most recently used.
+    QCOMPARE(cache.object(u"a"_s), first.data());
+    QCOMPARE(cache.keys(), (QList<QString>{u"a"_s, u"c"_s, u"b"_s}));
+
+    insert(cache, u"d"_s);
+    QVERIFY(!cache.contains(u"b"_s));
+    QCOMPARE(cache.keys(), (QList<QString>{u"d"_s, u"a"_s, u"c"_s}));
+
+    // Evicted models are deleted later.
+    QVERIFY(second);
+    deleteEvicted();
+    QVERIFY(!second);
+    QVERIFY(first);
+}
+
+void ModelCacheTest::inUse()
+{
+    ModelCache<TestModel> cache(2);
+    const auto pinned = insert(cache, u"a"_s);
+    pinned->inUse = true;
+    const auto unused = insert(cache, u"b"_s);
+
+    // The oldest model is in use so the next one is evicted instead.
+    insert(cache, u"c"_s);
+    QVERIFY(cache.contains(u"a"_s));
+    QVERIFY(!cache.contains(u"b"_s));
+    deleteEvicted();
+    QVERIFY(pinned);
+    QVERIFY(!unused);
+
+    // Once it is released it can be evicted again.
+    pinned->inUse = false;
+    insert(cache, u"d"_s);
+    insert(cache, u"e"_s);
+    QVERIFY(!cache.contains(u"a"_s));
+    QCOMPARE(cache.size(), 2);
+}
+
+void ModelCacheTest::allInUse()
+{
+    ModelCache<TestModel> cache(2);
+    insert(cache, u"a"_s)->inUse = true;
+    insert(cache, u"b"_s)->inUse = true;
+
+    // Nothing can be evicted so the cache grows, but the new model is kept.
+    const auto newModel = insert(cache, u"c"_s);
+    QCOMPARE(cache.size(), 3);
+    QCOMPARE(cache.evictions(), 0);
+    QCOMPARE(cache.object(u"c"_s), newModel.data());
+}
+
+void ModelCacheTest::protectedUntilNextTurn()
+{
+    ModelCache<TestModel> cache(1);
+    releaseProtection();
+    const auto first = cache.insert(u"a"_s, std::make_unique<TestModel>());
+    cache.insert(u"b"_s, std::make_unique<TestModel>());
+
+    // Both were returned in this turn so may not be connected to yet.
+    QCOMPARE(cache.size(), 2);
+    QCOMPARE(cache.object(u"a"_s), first);
+    QCOMPARE(cache.evictions(), 0);
+
+    // Once the turn is over they can be evicted.
+    insert(cache, u"c"_s);
+    QCOMPARE(cache.keys(), QList<QString>{u"c"_s});
+    QCOMPARE(cache.evictions(), 2);
+}
+
+void ModelCacheTest::take()
+{
+    ModelCache<TestModel> cache(2);
+    insert(cache, u"a"_s);
+    insert(cache, u"b"_s);
+    const auto globalSize = ModelCacheBase::globalSize();
+
+    auto model = cache.take(u"a"_s);
+    QVERIFY(model);
+    QCOMPARE(cache.size(), 1);
+    QCOMPARE(ModelCacheBase::globalSize(), globalSize - 1);
+    QCOMPARE(cache.evictions(), 0);
+
+    cache.clear();
+    QCOMPARE(cache.size(), 0);
+    QCOMPARE(ModelCacheBase::globalSize(), globalSize - 2);
+}
+
+void ModelCacheTest::globalCapacity()
+{
+    ModelCache<TestModel> first;
+    ModelCache<TestModel> second;
+    QCOMPARE(ModelCacheBase::globalSize(), 0);
+    ModelCacheBase::setGlobalCapacity(3);
+
+    insert(first, u"a"_s);
+    insert(second, u"b"_s);
+    insert(first, u"c"_s);
+    first.object(u"a"_s);
+
+    // The least recently used model across both caches is evicted.
+    insert(second, u"d"_s);
+    QCOMPARE(ModelCacheBase::globalSize(), 3);
+    QCOMPARE(first.keys(), (QList<QString>{u"a"_s, u"c"_s}));
+    QCOMPARE(second.keys(), QList<QString>{u"d"_s});
+    QCOMPARE(second.evictions(), 1);
+
+    // Models in use are skipped.
+    first.object(u"c"_s)->inUse = true;
+    insert(second, u"e"_s);
+    QCOMPARE(first.keys(), QList<QString>{u"c"_s});
+    QCOMPARE(second.keys(), (QList<QString>{u"e"_s, u"d"_s}));
+
+    // Lowering the capacity evicts straight away.
+    ModelCacheBase::setGlobalCapacity(2);
+    QCOMPARE(ModelCacheBase::globalSize(), 2);
+    QVERIFY(first.contains(u"c"_s));
+    QVERIFY(!second.contains(u"d"_s));
+}
+
+QTEST_GUILESS_MAIN(ModelCacheTest)
+#include "modelcachetest.moc"
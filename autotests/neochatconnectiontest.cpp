@@ -0,0 +1,143 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QSignalSpy>
+#include <QTest>
+
+#include <Quotient/connection.h>
+#include <Quotient/syncdata.h>
+
+#include "neochatconnection.h"
+#include "neochatroom.h"
+
+using namespace Quotient;
+using namespace Qt::StringLiterals;
+
+class NeoChatConnectionTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QJsonObject roomsSyncJson(int rooms, int notifications, int highlights);
+    static void sync(Connection *connection, const QJsonObject &json);
+
+private Q_SLOTS:
+    void initTestCase();
+    void notificationCounts();
+    void directChatNotifications();
+    void syncStress_data();
+    void syncStress();
+};
+
+QJsonObject NeoChatConnectionTest::roomsSyncJson(int rooms, int notifications, int highlights)
+{
+    QJsonObject joinedRooms;
+    for (int i = 0; i < rooms; ++i) {
+        joinedRooms[u"!room%1:kde.org"_s.arg(i)] = QJsonObject{
+            {"unread_notifications"_L1, QJsonObject{{"notification_count"_L1, notifications}, {"highlight_count"_L1, highlights}}},
+        };
+    }
+    return QJsonObject{{"rooms"_L1, QJsonObject{{"join"_L1, joinedRooms}}}};
+}
+
+void NeoChatConnectionTest::sync(Connection *connection, const QJsonObject &json)
+{
+    SyncData data;
+    data.parseJson(json);
+    connection->onSyncSuccess(std::move(data));
+}
+
+void NeoChatConnectionTest::initTestCase()
+{
+    Connection::setRoomType<NeoChatRoom>();
+}
+
+void NeoChatConnectionTest::notificationCounts()
+{
+    NeoChatConnection connection;
+    QSignalSpy badgeSpy(&connection, &NeoChatConnection::badgeNotificationCountChanged);
+
+    sync(&connection, roomsSyncJson(10, 2, 0));
+    QCOMPARE(connection.homeNotifications(), 20);
+    QCOMPARE(connection.homeHaveHighlightNotifications(), false);
+    QCOMPARE(connection.directChatNotifications(), 0);
+    QCOMPARE(connection.badgeNotificationCount(), 20);
+    QCOMPARE(badgeSpy.last().at(1).toInt(), 20);
+
+    sync(&connection,
+         QJsonObject{{"rooms"_L1,
+                      QJsonObject{{"join"_L1,
+                                   QJsonObject{{u"!room3:kde.org"_s,
+                                                QJsonObject{{"unread_notifications"_L1,
+                                                             QJsonObject{{"notification_count"_L1, 5}, {"highlight_count"_L1, 1}}}}}}}}}});
+    QCOMPARE(connection.homeNotifications(), 23);
+    QCOMPARE(connection.homeHaveHighlightNotifications(), true);
+    QCOMPARE(connection.badgeNotificationCount(), 23);
+
+    sync(&connection, roomsSyncJson(10, 0, 0));
+    QCOMPARE(connection.homeNotifications(), 0);
+    QCOMPARE(connection.homeHaveHighlightNotifications(), false);
+    QCOMPARE(connection.badgeNotificationCount(), 0);
+}
+
+void NeoChatConnectionTest::directChatNotifications()
+{
+    NeoChatConnection connection;
+    sync(&connection, roomsSyncJson(4, 3, 1));
+    QCOMPARE(connection.homeNotifications(), 12);
+    QCOMPARE(connection.directChatNotifications(), 0);
+    QCOMPARE(connection.directChatsHaveHighlightNotifications(), false);
+
+    QSignalSpy directSpy(&connection, &NeoChatConnection::directChatNotificationsChanged);
+    QSignalSpy homeSpy(&connection, &NeoChatConnection::homeNotificationsChanged);
+    sync(&connection,
+         QJsonObject{{"account_data"_L1,
+                      QJsonObject{{"events"_L1,
+                                   QJsonArray{QJsonObject{
+                                       {"type"_L1, "m.direct"_L1},
+                                       {"content"_L1, QJsonObject{{u"@alice:kde.org"_s, QJsonArray{u"!room1:kde.org"_s}}}},
+                                   }}}}}});
+
+    // Moving a room between home and direct chats only changes the totals by that room's count.
+    QCOMPARE(connection.homeNotifications(), 9);
+    QCOMPARE(connection.directChatNotifications(), 3);
+    QCOMPARE(connection.directChatsHaveHighlightNotifications(), true);
+    QCOMPARE(connection.badgeNotificationCount(), 12);
+    QCOMPARE(directSpy.count(), 1);
+    QCOMPARE(homeSpy.count(), 1);
+}
+
+void NeoChatConnectionTest::syncStress_data()
+{
+    QTest::addColumn<int>("rooms");
+
+    // Compare the rows, the time per sync should grow linearly with the number of rooms.
+    QTest::newRow("100 rooms") << 100;
+    QTest::newRow("500 rooms") << 500;
+}
+
+void NeoChatConnectionTest::syncStress()
+{
+    QFETCH(int, rooms);
+
+    NeoChatConnection connection;
+    sync(&connection, roomsSyncJson(rooms, 1, 0));
+    QCOMPARE(connection.homeNotifications(), rooms);
+
+    const QJsonObject syncs[] = {roomsSyncJson(rooms, 2, 1), roomsSyncJson(rooms, 1, 0)};
+    int iteration = 0;
+    QBENCHMARK {
+        sync(&connection, syncs[iteration++ % 2]);
+    }
+
+    const auto notifications = iteration % 2 == 1 ? 2 : 1;
+    QCOMPARE(connection.homeNotifications(), rooms * notifications);
+    QCOMPARE(connection.badgeNotificationCount(), rooms * notifications);
+    QCOMPARE(connection.homeHaveHighlightNotifications(), notifications == 2);
+}
+
+QTEST_GUILESS_MAIN(NeoChatConnectionTest)
+#include "neochatconnectiontest.moc"
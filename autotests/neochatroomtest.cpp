@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: 2022 Carl Schwan <carl@carlschwan.eu>
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <QJsonDocument>
 #include <QObject>
 #include <QSignalSpy>
 #include <QTest>
@@ -9,6 +10,8 @@
 #include <Quotient/quotient_common.h>
 #include <Quotient/syncdata.h>
 
+#include "eventhandler.h"
+#include "neochatconfig.h"
 #include "testutils.h"
 
 using namespace Quotient;
@@ -23,6 +26,11 @@ private:
 private Q_SLOTS:
     void initTestCase();
     void eventTest();
+    void lastEventTest();
+    void subtitleTextTest();
+    void invalidateLastEventTest();
+    void subtitleBenchmark_data();
+    void subtitleBenchmark();
 };
 
 void NeoChatRoomTest::initTestCase()
@@ -36,5 +44,103 @@ void NeoChatRoomTest::eventTest()
     QCOMPARE(room->timelineSize(), 1);
 }
 
+void NeoChatRoomTest::lastEventTest()
+{
+    auto lastEventRoom = new TestUtils::TestRoom(connection, u"#lastevent:kde.org"_s, u"test-min-sync.json"_s);
+    QVERIFY(lastEventRoom->lastEvent());
+    QCOMPARE(lastEventRoom->lastEvent()->id(), u"$153456789:example.org"_s);
+
+    // A reaction should never become the last event.
+    auto syncJson = QJsonDocument::fromJson(R"({
+        "timeline": {
+            "events": [
+                {
+                    "content": {
+                        "body": "A newer message",
+                        "msgtype": "m.text"
+                    },
+                    "event_id": "$153456790:example.org",
+                    "origin_server_ts": 1432735824655,
+                    "room_id": "!jEsUZKDJdhlrceRyVU:example.org",
+                    "sender": "@example:example.org",
+                    "type": "m.room.message"
+                },
+                {
+                    "content": {
+                        "m.relates_to": {
+                            "event_id": "$153456790:example.org",
+                            "key": "👍",
+                            "rel_type": "m.annotation"
+                        }
+                    },
+                    "event_id": "$153456791:example.org",
+                    "origin_server_ts": 1432735824656,
+                    "room_id": "!jEsUZKDJdhlrceRyVU:example.org",
+                    "sender": "@example:example.org",
+                    "type": "m.reaction"
+                }
+            ]
+        }
+    })");
+    lastEventRoom->update(SyncRoomData(lastEventRoom->id(), JoinState::Join, syncJson.object()));
+    QVERIFY(lastEventRoom->lastEvent());
+    QCOMPARE(lastEventRoom->lastEvent()->id(), u"$153456790:example.org"_s);
+    QCOMPARE(lastEventRoom->lastActiveTime(), QDateTime::fromMSecsSinceEpoch(1432735824655));
+}
+
+void NeoChatRoomTest::subtitleTextTest()
+{
+    QCOMPARE(room->subtitleText(), EventHandler::subtitleText(room, room->lastEvent()));
+
+    QSignalSpy spy(room, &NeoChatRoom::subtitleTextChanged);
+    Q_EMIT room->addedMessages(0, 0);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(room->subtitleText(), EventHandler::subtitleText(room, room->lastEvent()));
+}
+
+void NeoChatRoomTest::invalidateLastEventTest()
+{
+    QSignalSpy subtitleSpy(room, &NeoChatRoom::subtitleTextChanged);
+    QSignalSpy lastActiveTimeSpy(room, &NeoChatRoom::lastActiveTimeChanged);
+
+    // Both may have changed with the last event.
+    const auto showRename = NeoChatConfig::self()->showRename();
+    NeoChatConfig::self()->setShowRename(!showRename);
+    QCOMPARE(subtitleSpy.count(), 1);
+    QCOMPARE(lastActiveTimeSpy.count(), 1);
+    QCOMPARE(room->subtitleText(), EventHandler::subtitleText(room, room->lastEvent()));
+
+    NeoChatConfig::self()->setShowRename(showRename);
+}
+
+void NeoChatRoomTest::subtitleBenchmark_data()
+{
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("uncached") << false;
+    QTest::newRow("cached") << true;
+}
+
+// Simulates the room list repainting every row's subtitle with 2000 rooms.
+void NeoChatRoomTest::subtitleBenchmark()
+{
+    QFETCH(bool, cached);
+
+    std::vector<std::unique_ptr<TestUtils::TestRoom>> rooms;
+    for (int i = 0; i < 2000; ++i) {
+        rooms.push_back(std::make_unique<TestUtils::TestRoom>(connection, u"#benchmark%1:kde.org"_s.arg(i), u"test-min-sync.json"_s));
+    }
+
+    QBENCHMARK {
+        for (const auto &benchmarkRoom : rooms) {
+            if (cached) {
+                benchmarkRoom->subtitleText();
+            } else {
+                EventHandler::subtitleText(benchmarkRoom.get(), benchmarkRoom->lastEvent());
+            }
+        }
+    }
+}
+
 QTEST_GUILESS_MAIN(NeoChatRoomTest)
 #include "neochatroomtest.moc"
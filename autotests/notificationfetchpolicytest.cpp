@@ -0,0 +1,126 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QTest>
+
+#include "notificationfetchpolicy.h"
+#include "seennotifications.h"
+
+using namespace Qt::StringLiterals;
+
+class NotificationFetchPolicyTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QJsonArray page(int first, int last);
+
+private Q_SLOTS:
+    void firstSync();
+    void newEvent();
+    void readAndNewInOneSync();
+    void countReset();
+    void noNotifications();
+    void invite();
+    void olderPage();
+    void olderPageLimit();
+};
+
+// Notifications $first to $last, newest first with the timestamp of $n being n.
+QJsonArray NotificationFetchPolicyTest::page(int first, int last)
+{
+    QJsonArray notifications;
+    for (int i = last; i >= first; --i) {
+        notifications += QJsonObject{{u"event"_s, QJsonObject{{u"event_id"_s, u"$%1"_s.arg(i)}}}, {u"ts"_s, i}};
+    }
+    return notifications;
+}
+
+void NotificationFetchPolicyTest::firstSync()
+{
+    NotificationFetchPolicy policy;
+    QVERIFY(!policy.update({{.id = u"!a"_s, .lastEventId = u"$1"_s}}));
+
+    NotificationFetchPolicy withCount;
+    QVERIFY(withCount.update({{.id = u"!a"_s, .lastEventId = u"$1"_s, .notificationCount = 1}}));
+}
+
+void NotificationFetchPolicyTest::newEvent()
+{
+    NotificationFetchPolicy policy;
+    policy.update({{.id = u"!a"_s, .lastEventId = u"$1"_s, .notificationCount = 1}, {.id = u"!b"_s, .lastEventId = u"$2"_s}});
+
+    // Nothing moved.
+    QVERIFY(!policy.update({{.id = u"!a"_s, .lastEventId = u"$1"_s, .notificationCount = 1}, {.id = u"!b"_s, .lastEventId = u"$2"_s}}));
+    // A new event that didn't notify.
+    QVERIFY(!policy.update({{.id = u"!a"_s, .lastEventId = u"$1"_s, .notificationCount = 1}, {.id = u"!b"_s, .lastEventId = u"$3"_s}}));
+    // A new event that did.
+    QVERIFY(policy.update({{.id = u"!a"_s, .lastEventId = u"$1"_s, .notificationCount = 1}, {.id = u"!b"_s, .lastEventId = u"$4"_s, .notificationCount = 1}}));
+}
+
+void NotificationFetchPolicyTest::readAndNewInOneSync()
+{
+    NotificationFetchPolicy policy;
+    policy.update({{.id = u"!a"_s, .lastEventId = u"$1"_s, .notificationCount = 1}});
+
+    // One notification read and a new one arrived, so the count is unchanged.
+    QVERIFY(policy.update({{.id = u"!a"_s, .lastEventId = u"$2"_s, .notificationCount = 1}}));
+}
+
+void NotificationFetchPolicyTest::countReset()
+{
+    NotificationFetchPolicy policy;
+    policy.update({{.id = u"!a"_s, .lastEventId = u"$1"_s, .notificationCount = 5}});
+
+    // Everything was read and a new notification arrived, the count went down.
+    QVERIFY(policy.update({{.id = u"!a"_s, .lastEventId = u"$2"_s, .notificationCount = 1}}));
+    // A room that is read again without anything new.
+    QVERIFY(!policy.update({{.id = u"!a"_s, .lastEventId = u"$2"_s, .notificationCount = 0}}));
+}
+
+void NotificationFetchPolicyTest::noNotifications()
+{
+    NotificationFetchPolicy policy;
+    policy.update({{.id = u"!a"_s, .lastEventId = u"$1"_s}});
+    QVERIFY(!policy.update({{.id = u"!a"_s, .lastEventId = u"$2"_s}}));
+    QVERIFY(!policy.update({}));
+}
+
+void NotificationFetchPolicyTest::invite()
+{
+    NotificationFetchPolicy policy;
+    policy.update({{.id = u"!a"_s, .lastEventId = u"$1"_s}});
+
+    QVERIFY(policy.update({{.id = u"!a"_s, .lastEventId = u"$1"_s}, {.id = u"!b"_s, .invite = true}}));
+    // The same invite is only new once.
+    QVERIFY(!policy.update({{.id = u"!a"_s, .lastEventId = u"$1"_s}, {.id = u"!b"_s, .invite = true}}));
+}
+
+void NotificationFetchPolicyTest::olderPage()
+{
+    SeenNotifications seen;
+    seen.insert(u"$5"_s, 5);
+
+    // Nothing on the page has been seen, there may be more.
+    QVERIFY(NotificationFetchPolicy::needsOlderPage(page(6, 10), u"token"_s, 0, seen, 0));
+    // The page reaches a seen notification.
+    QVERIFY(!NotificationFetchPolicy::needsOlderPage(page(5, 10), u"token"_s, 0, seen, 0));
+    // The page reaches notifications from before the application started.
+    QVERIFY(!NotificationFetchPolicy::needsOlderPage(page(6, 10), u"token"_s, 0, seen, 8));
+    // The server has no more pages.
+    QVERIFY(!NotificationFetchPolicy::needsOlderPage(page(6, 10), QString(), 0, seen, 0));
+    QVERIFY(!NotificationFetchPolicy::needsOlderPage({}, u"token"_s, 0, seen, 0));
+}
+
+void NotificationFetchPolicyTest::olderPageLimit()
+{
+    const SeenNotifications seen;
+    QVERIFY(NotificationFetchPolicy::needsOlderPage(page(1, 10), u"token"_s, NotificationFetchPolicy::MaxCatchUpPages - 2, seen, 0));
+    QVERIFY(!NotificationFetchPolicy::needsOlderPage(page(1, 10), u"token"_s, NotificationFetchPolicy::MaxCatchUpPages - 1, seen, 0));
+}
+
+QTEST_GUILESS_MAIN(NotificationFetchPolicyTest)
+#include "notificationfetchpolicytest.moc"
@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QObject>
+#include <QTest>
+
+#include "roomnameindex.h"
+
+using namespace Qt::StringLiterals;
+
+class RoomNameIndexTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static RoomNameIndex testIndex();
+    static QStringList names(const RoomNameIndex &index, const QList<qsizetype> &results);
+
+private Q_SLOTS:
+    void order();
+    void search_data();
+    void search();
+    void limit();
+
+    void searchBenchmark();
+};
+
+RoomNameIndex RoomNameIndexTest::testIndex()
+{
+    return RoomNameIndex({
+        {.roomId = u"!kde:kde.org"_s, .displayName = u"KDE"_s},
+        {.roomId = u"!neochat:kde.org"_s, .displayName = u"NeoChat"_s},
+        {.roomId = u"!plasma:kde.org"_s, .displayName = u"Plasma Mobile"_s},
+        {.roomId = u"!kdeconnect:kde.org"_s, .displayName = u"KDE Connect"_s},
+        {.roomId = u"!offtopic:kde.org"_s, .displayName = u"kde-offtopic"_s},
+        {.roomId = u"!chatter:kde.org"_s, .displayName = u"Chatter"_s},
+    });
+}
+
+QStringList RoomNameIndexTest::names(const RoomNameIndex &index, const QList<qsizetype> &results)
+{
+    QStringList names;
+    for (const auto result : results) {
+        names += index.entry(result).displayName;
+    }
+    return names;
+}
+
+void RoomNameIndexTest::order()
+{
+    const auto index = testIndex();
+    QCOMPARE(index.size(), 6);
+    QCOMPARE(names(index, index.search(QString())),
+             QStringList({u"Chatter"_s, u"KDE"_s, u"KDE Connect"_s, u"kde-offtopic"_s, u"NeoChat"_s, u"Plasma Mobile"_s}));
+    QCOMPARE(index.entry(index.search(u"neochat"_s)[0]).roomId, u"!neochat:kde.org"_s);
+}
+
+void RoomNameIndexTest::search_data()
+{
+    QTest::addColumn<QString>("filter");
+    QTest::addColumn<QStringList>("expected");
+
+    QTest::newRow("exact first") << u"kde"_s << QStringList({u"KDE"_s, u"KDE Connect"_s, u"kde-offtopic"_s});
+    QTest::newRow("prefix before word prefix") << u"chat"_s << QStringList({u"Chatter"_s, u"NeoChat"_s});
+    QTest::newRow("word prefix") << u"mob"_s << QStringList({u"Plasma Mobile"_s});
+    QTest::newRow("word after punctuation") << u"off"_s << QStringList({u"kde-offtopic"_s});
+    QTest::newRow("case insensitive") << u"NEO"_s << QStringList({u"NeoChat"_s});
+    QTest::newRow("no match") << u"gnome"_s << QStringList();
+}
+
+void RoomNameIndexTest::search()
+{
+    QFETCH(QString, filter);
+    QFETCH(QStringList, expected);
+
+    const auto index = testIndex();
+    QCOMPARE(names(index, index.search(filter)), expected);
+}
+
+void RoomNameIndexTest::limit()
+{
+    const auto index = testIndex();
+    QCOMPARE(names(index, index.search(u"kde"_s, 2)), QStringList({u"KDE"_s, u"KDE Connect"_s}));
+    QCOMPARE(index.search(QString(), 3).size(), 3);
+    QCOMPARE(index.search(u"kde"_s, 0).size(), 0);
+    QVERIFY(RoomNameIndex().search(u"kde"_s).isEmpty());
+}
+
+void RoomNameIndexTest::searchBenchmark()
+{
+    QList<RoomNameIndex::Entry> entries;
+    for (int i = 0; i < 5000; ++i) {
+        entries.append({.roomId = u"!room%1:example.org"_s.arg(i), .displayName = u"Room number %1"_s.arg(i)});
+    }
+    const RoomNameIndex index(std::move(entries));
+
+    QBENCHMARK {
+        index.search(u"number 42"_s, 20);
+    }
+}
+
+QTEST_GUILESS_MAIN(RoomNameIndexTest)
+#include "roomnameindextest.moc"
@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QObject>
+#include <QTest>
+
+#include "seennotifications.h"
+
+using namespace Qt::StringLiterals;
+
+class SeenNotificationsTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void insert();
+    void prune();
+    void insertBelowWatermark();
+
+    void insertBenchmark();
+};
+
+void SeenNotificationsTest::insert()
+{
+    SeenNotifications seen;
+    QVERIFY(!seen.contains(u"$a"_s, 10));
+    seen.insert(u"$a"_s, 10);
+    QVERIFY(seen.contains(u"$a"_s, 10));
+    QVERIFY(!seen.contains(u"$b"_s, 5));
+    QCOMPARE(seen.size(), 1);
+}
+
+void SeenNotificationsTest::prune()
+{
+    SeenNotifications seen(8);
+    for (int i = 1; i <= 8; ++i) {
+        seen.insert(u"$event%1"_s.arg(i), i * 10);
+    }
+    QCOMPARE(seen.size(), 8);
+
+    seen.insert(u"$event9"_s, 90);
+    QVERIFY(seen.size() < 8);
+    QVERIFY(seen.watermark() >= 10);
+
+    // Everything dropped is still seen through the watermark.
+    for (int i = 1; i <= 9; ++i) {
+        QVERIFY(seen.contains(u"$event%1"_s.arg(i), i * 10));
+    }
+    // Unknown events older than the watermark count as seen, newer ones don't.
+    QVERIFY(seen.contains(u"$old"_s, seen.watermark()));
+    QVERIFY(!seen.contains(u"$new"_s, 100));
+}
+
+void SeenNotificationsTest::insertBelowWatermark()
+{
+    SeenNotifications seen(4);
+    for (int i = 1; i <= 5; ++i) {
+        seen.insert(u"$event%1"_s.arg(i), i);
+    }
+    const auto size = seen.size();
+    seen.insert(u"$older"_s, seen.watermark());
+    QCOMPARE(seen.size(), size);
+}
+
+void SeenNotificationsTest::insertBenchmark()
+{
+    QBENCHMARK {
+        SeenNotifications seen;
+        for (int i = 0; i < 100000; ++i) {
+            seen.insert(u"$event%1"_s.arg(i), i);
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(SeenNotificationsTest)
+#include "seennotificationstest.moc"
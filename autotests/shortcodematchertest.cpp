@@ -0,0 +1,133 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QObject>
+#include <QRegularExpression>
+#include <QTest>
+
+#include "shortcodematcher.h"
+
+using namespace Qt::StringLiterals;
+
+using Match = ShortcodeMatcher::Match;
+
+class ShortcodeMatcherTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int benchmarkPatterns = 500;
+
+    static QList<QString> benchmarkShortcodes();
+    static QString benchmarkText();
+
+private Q_SLOTS:
+    void matches();
+    void overlapping();
+    void suffixPatterns();
+    void emptyPatterns();
+    void caseSensitive();
+
+    void matcherBenchmark();
+    void regexBenchmark();
+};
+
+QList<QString> ShortcodeMatcherTest::benchmarkShortcodes()
+{
+    QList<QString> shortcodes;
+    for (int i = 0; i < benchmarkPatterns; ++i) {
+        shortcodes += u":emote_%1:"_s.arg(i);
+    }
+    return shortcodes;
+}
+
+QString ShortcodeMatcherTest::benchmarkText()
+{
+    return u"Some message text with a couple of emotes :emote_12: in the middle :emote_499: and a :colon: or two."_s;
+}
+
+void ShortcodeMatcherTest::matches()
+{
+    ShortcodeMatcher matcher;
+    QVERIFY(matcher.isEmpty());
+    QVERIFY(matcher.matches(u"a :cat:"_s).isEmpty());
+
+    matcher.setPatterns({u":cat:"_s, u":dog:"_s});
+    QVERIFY(!matcher.isEmpty());
+    QCOMPARE(matcher.matches(u"a :cat: and :dog: :cat:"_s), QList<Match>({{2, 5, 0}, {12, 5, 1}, {18, 5, 0}}));
+    QVERIFY(matcher.matches(u"cat: :ca :dog"_s).isEmpty());
+
+    matcher.clear();
+    QVERIFY(matcher.isEmpty());
+    QVERIFY(matcher.matches(u":cat:"_s).isEmpty());
+}
+
+void ShortcodeMatcherTest::overlapping()
+{
+    ShortcodeMatcher matcher;
+    matcher.setPatterns({u":a:"_s, u":b:"_s, u":a:b:"_s});
+    // The longest of the matches starting at the same place.
+    QCOMPARE(matcher.matches(u":a:b:"_s), QList<Match>({{0, 5, 2}}));
+    // Adjacent shortcodes share a colon, the first one wins.
+    QCOMPARE(matcher.matches(u":a:a:"_s), QList<Match>({{0, 3, 0}}));
+    QCOMPARE(matcher.matches(u":a::b:"_s), QList<Match>({{0, 3, 0}, {3, 3, 1}}));
+}
+
+// Patterns that are suffixes of other patterns are only found through the output links.
+void ShortcodeMatcherTest::suffixPatterns()
+{
+    ShortcodeMatcher matcher;
+    matcher.setPatterns({u"he"_s, u"she"_s, u"his"_s, u"hers"_s});
+    QCOMPARE(matcher.matches(u"ushers"_s), QList<Match>({{1, 3, 1}}));
+    QCOMPARE(matcher.matches(u"uhers"_s), QList<Match>({{1, 4, 3}}));
+    QCOMPARE(matcher.matches(u"this"_s), QList<Match>({{1, 3, 2}}));
+}
+
+void ShortcodeMatcherTest::emptyPatterns()
+{
+    ShortcodeMatcher matcher;
+    matcher.setPatterns({u""_s, u":x:"_s, u":x:"_s});
+    QCOMPARE(matcher.matches(u":x::x:"_s), QList<Match>({{0, 3, 1}, {3, 3, 1}}));
+
+    matcher.setPatterns({u""_s});
+    QVERIFY(matcher.isEmpty());
+}
+
+void ShortcodeMatcherTest::caseSensitive()
+{
+    ShortcodeMatcher matcher;
+    matcher.setPatterns({u":Cat:"_s});
+    QVERIFY(matcher.matches(u":cat:"_s).isEmpty());
+    QCOMPARE(matcher.matches(u":Cat:"_s).size(), 1);
+}
+
+void ShortcodeMatcherTest::matcherBenchmark()
+{
+    ShortcodeMatcher matcher;
+    matcher.setPatterns(benchmarkShortcodes());
+    const auto text = benchmarkText();
+    QList<Match> result;
+    QBENCHMARK {
+        result = matcher.matches(text);
+    }
+    QCOMPARE(result.size(), 2);
+}
+
+// What CustomEmojiModel::preprocessText() used to do.
+void ShortcodeMatcherTest::regexBenchmark()
+{
+    QList<QRegularExpression> expressions;
+    for (const auto &shortcode : benchmarkShortcodes()) {
+        expressions += QRegularExpression(shortcode);
+    }
+    const auto text = benchmarkText();
+    QBENCHMARK {
+        auto replaced = text;
+        for (const auto &expression : std::as_const(expressions)) {
+            replaced.replace(expression, u"<img />"_s);
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(ShortcodeMatcherTest)
+#include "shortcodematchertest.moc"
@@ -0,0 +1,158 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QObject>
+#include <QTest>
+
+#include "spacehierarchyindex.h"
+
+using namespace Qt::StringLiterals;
+
+class SpaceHierarchyIndexTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int benchmarkSpaces = 200;
+    static constexpr int benchmarkRooms = 5000;
+    static constexpr int benchmarkChildren = 50;
+
+    static QString roomId(int i);
+    static QString spaceId(int i);
+    static SpaceHierarchyIndex benchmarkIndex();
+
+private Q_SLOTS:
+    void setChildren();
+    void addChildren();
+    void removeSpace();
+
+    void buildBenchmark();
+    void isChildBenchmark();
+    void isSpaceChildBenchmark();
+    void parentsBenchmark();
+};
+
+QString SpaceHierarchyIndexTest::roomId(int i)
+{
+    return u"!room%1:kde.org"_s.arg(i);
+}
+
+QString SpaceHierarchyIndexTest::spaceId(int i)
+{
+    return u"!space%1:kde.org"_s.arg(i);
+}
+
+// Each space has a run of children that overlaps the next space's so most rooms have two parents.
+SpaceHierarchyIndex SpaceHierarchyIndexTest::benchmarkIndex()
+{
+    SpaceHierarchyIndex index;
+    for (int space = 0; space < benchmarkSpaces; ++space) {
+        QList<QString> children;
+        for (int child = 0; child < benchmarkChildren; ++child) {
+            children += roomId((space * benchmarkChildren / 2 + child) % benchmarkRooms);
+        }
+        index.setChildren(spaceId(space), children);
+    }
+    return index;
+}
+
+void SpaceHierarchyIndexTest::setChildren()
+{
+    SpaceHierarchyIndex index;
+    QVERIFY(index.setChildren(spaceId(0), {roomId(0), roomId(1)}));
+    QVERIFY(!index.setChildren(spaceId(0), {roomId(0), roomId(1)}));
+    QVERIFY(index.setChildren(spaceId(1), {roomId(1), roomId(2)}));
+
+    QCOMPARE(index.children(spaceId(0)), QList<QString>({roomId(0), roomId(1)}));
+    QVERIFY(index.isChild(spaceId(0), roomId(0)));
+    QVERIFY(!index.isChild(spaceId(0), roomId(2)));
+    QVERIFY(!index.isChild(spaceId(2), roomId(0)));
+    QCOMPARE(index.parents(roomId(0)), QStringList({spaceId(0)}));
+    QCOMPARE(index.parents(roomId(1)), QStringList({spaceId(0), spaceId(1)}));
+    QVERIFY(index.hasParent(roomId(2)));
+    QVERIFY(!index.hasParent(roomId(3)));
+
+    // Replacing the children must remove the stale reverse entries.
+    QVERIFY(index.setChildren(spaceId(0), {roomId(3)}));
+    QVERIFY(!index.hasParent(roomId(0)));
+    QCOMPARE(index.parents(roomId(1)), QStringList({spaceId(1)}));
+    QCOMPARE(index.parents(roomId(3)), QStringList({spaceId(0)}));
+}
+
+void SpaceHierarchyIndexTest::addChildren()
+{
+    SpaceHierarchyIndex index;
+    QVERIFY(index.addChildren(spaceId(0), {roomId(0), roomId(1), roomId(0)}));
+    QVERIFY(index.addChildren(spaceId(0), {roomId(1), roomId(2)}));
+    QVERIFY(!index.addChildren(spaceId(0), {roomId(2)}));
+
+    QCOMPARE(index.children(spaceId(0)), QList<QString>({roomId(0), roomId(1), roomId(2)}));
+    QCOMPARE(index.parents(roomId(1)), QStringList({spaceId(0)}));
+}
+
+void SpaceHierarchyIndexTest::removeSpace()
+{
+    SpaceHierarchyIndex index;
+    index.setChildren(spaceId(0), {roomId(0), roomId(1)});
+    index.setChildren(spaceId(1), {roomId(1)});
+
+    QVERIFY(index.removeSpace(spaceId(0)));
+    QVERIFY(!index.removeSpace(spaceId(0)));
+    QVERIFY(index.children(spaceId(0)).isEmpty());
+    QVERIFY(!index.hasParent(roomId(0)));
+    QCOMPARE(index.parents(roomId(1)), QStringList({spaceId(1)}));
+
+    index.clear();
+    QVERIFY(index.isEmpty());
+    QVERIFY(!index.hasParent(roomId(1)));
+}
+
+void SpaceHierarchyIndexTest::buildBenchmark()
+{
+    QBENCHMARK {
+        benchmarkIndex();
+    }
+}
+
+// The checks SortFilterRoomTreeModel::filterAcceptsRow() makes for every room during a filter pass.
+void SpaceHierarchyIndexTest::isChildBenchmark()
+{
+    const auto index = benchmarkIndex();
+    int children = 0;
+    QBENCHMARK {
+        children = 0;
+        for (int room = 0; room < benchmarkRooms; ++room) {
+            children += index.hasParent(roomId(room));
+        }
+    }
+    QCOMPARE(children, benchmarkRooms);
+}
+
+void SpaceHierarchyIndexTest::isSpaceChildBenchmark()
+{
+    const auto index = benchmarkIndex();
+    int children = 0;
+    QBENCHMARK {
+        children = 0;
+        for (int room = 0; room < benchmarkRooms; ++room) {
+            children += index.isChild(spaceId(benchmarkSpaces / 2), roomId(room));
+        }
+    }
+    QCOMPARE(children, benchmarkChildren);
+}
+
+void SpaceHierarchyIndexTest::parentsBenchmark()
+{
+    const auto index = benchmarkIndex();
+    qsizetype parents = 0;
+    QBENCHMARK {
+        parents = 0;
+        for (int room = 0; room < benchmarkRooms; ++room) {
+            parents += index.parents(roomId(room)).size();
+        }
+    }
+    QCOMPARE(parents, qsizetype(benchmarkSpaces * benchmarkChildren));
+}
+
+QTEST_GUILESS_MAIN(SpaceHierarchyIndexTest)
+#include "spacehierarchyindextest.moc"
@@ -0,0 +1,167 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QFile>
+#include <QObject>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <KConfigGroup>
+#include <KSharedConfig>
+
+#include "spacehierarchystore.h"
+
+using namespace Qt::StringLiterals;
+
+class SpaceHierarchyStoreTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    QTemporaryDir dir;
+    QString path;
+    KSharedConfig::Ptr legacyConfig;
+
+    void writeLegacyConfig(const QHash<QString, QStringList> &hierarchy);
+
+private Q_SLOTS:
+    void init();
+
+    void empty();
+    void roundTrip();
+    void saveSoon();
+    void saveOnDestruction();
+    void migrate();
+    void invalidFile_data();
+    void invalidFile();
+};
+
+void SpaceHierarchyStoreTest::init()
+{
+    QVERIFY(dir.isValid());
+    path = dir.filePath(u"spacehierarchy"_s);
+    QFile::remove(path);
+    legacyConfig = KSharedConfig::openConfig(dir.filePath(u"legacyrc"_s), KConfig::SimpleConfig);
+    legacyConfig->deleteGroup(u"Cache"_s);
+    legacyConfig->sync();
+}
+
+void SpaceHierarchyStoreTest::writeLegacyConfig(const QHash<QString, QStringList> &hierarchy)
+{
+    auto group = legacyConfig->group(u"Cache"_s);
+    for (auto it = hierarchy.cbegin(); it != hierarchy.cend(); ++it) {
+        group.writeEntry(it.key(), it.value());
+    }
+    legacyConfig->sync();
+}
+
+void SpaceHierarchyStoreTest::empty()
+{
+    SpaceHierarchyStore store(path, legacyConfig);
+    QVERIFY(store.hierarchy().isEmpty());
+    QVERIFY(!store.isSavePending());
+}
+
+void SpaceHierarchyStoreTest::roundTrip()
+{
+    const QHash<QString, QStringList> hierarchy = {
+        {u"!space1:kde.org"_s, {u"!room1:kde.org"_s, u"!room2:kde.org"_s}},
+        {u"!space2:kde.org"_s, {}},
+    };
+    {
+        SpaceHierarchyStore store(path, legacyConfig);
+        for (auto it = hierarchy.cbegin(); it != hierarchy.cend(); ++it) {
+            store.setChildren(it.key(), it.value());
+        }
+        QVERIFY(store.isSavePending());
+        QVERIFY(store.save());
+        QVERIFY(!store.isSavePending());
+    }
+
+    SpaceHierarchyStore store(path, legacyConfig);
+    QCOMPARE(store.hierarchy(), hierarchy);
+    QVERIFY(!store.isSavePending());
+}
+
+void SpaceHierarchyStoreTest::saveSoon()
+{
+    SpaceHierarchyStore store(path, legacyConfig);
+    store.setChildren(u"!space:kde.org"_s, {u"!room:kde.org"_s});
+    store.setChildren(u"!space:kde.org"_s, {u"!room:kde.org"_s, u"!other:kde.org"_s});
+    QVERIFY(!QFile::exists(path));
+
+    // All the changes are written together shortly after.
+    QTRY_VERIFY(!store.isSavePending());
+    QVERIFY(QFile::exists(path));
+    SpaceHierarchyStore reloaded(path, legacyConfig);
+    QCOMPARE(reloaded.hierarchy().value(u"!space:kde.org"_s), (QStringList{u"!room:kde.org"_s, u"!other:kde.org"_s}));
+}
+
+void SpaceHierarchyStoreTest::saveOnDestruction()
+{
+    {
+        SpaceHierarchyStore store(path, legacyConfig);
+        store.setChildren(u"!space:kde.org"_s, {u"!room:kde.org"_s});
+    }
+    SpaceHierarchyStore store(path, legacyConfig);
+    QCOMPARE(store.hierarchy().value(u"!space:kde.org"_s), QStringList{u"!room:kde.org"_s});
+}
+
+void SpaceHierarchyStoreTest::migrate()
+{
+    const QHash<QString, QStringList> hierarchy = {
+        {u"!space1:kde.org"_s, {u"!room1:kde.org"_s, u"!room2:kde.org"_s}},
+        {u"!space2:kde.org"_s, {u"!room3:kde.org"_s}},
+    };
+    writeLegacyConfig(hierarchy);
+
+    {
+        // The old config is read when there is no file yet and moved to the file.
+        SpaceHierarchyStore store(path, legacyConfig);
+        QCOMPARE(store.hierarchy(), hierarchy);
+        QVERIFY(store.isSavePending());
+        QVERIFY(store.save());
+    }
+    QVERIFY(QFile::exists(path));
+    QVERIFY(!legacyConfig->hasGroup(u"Cache"_s));
+
+    SpaceHierarchyStore store(path, legacyConfig);
+    QCOMPARE(store.hierarchy(), hierarchy);
+    QVERIFY(!store.isSavePending());
+}
+
+void SpaceHierarchyStoreTest::invalidFile_data()
+{
+    QTest::addColumn<QByteArray>("data");
+
+    QTest::newRow("empty") << QByteArray();
+    QTest::newRow("text") << "not a space hierarchy"_ba;
+    QTest::newRow("wrong magic") << QByteArray::fromHex("0000000000000001");
+    QTest::newRow("wrong version") << QByteArray::fromHex("4e43534800000002");
+    QTest::newRow("truncated") << QByteArray::fromHex("4e43534800000001000000");
+}
+
+void SpaceHierarchyStoreTest::invalidFile()
+{
+    QFETCH(QByteArray, data);
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(data);
+    file.close();
+
+    // An invalid file is ignored rather than partially read.
+    SpaceHierarchyStore store(path, legacyConfig);
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"Ignoring invalid space hierarchy cache"_s));
+    QVERIFY(store.hierarchy().isEmpty());
+
+    // And replaced by the next save.
+    store.setChildren(u"!space:kde.org"_s, {u"!room:kde.org"_s});
+    QVERIFY(store.save());
+    SpaceHierarchyStore reloaded(path, legacyConfig);
+    QCOMPARE(reloaded.hierarchy().value(u"!space:kde.org"_s), QStringList{u"!room:kde.org"_s});
+}
+
+QTEST_GUILESS_MAIN(SpaceHierarchyStoreTest)
+#include "spacehierarchystoretest.moc"
@@ -0,0 +1,139 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QObject>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTest>
+
+#include <Quotient/connection.h>
+
+#include "statesavescheduler.h"
+#include "testutils.h"
+
+using namespace Quotient;
+using namespace Qt::StringLiterals;
+
+class StateSaveSchedulerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void coalesce();
+    void flush();
+    void nothingPending();
+    void changedRooms();
+    void logout();
+};
+
+void StateSaveSchedulerTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void StateSaveSchedulerTest::coalesce()
+{
+    auto connection = Connection::makeMockConnection(u"@bob:kde.org"_s);
+    auto scheduler = new StateSaveScheduler(connection);
+    scheduler->setInterval(std::chrono::milliseconds(50));
+    QSignalSpy spy(scheduler, &StateSaveScheduler::saved);
+
+    QVERIFY(!scheduler->isPending());
+    for (int i = 0; i < 5; ++i) {
+        Q_EMIT connection->syncDone();
+    }
+    QVERIFY(scheduler->isPending());
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(!scheduler->isPending());
+
+    // Nothing changed since, so nothing is saved.
+    QVERIFY(!spy.wait(200));
+    delete connection;
+}
+
+void StateSaveSchedulerTest::flush()
+{
+    auto connection = Connection::makeMockConnection(u"@bob:kde.org"_s);
+    auto scheduler = new StateSaveScheduler(connection);
+    scheduler->setInterval(std::chrono::hours(1));
+    QSignalSpy spy(scheduler, &StateSaveScheduler::saved);
+
+    Q_EMIT connection->syncDone();
+    scheduler->flush();
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(spy.at(0).at(0).toStringList().isEmpty());
+    QVERIFY(!scheduler->isPending());
+    delete connection;
+}
+
+void StateSaveSchedulerTest::nothingPending()
+{
+    auto connection = Connection::makeMockConnection(u"@bob:kde.org"_s);
+    auto scheduler = new StateSaveScheduler(connection);
+    QSignalSpy spy(scheduler, &StateSaveScheduler::saved);
+
+    scheduler->flush();
+    QCOMPARE(spy.count(), 0);
+    delete connection;
+}
+
+void StateSaveSchedulerTest::changedRooms()
+{
+    auto connection = Connection::makeMockConnection(u"@bob:kde.org"_s);
+    auto scheduler = new StateSaveScheduler(connection);
+    scheduler->setInterval(std::chrono::hours(1));
+    QSignalSpy spy(scheduler, &StateSaveScheduler::saved);
+
+    // libQuotient's own save after every change is turned off.
+    QVERIFY(!connection->cacheState());
+
+    auto firstRoom = new TestUtils::TestRoom(connection, u"#firstRoom:kde.org"_s);
+    auto secondRoom = new TestUtils::TestRoom(connection, u"#secondRoom:kde.org"_s);
+    auto thirdRoom = new TestUtils::TestRoom(connection, u"#thirdRoom:kde.org"_s);
+    Q_EMIT connection->newRoom(firstRoom);
+    Q_EMIT connection->newRoom(secondRoom);
+    Q_EMIT connection->newRoom(thirdRoom);
+    QVERIFY(!scheduler->isPending());
+
+    // Only the rooms that changed are written, however often they changed.
+    firstRoom->syncNewEvents(u"test-min-sync.json"_s);
+    thirdRoom->syncNewEvents(u"test-min-sync.json"_s);
+    firstRoom->syncNewEvents(u"test-texthandler-sync.json"_s);
+    QVERIFY(scheduler->isPending());
+    scheduler->flush();
+
+    QCOMPARE(spy.count(), 1);
+    auto roomIds = spy.at(0).at(0).toStringList();
+    roomIds.sort();
+    QCOMPARE(roomIds, QStringList({u"#firstRoom:kde.org"_s, u"#thirdRoom:kde.org"_s}));
+    QVERIFY(!connection->cacheState());
+
+    // The dirty rooms are cleared by the save.
+    secondRoom->syncNewEvents(u"test-min-sync.json"_s);
+    scheduler->flush();
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(1).at(0).toStringList(), QStringList({u"#secondRoom:kde.org"_s}));
+    delete connection;
+}
+
+void StateSaveSchedulerTest::logout()
+{
+    auto connection = Connection::makeMockConnection(u"@bob:kde.org"_s);
+    auto scheduler = new StateSaveScheduler(connection);
+    scheduler->setInterval(std::chrono::milliseconds(50));
+    QSignalSpy spy(scheduler, &StateSaveScheduler::saved);
+
+    Q_EMIT connection->syncDone();
+    QVERIFY(scheduler->isPending());
+    Q_EMIT connection->loggedOut();
+
+    // The pending save is dropped rather than written for the old account.
+    QVERIFY(!scheduler->isPending());
+    QVERIFY(!spy.wait(200));
+    delete connection;
+}
+
+QTEST_GUILESS_MAIN(StateSaveSchedulerTest)
+#include "statesaveschedulertest.moc"
@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QFile>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "textfilepreview.h"
+
+using namespace Qt::StringLiterals;
+
+class TextFilePreviewTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    QTemporaryDir dir;
+
+    QString writeFile(const QString &name, const QByteArray &data);
+
+private Q_SLOTS:
+    void initTestCase();
+    void smallFile();
+    void largeFile();
+    void splitCharacter();
+    void missingFile();
+};
+
+QString TextFilePreviewTest::writeFile(const QString &name, const QByteArray &data)
+{
+    const auto path = dir.filePath(name);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size()) {
+        return {};
+    }
+    return path;
+}
+
+void TextFilePreviewTest::initTestCase()
+{
+    QVERIFY(dir.isValid());
+}
+
+void TextFilePreviewTest::smallFile()
+{
+    const auto path = writeFile(u"small.txt"_s, "first line\nsecond line\n");
+    QVERIFY(!path.isEmpty());
+
+    const auto preview = TextFilePreview::forFile(path).result();
+    QCOMPARE(preview.text, u"first line\nsecond line\n"_s);
+    QVERIFY(!preview.truncated);
+
+    // Exactly the maximum size isn't truncated.
+    const auto exact = TextFilePreview::read(path, 23);
+    QCOMPARE(exact.text, preview.text);
+    QVERIFY(!exact.truncated);
+}
+
+void TextFilePreviewTest::largeFile()
+{
+    QByteArray data;
+    for (int i = 0; data.size() < TextFilePreview::MaxSize * 2; ++i) {
+        data += "line " + QByteArray::number(i) + '\n';
+    }
+    const auto path = writeFile(u"large.txt"_s, data);
+    QVERIFY(!path.isEmpty());
+
+    const auto preview = TextFilePreview::forFile(path).result();
+    QVERIFY(preview.truncated);
+    QVERIFY(preview.text.size() <= TextFilePreview::MaxSize);
+    QVERIFY(preview.text.endsWith(u'\n'));
+    QVERIFY(data.startsWith(preview.text.toUtf8()));
+}
+
+void TextFilePreviewTest::splitCharacter()
+{
+    // The cut falls in the middle of the two byte "é" so the partial character
+    // is dropped along with the partial line.
+    const auto path = writeFile(u"split.txt"_s, "abc\ndé\n");
+    QVERIFY(!path.isEmpty());
+
+    const auto preview = TextFilePreview::read(path, 6);
+    QVERIFY(preview.truncated);
+    QCOMPARE(preview.text, u"abc\n"_s);
+
+    // Without a complete line there is nothing to cut back to.
+    const auto partialLine = TextFilePreview::read(path, 2);
+    QVERIFY(partialLine.truncated);
+    QCOMPARE(partialLine.text, u"ab"_s);
+}
+
+void TextFilePreviewTest::missingFile()
+{
+    const auto preview = TextFilePreview::read(dir.filePath(u"missing.txt"_s));
+    QVERIFY(preview.text.isEmpty());
+    QVERIFY(!preview.truncated);
+    QVERIFY(TextFilePreview::read(QString()).text.isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TextFilePreviewTest)
+#include "textfilepreviewtest.moc"
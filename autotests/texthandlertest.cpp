@@ -56,6 +56,7 @@ private Q_SLOTS:
 
     void receiveRichUserPill();
     void receiveRichStrikethrough();
+    void receiveRichUnbalancedStrikethrough();
     void receiveRichtextIn();
     void receiveRichMxcUrl();
     void receiveRichPlainUrl();
@@ -67,6 +68,10 @@ private Q_SLOTS:
 
     void componentOutput_data();
     void componentOutput();
+    void componentLinks_data();
+    void componentLinks();
+
+    void receiveRichBenchmark();
 };
 
 void TextHandlerTest::initTestCase()
@@ -389,6 +394,17 @@ void TextHandlerTest::receiveRichStrikethrough()
     QCOMPARE(testTextHandler.handleRecieveRichText(), testOutputString);
 }
 
+void TextHandlerTest::receiveRichUnbalancedStrikethrough()
+{
+    const QString testInputString = u"<p><del>a<del>b</del>c</del> <del>d</p>"_s;
+    const QString testOutputString = u"<s>a<del>b</s>c</del> <del>d"_s;
+
+    TextHandler testTextHandler;
+    testTextHandler.setData(testInputString);
+
+    QCOMPARE(testTextHandler.handleRecieveRichText(), testOutputString);
+}
+
 void TextHandlerTest::receiveRichtextIn()
 {
     const QString testInputString = u"<p>Test</p> <pre><code>Some code <strong>with tags</strong></code></pre>"_s;
@@ -561,5 +577,55 @@ void TextHandlerTest::componentOutput()
     QCOMPARE(testTextHandler.textComponents(testInputString), testOutputComponents);
 }
 
+void TextHandlerTest::componentLinks_data()
+{
+    QTest::addColumn<QString>("testInputString");
+    QTest::addColumn<QList<QList<QUrl>>>("testOutputLinks");
+
+    QTest::newRow("no links") << u"<p>Nothing to see here</p>"_s << QList<QList<QUrl>>{{}};
+    QTest::newRow("plain url") << u"<p>Look at https://kde.org and https://kde.org</p>"_s << QList<QList<QUrl>>{{QUrl(u"https://kde.org"_s)}};
+    QTest::newRow("href") << u"<p><a href=\"https://kde.org/plasma\">Plasma</a></p>"_s << QList<QList<QUrl>>{{QUrl(u"https://kde.org/plasma"_s)}};
+    QTest::newRow("href with url text") << u"<p><a href=\"https://kde.org\">https://kde.org</a></p>"_s << QList<QList<QUrl>>{{QUrl(u"https://kde.org"_s)}};
+    QTest::newRow("multiple urls") << u"<p>https://kde.org https://planet.kde.org</p>"_s
+                                   << QList<QList<QUrl>>{{QUrl(u"https://kde.org"_s), QUrl(u"https://planet.kde.org"_s)}};
+    QTest::newRow("www") << u"<p>www.example.org https://kde.org</p>"_s << QList<QList<QUrl>>{{QUrl(u"https://kde.org"_s)}};
+    QTest::newRow("matrix.to") << u"<p><a href=\"https://matrix.to/#/@alice:kde.org\">Alice</a></p>"_s << QList<QList<QUrl>>{{}};
+    QTest::newRow("plain matrix.to") << u"<p>https://matrix.to/#/@alice:example.org</p>"_s << QList<QList<QUrl>>{{}};
+    QTest::newRow("mxc") << u"<p>mxc://example.org/SEsfnsuifSDFSSEF</p>"_s << QList<QList<QUrl>>{{}};
+    QTest::newRow("no space") << u"<p>testhttps://kde.org</p>"_s << QList<QList<QUrl>>{{}};
+    QTest::newRow("per block") << u"<p>https://kde.org</p>\n<pre><code>https://invent.kde.org</code></pre>\n<blockquote>https://planet.kde.org</blockquote>"_s
+                               << QList<QList<QUrl>>{{QUrl(u"https://kde.org"_s)}, {}, {QUrl(u"https://planet.kde.org"_s)}};
+}
+
+void TextHandlerTest::componentLinks()
+{
+    QFETCH(QString, testInputString);
+    QFETCH(QList<QList<QUrl>>, testOutputLinks);
+
+    TextHandler testTextHandler;
+    const auto components = testTextHandler.textComponents(testInputString);
+    QCOMPARE(components.size(), testOutputLinks.size());
+    for (qsizetype i = 0; i < components.size(); ++i) {
+        QCOMPARE(components[i].links, testOutputLinks[i]);
+    }
+}
+
+void TextHandlerTest::receiveRichBenchmark()
+{
+    // A large message mixing everything the receive path has to handle.
+    QString testInputString;
+    for (int i = 0; i < 200; ++i) {
+        testInputString += u"<p>Paragraph %1 with <b>bold</b>, <del>struck</del> and <span data-mx-color=\"#ff0000\">coloured</span> text, "_s.arg(i)
+            + u"a link https://kde.org/page%1 and a mention of <a href=\"https://matrix.to/#/@alice:example.org\">Alice</a>.</p>"_s.arg(i)
+            + u"<pre><code class=\"language-cpp\">int main() { return a < b; }</code></pre><body>Disallowed</body>"_s;
+    }
+
+    TextHandler testTextHandler;
+    QBENCHMARK {
+        testTextHandler.setData(testInputString);
+        testTextHandler.handleRecieveRichText();
+    }
+}
+
 QTEST_MAIN(TextHandlerTest)
 #include "texthandlertest.moc"
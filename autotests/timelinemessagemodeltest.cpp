@@ -1,11 +1,14 @@
 // SPDX-FileCopyrightText: 2023 James Graham <james.h.graham@protonmail.com>
 // SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
+#include <QJsonArray>
+#include <QJsonObject>
 #include <QObject>
 #include <QSignalSpy>
 #include <QTest>
 
 #include <Quotient/connection.h>
+#include <Quotient/events/roomevent.h>
 #include <Quotient/quotient_common.h>
 #include <Quotient/syncdata.h>
 
@@ -16,6 +19,57 @@
 #include "testutils.h"
 
 using namespace Quotient;
+using namespace Qt::StringLiterals;
+
+namespace
+{
+QJsonObject messageEventJson(int i)
+{
+    return QJsonObject{
+        {"content"_L1, QJsonObject{{"body"_L1, u"Message %1"_s.arg(i)}, {"msgtype"_L1, "m.text"_L1}}},
+        {"event_id"_L1, u"$message%1:example.org"_s.arg(i)},
+        {"origin_server_ts"_L1, qint64(1432735824654) + i},
+        {"sender"_L1, "@example:example.org"_L1},
+        {"type"_L1, "m.room.message"_L1},
+    };
+}
+
+// A model whose rows can be removed, which the timeline only does for pending events.
+class EventListModel : public MessageModel
+{
+public:
+    void appendEvent(const QJsonObject &json)
+    {
+        beginInsertRows({}, rowCount(), rowCount());
+        m_events.push_back(loadEvent<RoomEvent>(json));
+        endInsertRows();
+    }
+
+    void removeEvent(int row)
+    {
+        beginRemoveRows({}, row, row);
+        m_events.erase(m_events.begin() + row);
+        endRemoveRows();
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : int(m_events.size());
+    }
+
+protected:
+    std::optional<std::reference_wrapper<const RoomEvent>> getEventForIndex(QModelIndex index) const override
+    {
+        if (index.row() < 0 || index.row() >= rowCount()) {
+            return std::nullopt;
+        }
+        return *m_events[index.row()];
+    }
+
+private:
+    std::vector<RoomEventPtr> m_events;
+};
+}
 
 class TimelineMessageModelTest : public QObject
 {
@@ -36,6 +90,10 @@ private Q_SLOTS:
     void pendingEvent();
     void disconnect();
     void idToRow();
+    void renderCache();
+    void renderCacheRedaction();
+    void renderCacheLimit();
+    void renderCacheRowRemoval();
 
     void cleanup();
 };
@@ -211,6 +269,101 @@ void TimelineMessageModelTest::idToRow()
     QCOMPARE(model->eventIdToRow(u"$153456789:example.org"_s), 0);
 }
 
+// Make sure repeated role reads are served from the render cache and an event update invalidates it.
+void TimelineMessageModelTest::renderCache()
+{
+    auto room = new TestUtils::TestRoom(connection, u"#myroom:kde.org"_s, u"test-messageventmodel-sync.json"_s);
+    model->setRoom(room);
+
+    const auto hits = model->renderCacheHits();
+    const auto misses = model->renderCacheMisses();
+
+    QCOMPARE(model->data(model->index(1)), u"<b>This is an example<br>text message</b>"_s);
+    QCOMPARE(model->renderCacheMisses(), misses + 1);
+    QCOMPARE(model->data(model->index(1)), u"<b>This is an example<br>text message</b>"_s);
+    QCOMPARE(model->renderCacheHits(), hits + 1);
+
+    Q_EMIT room->updatedEvent(u"$153456789:example.org"_s);
+    QCOMPARE(model->data(model->index(1)), u"<b>This is an example<br>text message</b>"_s);
+    QCOMPARE(model->renderCacheMisses(), misses + 2);
+}
+
+// Make sure an event that changes in the timeline is rendered again rather than served from the cache.
+void TimelineMessageModelTest::renderCacheRedaction()
+{
+    auto room = new TestUtils::TestRoom(connection, u"#myroom:kde.org"_s, u"test-messageventmodel-sync.json"_s);
+    model->setRoom(room);
+
+    const auto eventId = u"$153456789:example.org"_s;
+    const auto original = model->data(model->index(model->eventIdToRow(eventId)));
+    QCOMPARE(original, u"<b>This is an example<br>text message</b>"_s);
+
+    const auto redaction = QJsonObject{
+        {"content"_L1, QJsonObject{{"redacts"_L1, eventId}}},
+        {"event_id"_L1, u"$redaction:example.org"_s},
+        {"origin_server_ts"_L1, qint64(1432735824700)},
+        {"redacts"_L1, eventId},
+        {"sender"_L1, "@example:example.org"_L1},
+        {"type"_L1, "m.room.redaction"_L1},
+    };
+    room->update(SyncRoomData(room->id(), JoinState::Join, QJsonObject{{"timeline"_L1, QJsonObject{{"events"_L1, QJsonArray{redaction}}}}}));
+
+    const auto misses = model->renderCacheMisses();
+    QVERIFY(model->data(model->index(model->eventIdToRow(eventId))) != original);
+    QCOMPARE(model->renderCacheMisses(), misses + 1);
+}
+
+// Make sure the cache doesn't grow past its limit and drops the least recently used event first.
+void TimelineMessageModelTest::renderCacheLimit()
+{
+    constexpr auto EventCount = MessageModel::MaxRenderCacheEvents + 10;
+    auto room = new TestUtils::TestRoom(connection, u"#myroom:kde.org"_s);
+    QJsonArray events;
+    for (int i = 0; i < EventCount; ++i) {
+        events += messageEventJson(i);
+    }
+    room->update(SyncRoomData(room->id(), JoinState::Join, QJsonObject{{"timeline"_L1, QJsonObject{{"events"_L1, events}}}}));
+    model->setRoom(room);
+
+    for (int i = 0; i < EventCount; ++i) {
+        model->data(model->index(model->eventIdToRow(u"$message%1:example.org"_s.arg(i))));
+    }
+    QCOMPARE(model->renderCacheSize(), MessageModel::MaxRenderCacheEvents);
+
+    // The last event read is still cached, the first was evicted.
+    const auto hits = model->renderCacheHits();
+    const auto misses = model->renderCacheMisses();
+    model->data(model->index(model->eventIdToRow(u"$message%1:example.org"_s.arg(EventCount - 1))));
+    QCOMPARE(model->renderCacheHits(), hits + 1);
+    model->data(model->index(model->eventIdToRow(u"$message0:example.org"_s)));
+    QCOMPARE(model->renderCacheMisses(), misses + 1);
+    QCOMPARE(model->renderCacheSize(), MessageModel::MaxRenderCacheEvents);
+}
+
+// Make sure the cached values of an event are dropped with its row.
+void TimelineMessageModelTest::renderCacheRowRemoval()
+{
+    auto room = new TestUtils::TestRoom(connection, u"#myroom:kde.org"_s);
+    EventListModel eventListModel;
+    eventListModel.setRoom(room);
+    for (int i = 0; i < 3; ++i) {
+        eventListModel.appendEvent(messageEventJson(i));
+    }
+    for (int i = 0; i < 3; ++i) {
+        eventListModel.data(eventListModel.index(i));
+    }
+    QCOMPARE(eventListModel.renderCacheSize(), 3);
+
+    eventListModel.removeEvent(1);
+    QCOMPARE(eventListModel.renderCacheSize(), 2);
+
+    // The remaining rows are still served from the cache.
+    const auto hits = eventListModel.renderCacheHits();
+    eventListModel.data(eventListModel.index(0));
+    eventListModel.data(eventListModel.index(1));
+    QCOMPARE(eventListModel.renderCacheHits(), hits + 2);
+}
+
 void TimelineMessageModelTest::cleanup()
 {
     delete model;
@@ -0,0 +1,112 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QImage>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "blurhash.h"
+#include "uploadpreview.h"
+
+using namespace Qt::StringLiterals;
+
+class UploadPreviewTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    QTemporaryDir dir;
+
+    static QImage testImage(const QSize &size, bool alpha = false);
+
+private Q_SLOTS:
+    void initTestCase();
+    void largeImage();
+    void smallImage();
+    void transparentImage();
+    void invalidImage();
+    void frame();
+
+    void largeImageBenchmark();
+};
+
+QImage UploadPreviewTest::testImage(const QSize &size, bool alpha)
+{
+    QImage image(size, alpha ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+    for (int y = 0; y < size.height(); ++y) {
+        for (int x = 0; x < size.width(); ++x) {
+            image.setPixelColor(x, y, QColor(255 * x / size.width(), 255 * y / size.height(), 128, alpha ? 128 : 255));
+        }
+    }
+    return image;
+}
+
+void UploadPreviewTest::initTestCase()
+{
+    QVERIFY(dir.isValid());
+    QVERIFY(testImage(QSize(2400, 1600)).save(dir.filePath(u"large.jpg"_s)));
+    QVERIFY(testImage(QSize(300, 200)).save(dir.filePath(u"small.png"_s)));
+    QVERIFY(testImage(QSize(1000, 2000), true).save(dir.filePath(u"transparent.png"_s)));
+}
+
+void UploadPreviewTest::largeImage()
+{
+    const auto preview = UploadPreview::forImageFile(dir.filePath(u"large.jpg"_s)).result();
+    QCOMPARE(preview.size, QSize(2400, 1600));
+    QCOMPARE(preview.thumbnailSize, QSize(800, 533));
+    QCOMPARE(preview.thumbnailMimeType, u"image/jpeg"_s);
+    QCOMPARE(QImage::fromData(preview.thumbnail).size(), preview.thumbnailSize);
+    QVERIFY(isValidBlurhash(preview.blurhash.toLatin1().constData()));
+    // Four horizontal and three vertical components for a landscape image.
+    QCOMPARE(preview.blurhash.size(), 28);
+    QCOMPARE(preview.blurhash[0], u'L');
+}
+
+void UploadPreviewTest::smallImage()
+{
+    const auto preview = UploadPreview::forImageFile(dir.filePath(u"small.png"_s)).result();
+    QCOMPARE(preview.size, QSize(300, 200));
+    QVERIFY(preview.thumbnail.isEmpty());
+    QVERIFY(!preview.thumbnailSize.isValid());
+    QVERIFY(isValidBlurhash(preview.blurhash.toLatin1().constData()));
+}
+
+void UploadPreviewTest::transparentImage()
+{
+    const auto preview = UploadPreview::forImageFile(dir.filePath(u"transparent.png"_s)).result();
+    QCOMPARE(preview.size, QSize(1000, 2000));
+    QCOMPARE(preview.thumbnailSize, QSize(400, 800));
+    QCOMPARE(preview.thumbnailMimeType, u"image/png"_s);
+    QVERIFY(QImage::fromData(preview.thumbnail).hasAlphaChannel());
+    // Three horizontal and four vertical components for a portrait image.
+    QCOMPARE(preview.blurhash[0], u'T');
+}
+
+void UploadPreviewTest::invalidImage()
+{
+    const auto preview = UploadPreview::forImageFile(dir.filePath(u"missing.png"_s)).result();
+    QVERIFY(!preview.size.isValid());
+    QVERIFY(preview.thumbnail.isEmpty());
+    QVERIFY(preview.blurhash.isEmpty());
+}
+
+void UploadPreviewTest::frame()
+{
+    const auto preview = UploadPreview::forImage(testImage(QSize(1280, 720))).result();
+    QCOMPARE(preview.size, QSize(1280, 720));
+    QCOMPARE(preview.thumbnailSize, QSize(800, 450));
+    QVERIFY(isValidBlurhash(preview.blurhash.toLatin1().constData()));
+
+    QVERIFY(UploadPreview::forImage(QImage()).result().blurhash.isEmpty());
+}
+
+void UploadPreviewTest::largeImageBenchmark()
+{
+    QBENCHMARK {
+        UploadPreview::forImageFile(dir.filePath(u"large.jpg"_s)).result();
+    }
+}
+
+QTEST_GUILESS_MAIN(UploadPreviewTest)
+#include "uploadpreviewtest.moc"
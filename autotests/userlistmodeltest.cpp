@@ -0,0 +1,232 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QSignalSpy>
+#include <QTest>
+
+#include <Quotient/connection.h>
+#include <Quotient/syncdata.h>
+
+#include "models/userfiltermodel.h"
+#include "models/userlistmodel.h"
+#include "testutils.h"
+
+using namespace Quotient;
+using namespace Qt::StringLiterals;
+
+class UserListModelTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    Connection *connection = nullptr;
+    int eventCount = 0;
+
+    QJsonObject stateEvent(const QString &type, const QString &stateKey, const QJsonObject &content);
+    QJsonObject memberEvent(const QString &userId, const QString &name, const QString &membership = u"join"_s);
+    QJsonObject powerLevelsEvent(const QJsonObject &users);
+    void sync(TestUtils::TestRoom *room, const QJsonArray &events, bool timeline = true);
+    TestUtils::TestRoom *makeRoom(const QString &roomId);
+    TestUtils::TestRoom *benchmarkRoom();
+    static QStringList userIds(const UserListModel &model);
+
+private Q_SLOTS:
+    void initTestCase();
+    void sorted();
+    void roles();
+    void joinAndLeave();
+    void rename();
+    void powerLevelChange();
+    void filter();
+
+    void sortBenchmark();
+    void filterBenchmark();
+};
+
+QJsonObject UserListModelTest::stateEvent(const QString &type, const QString &stateKey, const QJsonObject &content)
+{
+    return {
+        {u"type"_s, type},
+        {u"state_key"_s, stateKey},
+        {u"sender"_s, u"@alice:kde.org"_s},
+        {u"event_id"_s, u"$event%1:kde.org"_s.arg(++eventCount)},
+        {u"origin_server_ts"_s, eventCount},
+        {u"content"_s, content},
+    };
+}
+
+QJsonObject UserListModelTest::memberEvent(const QString &userId, const QString &name, const QString &membership)
+{
+    return stateEvent(u"m.room.member"_s, userId, {{u"membership"_s, membership}, {u"displayname"_s, name}});
+}
+
+QJsonObject UserListModelTest::powerLevelsEvent(const QJsonObject &users)
+{
+    return stateEvent(u"m.room.power_levels"_s, QString(), {{u"users"_s, users}});
+}
+
+void UserListModelTest::sync(TestUtils::TestRoom *room, const QJsonArray &events, bool timeline)
+{
+    SyncRoomData roomData(room->id(), JoinState::Join, {{timeline ? u"timeline"_s : u"state"_s, QJsonObject{{u"events"_s, events}}}});
+    room->update(std::move(roomData));
+}
+
+TestUtils::TestRoom *UserListModelTest::makeRoom(const QString &roomId)
+{
+    auto room = new TestUtils::TestRoom(connection, roomId);
+    sync(room,
+         {
+             stateEvent(u"m.room.create"_s, QString(), {{u"creator"_s, u"@alice:kde.org"_s}}),
+             powerLevelsEvent({{u"@alice:kde.org"_s, 100}}),
+             memberEvent(u"@alice:kde.org"_s, u"Alice"_s),
+             memberEvent(u"@bob:kde.org"_s, u"Bob"_s),
+             memberEvent(u"@carol:kde.org"_s, u"carol"_s),
+             memberEvent(u"@dave:kde.org"_s, u"@dave"_s),
+         },
+         false);
+    return room;
+}
+
+QStringList UserListModelTest::userIds(const UserListModel &model)
+{
+    QStringList ids;
+    for (int row = 0; row < model.rowCount(); ++row) {
+        ids += model.data(model.index(row), UserListModel::UserIdRole).toString();
+    }
+    return ids;
+}
+
+void UserListModelTest::initTestCase()
+{
+    connection = Connection::makeMockConnection(u"@bob:kde.org"_s);
+}
+
+// Power level first and then case insensitive by name, ignoring a leading @.
+void UserListModelTest::sorted()
+{
+    UserListModel model;
+    model.setRoom(makeRoom(u"!sorted:kde.org"_s));
+    QCOMPARE(model.rowCount(), 0);
+    model.activate();
+    QCOMPARE(userIds(model), QStringList({u"@alice:kde.org"_s, u"@bob:kde.org"_s, u"@carol:kde.org"_s, u"@dave:kde.org"_s}));
+}
+
+void UserListModelTest::roles()
+{
+    UserListModel model;
+    model.setRoom(makeRoom(u"!roles:kde.org"_s));
+    model.activate();
+    QCOMPARE(model.data(model.index(0), UserListModel::DisplayNameRole).toString(), u"Alice"_s);
+    QCOMPARE(model.data(model.index(0), UserListModel::PowerLevelRole).toInt(), 100);
+    QCOMPARE(model.data(model.index(2), UserListModel::DisplayNameRole).toString(), u"carol"_s);
+    QCOMPARE(model.data(model.index(2), UserListModel::PowerLevelRole).toInt(), 0);
+    QCOMPARE(model.member(2).foldedName, u"carol"_s);
+}
+
+void UserListModelTest::joinAndLeave()
+{
+    UserListModel model;
+    auto room = makeRoom(u"!joinleave:kde.org"_s);
+    model.setRoom(room);
+    model.activate();
+
+    QSignalSpy insertSpy(&model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy removeSpy(&model, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+
+    sync(room, {memberEvent(u"@erin:kde.org"_s, u"Erin"_s), memberEvent(u"@bob:kde.org"_s, u"Bob"_s, u"leave"_s)});
+    QTRY_COMPARE(insertSpy.count(), 1);
+    QTRY_COMPARE(removeSpy.count(), 1);
+    QCOMPARE(resetSpy.count(), 0);
+    QCOMPARE(userIds(model), QStringList({u"@alice:kde.org"_s, u"@carol:kde.org"_s, u"@dave:kde.org"_s, u"@erin:kde.org"_s}));
+}
+
+void UserListModelTest::rename()
+{
+    UserListModel model;
+    auto room = makeRoom(u"!rename:kde.org"_s);
+    model.setRoom(room);
+    model.activate();
+
+    QSignalSpy moveSpy(&model, &QAbstractItemModel::rowsMoved);
+    sync(room, {memberEvent(u"@carol:kde.org"_s, u"Zoe"_s)});
+    QCOMPARE(moveSpy.count(), 1);
+    QCOMPARE(userIds(model), QStringList({u"@alice:kde.org"_s, u"@bob:kde.org"_s, u"@dave:kde.org"_s, u"@carol:kde.org"_s}));
+    QCOMPARE(model.data(model.index(3), UserListModel::DisplayNameRole).toString(), u"Zoe"_s);
+}
+
+void UserListModelTest::powerLevelChange()
+{
+    UserListModel model;
+    auto room = makeRoom(u"!powerlevels:kde.org"_s);
+    model.setRoom(room);
+    model.activate();
+
+    QSignalSpy layoutSpy(&model, &QAbstractItemModel::layoutChanged);
+    sync(room, {powerLevelsEvent({{u"@alice:kde.org"_s, 100}, {u"@dave:kde.org"_s, 50}})});
+    QCOMPARE(layoutSpy.count(), 1);
+    QCOMPARE(userIds(model), QStringList({u"@alice:kde.org"_s, u"@dave:kde.org"_s, u"@bob:kde.org"_s, u"@carol:kde.org"_s}));
+    QCOMPARE(model.data(model.index(1), UserListModel::PowerLevelRole).toInt(), 50);
+}
+
+void UserListModelTest::filter()
+{
+    UserListModel model;
+    model.setRoom(makeRoom(u"!filter:kde.org"_s));
+    model.activate();
+
+    UserFilterModel filterModel;
+    filterModel.setSourceModel(&model);
+    QCOMPARE(filterModel.rowCount(), 0);
+    filterModel.setFilterText(u"CAR"_s);
+    QCOMPARE(filterModel.rowCount(), 1);
+    QCOMPARE(filterModel.data(filterModel.index(0, 0), UserListModel::UserIdRole).toString(), u"@carol:kde.org"_s);
+    filterModel.setFilterText(u"kde.org"_s);
+    QCOMPARE(filterModel.rowCount(), 4);
+}
+
+TestUtils::TestRoom *UserListModelTest::benchmarkRoom()
+{
+    static TestUtils::TestRoom *room = nullptr;
+    if (!room) {
+        room = makeRoom(u"!benchmark:kde.org"_s);
+        QJsonArray events;
+        for (int i = 0; i < 5000; ++i) {
+            events += memberEvent(u"@user%1:kde.org"_s.arg(i), u"User %1"_s.arg(i));
+        }
+        sync(room, events, false);
+    }
+    return room;
+}
+
+void UserListModelTest::sortBenchmark()
+{
+    auto room = benchmarkRoom();
+    QBENCHMARK {
+        UserListModel model;
+        model.setRoom(room);
+        model.activate();
+    }
+}
+
+void UserListModelTest::filterBenchmark()
+{
+    auto room = benchmarkRoom();
+    UserListModel model;
+    model.setRoom(room);
+    model.activate();
+    QCOMPARE(model.rowCount(), 5004);
+
+    UserFilterModel filterModel;
+    filterModel.setSourceModel(&model);
+    QBENCHMARK {
+        filterModel.setFilterText(u"user 12"_s);
+    }
+    QCOMPARE(filterModel.rowCount(), 111);
+}
+
+QTEST_GUILESS_MAIN(UserListModelTest)
+#include "userlistmodeltest.moc"
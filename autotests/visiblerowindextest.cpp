@@ -0,0 +1,231 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QObject>
+#include <QRandomGenerator>
+#include <QStandardItemModel>
+#include <QTest>
+
+#include <algorithm>
+
+#include "models/visiblerowindex.h"
+
+using namespace Qt::StringLiterals;
+
+class VisibleRowIndexTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int HiddenRole = Qt::UserRole;
+
+    QStandardItemModel *model = nullptr;
+    VisibleRowIndex *index = nullptr;
+    int predicateCalls = 0;
+
+    void setRows(const QList<bool> &hidden);
+    QStandardItem *item(bool hidden);
+    void setHidden(int row, bool hidden);
+    QList<int> nextRows();
+    QList<int> expectedNextRows() const;
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void initial();
+    void insert();
+    void remove();
+    void hiddenChanged();
+    void otherRoleChanged();
+    void reset();
+    void random();
+};
+
+void VisibleRowIndexTest::init()
+{
+    model = new QStandardItemModel;
+    predicateCalls = 0;
+    index = new VisibleRowIndex(
+        model,
+        [this](int row) {
+            ++predicateCalls;
+            return !model->item(row)->data(HiddenRole).toBool();
+        },
+        {HiddenRole});
+}
+
+void VisibleRowIndexTest::cleanup()
+{
+    delete index;
+    index = nullptr;
+    delete model;
+    model = nullptr;
+}
+
+QStandardItem *VisibleRowIndexTest::item(bool hidden)
+{
+    auto item = new QStandardItem(u"row"_s);
+    item->setData(hidden, HiddenRole);
+    return item;
+}
+
+void VisibleRowIndexTest::setRows(const QList<bool> &hidden)
+{
+    model->clear();
+    for (const auto rowHidden : hidden) {
+        model->appendRow(item(rowHidden));
+    }
+}
+
+void VisibleRowIndexTest::setHidden(int row, bool hidden)
+{
+    model->item(row)->setData(hidden, HiddenRole);
+}
+
+QList<int> VisibleRowIndexTest::nextRows()
+{
+    QList<int> rows;
+    for (int row = 0; row < model->rowCount(); ++row) {
+        rows += index->nextVisibleRow(row);
+    }
+    return rows;
+}
+
+QList<int> VisibleRowIndexTest::expectedNextRows() const
+{
+    QList<int> rows;
+    for (int row = 0; row < model->rowCount(); ++row) {
+        int next = -1;
+        for (int r = row + 1; r < model->rowCount(); ++r) {
+            if (!model->item(r)->data(HiddenRole).toBool()) {
+                next = r;
+                break;
+            }
+        }
+        rows += next;
+    }
+    return rows;
+}
+
+void VisibleRowIndexTest::initial()
+{
+    setRows({false, true, true, false, true});
+    QCOMPARE(nextRows(), (QList<int>{3, 3, 3, -1, -1}));
+    QCOMPARE(index->nextVisibleRow(-1), -1);
+    QCOMPARE(index->nextVisibleRow(5), -1);
+}
+
+void VisibleRowIndexTest::insert()
+{
+    setRows({false, true, true, false, true});
+    QCOMPARE(nextRows(), expectedNextRows());
+
+    // A visible row in the middle of a hidden run.
+    predicateCalls = 0;
+    model->insertRow(2, item(false));
+    QCOMPARE(predicateCalls, 1);
+    QCOMPARE(nextRows(), (QList<int>{2, 2, 4, 4, -1, -1}));
+
+    // Rows at either end.
+    model->insertRow(0, item(true));
+    model->appendRow(item(false));
+    QCOMPARE(nextRows(), expectedNextRows());
+    QCOMPARE(index->nextVisibleRow(5), 7);
+}
+
+void VisibleRowIndexTest::remove()
+{
+    setRows({false, true, false, true, false});
+    QCOMPARE(nextRows(), (QList<int>{2, 2, 4, 4, -1}));
+
+    // Removing the next visible row moves it on to the one after.
+    predicateCalls = 0;
+    model->removeRow(2);
+    QCOMPARE(predicateCalls, 0);
+    QCOMPARE(nextRows(), (QList<int>{3, 3, 3, -1}));
+
+    model->removeRows(2, 2);
+    QCOMPARE(nextRows(), (QList<int>{-1, -1}));
+
+    model->removeRow(0);
+    QCOMPARE(nextRows(), QList<int>{-1});
+}
+
+void VisibleRowIndexTest::hiddenChanged()
+{
+    setRows({false, false, false, false, false});
+    QCOMPARE(nextRows(), (QList<int>{1, 2, 3, 4, -1}));
+
+    predicateCalls = 0;
+    setHidden(2, true);
+    QCOMPARE(predicateCalls, 1);
+    QCOMPARE(nextRows(), (QList<int>{1, 3, 3, 4, -1}));
+
+    setHidden(3, true);
+    setHidden(4, true);
+    QCOMPARE(nextRows(), (QList<int>{1, -1, -1, -1, -1}));
+
+    setHidden(3, false);
+    QCOMPARE(nextRows(), (QList<int>{1, 3, 3, -1, -1}));
+}
+
+void VisibleRowIndexTest::otherRoleChanged()
+{
+    setRows({false, true, false});
+    QCOMPARE(nextRows(), (QList<int>{2, 2, -1}));
+
+    // Roles the predicate doesn't depend on are ignored.
+    predicateCalls = 0;
+    model->item(1)->setData(u"changed"_s, Qt::DisplayRole);
+    QCOMPARE(predicateCalls, 0);
+    QCOMPARE(nextRows(), (QList<int>{2, 2, -1}));
+}
+
+void VisibleRowIndexTest::reset()
+{
+    setRows({false, true, false});
+    QCOMPARE(nextRows(), (QList<int>{2, 2, -1}));
+
+    // A reset is only rebuilt once the index is queried.
+    setRows({true, false, true, false});
+    predicateCalls = 0;
+    QCOMPARE(nextRows(), (QList<int>{1, 3, 3, -1}));
+    QCOMPARE(predicateCalls, 4);
+
+    // A change to something the model doesn't signal.
+    model->blockSignals(true);
+    setHidden(1, true);
+    model->blockSignals(false);
+    index->invalidate();
+    QCOMPARE(nextRows(), (QList<int>{3, 3, 3, -1}));
+}
+
+void VisibleRowIndexTest::random()
+{
+    QRandomGenerator random(42);
+    setRows({});
+    for (int i = 0; i < 2000; ++i) {
+        const auto rowCount = model->rowCount();
+        switch (random.bounded(3)) {
+        case 0:
+            model->insertRow(random.bounded(rowCount + 1), item(random.bounded(3) > 0));
+            break;
+        case 1:
+            if (rowCount > 0) {
+                const auto first = random.bounded(rowCount);
+                model->removeRows(first, random.bounded(1, std::min(rowCount - first, 3) + 1));
+            }
+            break;
+        case 2:
+            if (rowCount > 0) {
+                setHidden(random.bounded(rowCount), random.bounded(3) > 0);
+            }
+            break;
+        }
+        QCOMPARE(nextRows(), expectedNextRows());
+    }
+}
+
+QTEST_GUILESS_MAIN(VisibleRowIndexTest)
+#include "visiblerowindextest.moc"
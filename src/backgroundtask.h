@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QFuture>
+#include <QPromise>
+#include <QThreadPool>
+
+#include <memory>
+#include <type_traits>
+
+namespace BackgroundTask
+{
+
+/**
+ * @brief Call the given function on the global thread pool.
+ *
+ * @return a future for the function's result, which is finished once the
+ *         function has returned.
+ */
+template<typename Function>
+QFuture<std::invoke_result_t<Function>> run(Function function)
+{
+    using Result = std::invoke_result_t<Function>;
+    // Shared so that the runnable stays copyable.
+    auto promise = std::make_shared<QPromise<Result>>();
+    auto future = promise->future();
+    promise->start();
+    QThreadPool::globalInstance()->start([promise, function = std::move(function)]() {
+        promise->addResult(function());
+        promise->finish();
+    });
+    return future;
+}
+
+}
@@ -3,6 +3,7 @@
 
 #include "blurhash.h"
 
+#include <algorithm>
 #include <math.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -28,6 +29,34 @@ inline int linearTosRGB(float value)
         return (1.055 * powf(v, 1 / 2.4) - 0.055) * 255 + 0.5;
 }
 
+// Lookup table for linearTosRGB() over [0, 1]. The steepest part of the curve
+// moves ~3300 sRGB steps per unit so 4096 entries keeps every result within 1.
+constexpr int linearTosRGBTableSize = 4096;
+
+struct LinearTosRGBTable {
+    uint8_t values[linearTosRGBTableSize + 1];
+
+    LinearTosRGBTable()
+    {
+        for (int i = 0; i <= linearTosRGBTableSize; i++) {
+            values[i] = linearTosRGB((float)i / linearTosRGBTableSize);
+        }
+    }
+};
+
+const LinearTosRGBTable &linearTosRGBTable()
+{
+    static const LinearTosRGBTable table;
+    return table;
+}
+
+inline uint8_t linearTosRGBLookup(const LinearTosRGBTable &table, float value)
+{
+    // Plain comparisons rather than fmaxf/fminf, which may not be inlined.
+    const float v = value < 0 ? 0 : (value > 1 ? 1 : value);
+    return table.values[(int)(v * linearTosRGBTableSize + 0.5f)];
+}
+
 inline float sRGBToLinear(int value)
 {
     float v = (float)value / 255;
@@ -42,17 +71,40 @@ inline float signPow(float value, float exp)
     return copysignf(powf(fabsf(value), exp), value);
 }
 
-inline uint8_t clampToUByte(int *src)
+inline uint8_t *createByteArray(int size)
+{
+    return (uint8_t *)malloc(size * sizeof(uint8_t));
+}
+
+inline float clamp(float value, float min, float max)
+{
+    return value < min ? min : (value > max ? max : value);
+}
+
+void encodeInt(int value, int length, std::string &destination)
 {
-    if (*src >= 0 && *src <= 255) {
-        return *src;
+    int divisor = 1;
+    for (int i = 0; i < length - 1; i++) {
+        divisor *= 83;
+    }
+    for (int i = 0; i < length; i++) {
+        const int digit = (value / divisor) % 83;
+        divisor /= 83;
+        destination += chars[digit];
     }
-    return (*src < 0) ? 0 : 255;
 }
 
-inline uint8_t *createByteArray(int size)
+int encodeDC(const Color &color)
 {
-    return (uint8_t *)malloc(size * sizeof(uint8_t));
+    return (linearTosRGB(color.r) << 16) + (linearTosRGB(color.g) << 8) + linearTosRGB(color.b);
+}
+
+int encodeAC(const Color &color, float maximumValue)
+{
+    const int quantR = (int)clamp(floorf(signPow(color.r / maximumValue, 0.5) * 9 + 9.5), 0, 18);
+    const int quantG = (int)clamp(floorf(signPow(color.g / maximumValue, 0.5) * 9 + 9.5), 0, 18);
+    const int quantB = (int)clamp(floorf(signPow(color.b / maximumValue, 0.5) * 9 + 9.5), 0, 18);
+    return quantR * 19 * 19 + quantG * 19 + quantB;
 }
 
 int decodeToInt(const char *string, int start, int end)
@@ -136,34 +188,62 @@ int decodeToArray(const char *blurhash, int width, int height, int punch, int nC
         }
     }
 
-    int bytesPerRow = width * nChannels;
-    int x = 0, y = 0, i = 0, j = 0;
-    int intR = 0, intG = 0, intB = 0;
+    // The basis function is separable, cos(x) * cos(y), so precompute both factors
+    // once rather than calling cos() twice per component for every pixel. The x
+    // table is stored component major so the inner loop runs over contiguous x.
+    std::vector<float> basisX(numX * width);
+    for (int i = 0; i < numX; i++) {
+        for (int x = 0; x < width; x++) {
+            basisX[i * width + x] = cos((M_PI * x * i) / width);
+        }
+    }
+    std::vector<float> basisY(numY * height);
+    for (int y = 0; y < height; y++) {
+        for (int j = 0; j < numY; j++) {
+            basisY[y * numY + j] = cos((M_PI * y * j) / height);
+        }
+    }
 
-    for (y = 0; y < height; y++) {
-        for (x = 0; x < width; x++) {
-            float r = 0, g = 0, b = 0;
+    std::vector<float> rowR(width), rowG(width), rowB(width);
+    const int bytesPerRow = width * nChannels;
+    const LinearTosRGBTable &sRGBTable = linearTosRGBTable();
 
-            for (j = 0; j < numY; j++) {
-                for (i = 0; i < numX; i++) {
-                    float basics = cos((M_PI * x * i) / width) * cos((M_PI * y * j) / height);
-                    int idx = i + j * numX;
-                    r += colors[idx].r * basics;
-                    g += colors[idx].g * basics;
-                    b += colors[idx].b * basics;
-                }
+    for (int y = 0; y < height; y++) {
+        std::fill(rowR.begin(), rowR.end(), 0.0f);
+        std::fill(rowG.begin(), rowG.end(), 0.0f);
+        std::fill(rowB.begin(), rowB.end(), 0.0f);
+
+        for (int i = 0; i < numX; i++) {
+            // Fold the y basis for this row into the colour of each x component.
+            float r = 0, g = 0, b = 0;
+            for (int j = 0; j < numY; j++) {
+                const Color &c = colors[i + j * numX];
+                const float basisValue = basisY[y * numY + j];
+                r += c.r * basisValue;
+                g += c.g * basisValue;
+                b += c.b * basisValue;
             }
 
-            intR = linearTosRGB(r);
-            intG = linearTosRGB(g);
-            intB = linearTosRGB(b);
+            // Plain multiply-add over contiguous arrays so the compiler can vectorise it.
+            const float *basis = basisX.data() + i * width;
+            float *__restrict outR = rowR.data();
+            float *__restrict outG = rowG.data();
+            float *__restrict outB = rowB.data();
+            for (int x = 0; x < width; x++) {
+                outR[x] += r * basis[x];
+                outG[x] += g * basis[x];
+                outB[x] += b * basis[x];
+            }
+        }
 
-            pixelArray[nChannels * x + 0 + y * bytesPerRow] = clampToUByte(&intR);
-            pixelArray[nChannels * x + 1 + y * bytesPerRow] = clampToUByte(&intG);
-            pixelArray[nChannels * x + 2 + y * bytesPerRow] = clampToUByte(&intB);
+        uint8_t *pixel = pixelArray + y * bytesPerRow;
+        for (int x = 0; x < width; x++, pixel += nChannels) {
+            pixel[0] = linearTosRGBLookup(sRGBTable, rowR[x]);
+            pixel[1] = linearTosRGBLookup(sRGBTable, rowG[x]);
+            pixel[2] = linearTosRGBLookup(sRGBTable, rowB[x]);
 
             if (nChannels == 4) {
-                pixelArray[nChannels * x + 3 + y * bytesPerRow] = 255;
+                pixel[3] = 255;
             }
         }
     }
@@ -177,11 +257,92 @@ uint8_t *decode(const char *blurhash, int width, int height, int punch, int nCha
     uint8_t *pixelArray = createByteArray(bytesPerRow * height);
 
     if (decodeToArray(blurhash, width, height, punch, nChannels, pixelArray) == -1) {
+        free(pixelArray);
         return nullptr;
     }
     return pixelArray;
 }
 
+std::string encode(const uint8_t *pixels, int width, int height, int bytesPerRow, int nChannels, int xComponents, int yComponents)
+{
+    if (!pixels || width < 1 || height < 1 || nChannels < 3 || xComponents < 1 || xComponents > 9 || yComponents < 1 || yComponents > 9) {
+        return {};
+    }
+
+    // Convert every pixel to linear once rather than once per component.
+    float sRGBTable[256];
+    for (int i = 0; i < 256; i++) {
+        sRGBTable[i] = sRGBToLinear(i);
+    }
+
+    // As in decodeToArray() the basis function is separable, so first sum each row
+    // against the x basis and then sum the rows against the y basis.
+    std::vector<float> basisX(xComponents * width);
+    for (int i = 0; i < xComponents; i++) {
+        for (int x = 0; x < width; x++) {
+            basisX[i * width + x] = cos((M_PI * x * i) / width);
+        }
+    }
+
+    std::vector<Color> factors(xComponents * yComponents);
+    std::vector<Color> rowFactors(xComponents);
+    for (int y = 0; y < height; y++) {
+        std::fill(rowFactors.begin(), rowFactors.end(), Color());
+        const uint8_t *row = pixels + y * bytesPerRow;
+        for (int x = 0; x < width; x++) {
+            const uint8_t *pixel = row + x * nChannels;
+            const float r = sRGBTable[pixel[0]];
+            const float g = sRGBTable[pixel[1]];
+            const float b = sRGBTable[pixel[2]];
+            for (int i = 0; i < xComponents; i++) {
+                const float basis = basisX[i * width + x];
+                rowFactors[i].r += basis * r;
+                rowFactors[i].g += basis * g;
+                rowFactors[i].b += basis * b;
+            }
+        }
+        for (int j = 0; j < yComponents; j++) {
+            const float basis = cos((M_PI * y * j) / height);
+            for (int i = 0; i < xComponents; i++) {
+                Color &factor = factors[j * xComponents + i];
+                factor.r += basis * rowFactors[i].r;
+                factor.g += basis * rowFactors[i].g;
+                factor.b += basis * rowFactors[i].b;
+            }
+        }
+    }
+
+    for (int i = 0; i < xComponents * yComponents; i++) {
+        const float scale = (i == 0 ? 1.0f : 2.0f) / (width * height);
+        factors[i].r *= scale;
+        factors[i].g *= scale;
+        factors[i].b *= scale;
+    }
+
+    std::string hash;
+    hash.reserve(4 + 2 * xComponents * yComponents);
+    encodeInt((xComponents - 1) + (yComponents - 1) * 9, 1, hash);
+
+    float maximumValue = 1;
+    if (factors.size() > 1) {
+        float actualMaximumValue = 0;
+        for (size_t i = 1; i < factors.size(); i++) {
+            actualMaximumValue = std::max({actualMaximumValue, fabsf(factors[i].r), fabsf(factors[i].g), fabsf(factors[i].b)});
+        }
+        const int quantisedMaximumValue = (int)clamp(floorf(actualMaximumValue * 166 - 0.5), 0, 82);
+        maximumValue = ((float)quantisedMaximumValue + 1) / 166;
+        encodeInt(quantisedMaximumValue, 1, hash);
+    } else {
+        encodeInt(0, 1, hash);
+    }
+
+    encodeInt(encodeDC(factors[0]), 4, hash);
+    for (size_t i = 1; i < factors.size(); i++) {
+        encodeInt(encodeAC(factors[i], maximumValue), 2, hash);
+    }
+    return hash;
+}
+
 bool isValidBlurhash(const char *blurhash)
 {
     const int hashLength = strlen(blurhash);
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <string>
 
 /**
  * @brief Returns the pixel array of the result image given the blurhash string.
@@ -18,6 +19,21 @@
  */
 uint8_t *decode(const char *blurhash, int width, int height, int punch, int nChannels);
 
+/**
+ * @brief Returns the blurhash for the given pixel array.
+ *
+ * @param pixels the pixels of the image in (H, W, C) format, with the channels in RGB order.
+ * @param width the width of the image.
+ * @param height the height of the image.
+ * @param bytesPerRow the number of bytes between the start of each row.
+ * @param nChannels the number of channels for each pixel, 3 = RGB, 4 = RGBA or RGBX.
+ * @param xComponents the number of horizontal components, 1 to 9.
+ * @param yComponents the number of vertical components, 1 to 9.
+ *
+ * @return The blurhash string, empty if the parameters are invalid.
+ */
+std::string encode(const uint8_t *pixels, int width, int height, int bytesPerRow, int nChannels, int xComponents, int yComponents);
+
 /**
  * @brief Checks if the Blurhash is valid or not.
  *
@@ -3,13 +3,30 @@
 
 #include "blurhashimageprovider.h"
 
-#include <QImage>
-#include <QString>
+#include <QMutexLocker>
+#include <QUrl>
+
+#include <algorithm>
+#include <optional>
 
 #include "blurhash.h"
 
-BlurhashImageProvider::BlurhashImageProvider()
+namespace
+{
+// A blurhash has at most 9 components along each axis so a decode of this many
+// pixels per axis already resolves every gradient, scaling it up is indistinguishable
+// from decoding at the larger size.
+constexpr int minimumScaleSourceSize = 64;
+
+bool canScale(const QSize &from, const QSize &to)
+{
+    return from.width() >= std::min(to.width(), minimumScaleSourceSize) && from.height() >= std::min(to.height(), minimumScaleSourceSize);
+}
+}
+
+BlurhashImageProvider::BlurhashImageProvider(qsizetype maxCacheSize)
     : QQuickImageProvider(QQuickImageProvider::Image)
+    , m_cache(maxCacheSize)
 {
 }
 
@@ -25,7 +42,126 @@ QImage BlurhashImageProvider::requestImage(const QString &id, QSize *size, const
     if (size->height() == -1) {
         size->setHeight(256);
     }
-    auto data = decode(QUrl::fromPercentEncoding(id.toLatin1()).toLatin1().data(), size->width(), size->height(), 1, 3);
+
+    const auto hash = QUrl::fromPercentEncoding(id.toLatin1());
+    Key key{hash, *size};
+    {
+        QMutexLocker locker(&m_mutex);
+        if (const auto cached = m_cache.object(key)) {
+            ++m_hits;
+            return *cached;
+        }
+        const auto scaled = scaledFromCache(hash, *size);
+        if (!scaled.isNull()) {
+            ++m_scaledHits;
+            insertInCache(key, scaled);
+            return scaled;
+        }
+        ++m_misses;
+    }
+
+    // Decode without holding the lock so that other requests aren't blocked.
+    auto data = decode(hash.toLatin1().data(), size->width(), size->height(), 1, 3);
+    if (!data) {
+        return QImage();
+    }
     QImage image(data, size->width(), size->height(), size->width() * 3, QImage::Format_RGB888, free, data);
+
+    QMutexLocker locker(&m_mutex);
+    insertInCache(std::move(key), image);
     return image;
-}
\ No newline at end of file
+}
+
+void BlurhashImageProvider::insertInCache(Key key, const QImage &image)
+{
+    auto &sizes = m_sizes[key.hash];
+    if (!sizes.contains(key.size)) {
+        sizes.append(key.size);
+    }
+    m_cache.insert(std::move(key), new QImage(image), image.sizeInBytes());
+
+    // Every cached image has a size listed, so once there are more hashes than
+    // images most of them only hold evicted sizes.
+    if (m_sizes.size() > 2 * m_cache.size()) {
+        m_sizes.removeIf([this](QHash<QString, QList<QSize>>::iterator it) {
+            it.value().removeIf([this, &it](const QSize &size) {
+                return !m_cache.contains(Key{it.key(), size});
+            });
+            return it.value().isEmpty();
+        });
+    }
+}
+
+QImage BlurhashImageProvider::scaledFromCache(const QString &hash, const QSize &size)
+{
+    const auto it = m_sizes.find(hash);
+    if (it == m_sizes.end()) {
+        return QImage();
+    }
+    it->removeIf([this, &hash](const QSize &cachedSize) {
+        return !m_cache.contains(Key{hash, cachedSize});
+    });
+
+    std::optional<QSize> sourceSize;
+    for (const auto &cachedSize : std::as_const(*it)) {
+        if (!canScale(cachedSize, size)) {
+            continue;
+        }
+        if (!sourceSize || qint64(cachedSize.width()) * cachedSize.height() > qint64(sourceSize->width()) * sourceSize->height()) {
+            sourceSize = cachedSize;
+        }
+    }
+    if (it->isEmpty()) {
+        m_sizes.erase(it);
+    }
+    if (!sourceSize) {
+        return QImage();
+    }
+    return m_cache.object(Key{hash, *sourceSize})->scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+}
+
+qsizetype BlurhashImageProvider::maxCacheSize() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cache.maxCost();
+}
+
+void BlurhashImageProvider::setMaxCacheSize(qsizetype maxCacheSize)
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.setMaxCost(maxCacheSize);
+    if (m_cache.isEmpty()) {
+        m_sizes.clear();
+    }
+}
+
+qsizetype BlurhashImageProvider::cacheSize() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cache.totalCost();
+}
+
+quint64 BlurhashImageProvider::hits() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hits;
+}
+
+quint64 BlurhashImageProvider::scaledHits() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_scaledHits;
+}
+
+quint64 BlurhashImageProvider::misses() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_misses;
+}
+
+qreal BlurhashImageProvider::hitRate() const
+{
+    QMutexLocker locker(&m_mutex);
+    const auto total = m_hits + m_scaledHits + m_misses;
+    return total > 0 ? qreal(m_hits + m_scaledHits) / qreal(total) : 0.0;
+}
@@ -3,19 +3,39 @@
 
 #pragma once
 
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QMutex>
 #include <QQuickImageProvider>
+#include <QSize>
+#include <QString>
 
 /**
  * @class BlurhashImageProvider
  *
  * A QQuickImageProvider for blurhashes.
  *
+ * Decoded images are kept in a least recently used cache keyed by the hash and
+ * size, bounded by the number of bytes held. As a blurhash is only a handful of
+ * smooth gradients a request that misses the cache will be served by scaling an
+ * already cached decode of the same hash when that decode has enough resolution.
+ *
+ * requestImage() may be called from the image loading threads so access to the
+ * cache is serialized.
+ *
  * @sa QQuickImageProvider
  */
 class BlurhashImageProvider : public QQuickImageProvider
 {
 public:
-    BlurhashImageProvider();
+    /**
+     * @brief The default maximum number of bytes of decoded images to cache.
+     */
+    static constexpr qsizetype DefaultCacheSize = 16 * 1024 * 1024;
+
+    explicit BlurhashImageProvider(qsizetype maxCacheSize = DefaultCacheSize);
 
     /**
      * @brief Return an image for a given ID.
@@ -23,4 +43,65 @@ public:
      * @sa QQuickImageProvider::requestImage
      */
     QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+
+    /**
+     * @brief The maximum number of bytes of decoded images to cache.
+     */
+    [[nodiscard]] qsizetype maxCacheSize() const;
+    void setMaxCacheSize(qsizetype maxCacheSize);
+
+    /**
+     * @brief The number of bytes of decoded images currently cached.
+     */
+    [[nodiscard]] qsizetype cacheSize() const;
+
+    /**
+     * @brief The number of requests served by an exact cached decode.
+     */
+    [[nodiscard]] quint64 hits() const;
+
+    /**
+     * @brief The number of requests served by scaling a cached decode of a different size.
+     */
+    [[nodiscard]] quint64 scaledHits() const;
+
+    /**
+     * @brief The number of requests that needed a new decode.
+     */
+    [[nodiscard]] quint64 misses() const;
+
+    /**
+     * @brief The fraction of requests that were served without decoding.
+     *
+     * Returns 0 if there have been no requests.
+     */
+    [[nodiscard]] qreal hitRate() const;
+
+private:
+    struct Key {
+        QString hash;
+        QSize size;
+
+        friend bool operator==(const Key &lhs, const Key &rhs)
+        {
+            return lhs.size == rhs.size && lhs.hash == rhs.hash;
+        }
+
+        friend size_t qHash(const Key &key, size_t seed = 0)
+        {
+            return qHashMulti(seed, key.hash, key.size.width(), key.size.height());
+        }
+    };
+
+    void insertInCache(Key key, const QImage &image);
+    QImage scaledFromCache(const QString &hash, const QSize &size);
+
+    mutable QMutex m_mutex;
+    QCache<Key, QImage> m_cache;
+    // The sizes cached for each hash. QCache evicts silently so this may hold sizes
+    // that are gone, they are dropped when the hash is next looked at.
+    QHash<QString, QList<QSize>> m_sizes;
+    quint64 m_hits = 0;
+    quint64 m_scaledHits = 0;
+    quint64 m_misses = 0;
 };
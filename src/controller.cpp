@@ -17,11 +17,13 @@
 #include <Quotient/qt_connection_util.h>
 #include <Quotient/settings.h>
 
+#include "modelcache.h"
 #include "neochatconfig.h"
 #include "neochatconnection.h"
 #include "neochatroom.h"
 #include "notificationsmanager.h"
 #include "proxycontroller.h"
+#include "statesavescheduler.h"
 
 #if defined(Q_OS_WIN) || defined(Q_OS_MAC)
 #include "trayicon.h"
@@ -52,6 +54,11 @@ Controller::Controller(QObject *parent)
 
     ProxyController::instance().setApplicationProxy();
 
+    ModelCacheBase::setGlobalCapacity(NeoChatConfig::globalModelCacheSize());
+    connect(NeoChatConfig::self(), &NeoChatConfig::GlobalModelCacheSizeChanged, this, [] {
+        ModelCacheBase::setGlobalCapacity(NeoChatConfig::globalModelCacheSize());
+    });
+
 #ifndef Q_OS_ANDROID
     setQuitOnLastWindowClosed();
     connect(NeoChatConfig::self(), &NeoChatConfig::SystemTrayChanged, this, &Controller::setQuitOnLastWindowClosed);
@@ -148,9 +155,10 @@ void Controller::addConnection(NeoChatConnection *c)
 
     c->setLazyLoading(true);
 
+    // Saving the state is deferred so that a busy account isn't saved after every sync.
+    new StateSaveScheduler(c);
     connect(c, &NeoChatConnection::syncDone, this, [c] {
         c->sync(30000);
-        c->saveState();
     });
     connect(c, &NeoChatConnection::loggedOut, this, [this, c] {
         if (accounts().count() > 1) {
@@ -328,7 +336,6 @@ void Controller::setActiveConnection(NeoChatConnection *connection)
     m_connection = connection;
 
     if (m_connection != nullptr) {
-        m_connection->refreshBadgeNotificationCount();
         updateBadgeNotificationCount(m_connection, m_connection->badgeNotificationCount());
 
         connect(m_connection, &NeoChatConnection::errorOccured, this, &Controller::errorOccured);
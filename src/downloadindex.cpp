@@ -0,0 +1,167 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "downloadindex.h"
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QThreadPool>
+
+#include <utility>
+
+using namespace Qt::StringLiterals;
+
+namespace
+{
+constexpr std::chrono::milliseconds DefaultRecheckInterval = std::chrono::seconds(10);
+constexpr std::chrono::milliseconds SyncDelay = std::chrono::seconds(1);
+}
+
+DownloadIndex::DownloadIndex()
+    : m_recheckInterval(DefaultRecheckInterval)
+    , m_config(KSharedConfig::openStateConfig(u"neochatdownloads"_s))
+    , m_configGroup(KConfigGroup(m_config, u"downloads"_s))
+{
+    const auto mxcIds = m_configGroup.keyList();
+    m_downloads.reserve(mxcIds.size());
+    for (const auto &mxcId : mxcIds) {
+        m_downloads.insert(mxcId, {.path = m_configGroup.readPathEntry(mxcId, QString())});
+    }
+
+    // Gather the lookups made while painting a view into a single job.
+    m_checkTimer.setSingleShot(true);
+    m_checkTimer.setInterval(0);
+    connect(&m_checkTimer, &QTimer::timeout, this, &DownloadIndex::startChecks);
+
+    // Downloads often finish in bursts, write them together but soon enough that
+    // a crash doesn't lose them.
+    m_syncTimer.setSingleShot(true);
+    m_syncTimer.setInterval(SyncDelay);
+    connect(&m_syncTimer, &QTimer::timeout, this, &DownloadIndex::sync);
+    if (const auto app = QCoreApplication::instance()) {
+        connect(app, &QCoreApplication::aboutToQuit, this, &DownloadIndex::sync);
+    }
+}
+
+DownloadIndex::~DownloadIndex()
+{
+    sync();
+}
+
+DownloadIndex &DownloadIndex::instance()
+{
+    static DownloadIndex instance;
+    return instance;
+}
+
+std::optional<QString> DownloadIndex::localPath(const QString &mxcId)
+{
+    const auto it = m_downloads.find(mxcId);
+    if (it == m_downloads.end()) {
+        return std::nullopt;
+    }
+    if (it->verified && it->recheck.hasExpired()) {
+        // The file may have been deleted since it was last found.
+        it->verified = false;
+    }
+    if (!it->verified && !it->checking) {
+        it->checking = true;
+        m_pendingChecks.append(Check{.mxcId = mxcId, .path = it->path});
+        m_checkTimer.start();
+    }
+    return it->path;
+}
+
+bool DownloadIndex::isVerified(const QString &mxcId) const
+{
+    const auto it = m_downloads.constFind(mxcId);
+    return it != m_downloads.constEnd() && it->verified;
+}
+
+void DownloadIndex::addDownload(const QString &mxcId, const QString &localPath)
+{
+    // The file has just been written so there is no need to check it.
+    auto &download = m_downloads[mxcId];
+    download = {.path = localPath};
+    markVerified(download);
+    m_configGroup.writePathEntry(mxcId, localPath);
+    scheduleSync();
+}
+
+void DownloadIndex::removeDownload(const QString &mxcId)
+{
+    if (m_downloads.remove(mxcId)) {
+        m_configGroup.deleteEntry(mxcId);
+        scheduleSync();
+    }
+}
+
+bool DownloadIndex::isSyncPending() const
+{
+    return m_syncTimer.isActive();
+}
+
+void DownloadIndex::setRecheckInterval(std::chrono::milliseconds interval)
+{
+    m_recheckInterval = interval;
+    for (auto &download : m_downloads) {
+        if (download.verified) {
+            markVerified(download);
+        }
+    }
+}
+
+void DownloadIndex::markVerified(Download &download) const
+{
+    download.verified = true;
+    download.checking = false;
+    download.recheck = QDeadlineTimer(m_recheckInterval);
+}
+
+void DownloadIndex::scheduleSync()
+{
+    // Not restarted by later changes so that a steady stream of downloads is still written.
+    if (!m_syncTimer.isActive()) {
+        m_syncTimer.start();
+    }
+}
+
+void DownloadIndex::sync()
+{
+    m_syncTimer.stop();
+    m_config->sync();
+}
+
+void DownloadIndex::startChecks()
+{
+    QThreadPool::globalInstance()->start([this, checks = std::exchange(m_pendingChecks, {})]() mutable {
+        for (auto &check : checks) {
+            check.exists = QFileInfo(check.path).isFile();
+        }
+        QMetaObject::invokeMethod(
+            this,
+            [this, checks]() {
+                finishChecks(checks);
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+void DownloadIndex::finishChecks(const QList<Check> &checks)
+{
+    for (const auto &check : checks) {
+        const auto it = m_downloads.find(check.mxcId);
+        // Ignore results for downloads that have been replaced since the check started.
+        if (it == m_downloads.end() || it->verified || it->path != check.path) {
+            continue;
+        }
+        if (check.exists) {
+            markVerified(*it);
+        } else {
+            removeDownload(check.mxcId);
+        }
+        Q_EMIT downloadChecked(check.mxcId, check.exists);
+    }
+}
+
+#include "moc_downloadindex.cpp"
@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+#include <KConfigGroup>
+#include <KSharedConfig>
+
+#include <chrono>
+#include <optional>
+
+/**
+ * @class DownloadIndex
+ *
+ * The local paths of downloaded files keyed by their mxc ID.
+ *
+ * The index is read from the state config once and then kept in memory so that
+ * looking up a download doesn't parse the config or touch the filesystem.
+ *
+ * Whether a file still exists is checked the first time it is looked up on a
+ * thread pool thread, the download is assumed to exist until then. If the file
+ * has gone the download is removed and downloadChecked() is emitted so that
+ * anything showing it can update. After that the file is checked again in the same
+ * way when it is looked up, at most once per recheck interval, so a file deleted
+ * later is noticed.
+ *
+ * Changes are written to the state config in batches shortly after they are made.
+ */
+class DownloadIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    static DownloadIndex &instance();
+    ~DownloadIndex() override;
+
+    /**
+     * @brief The local path of the download of the given mxc ID, if any.
+     *
+     * Schedules a check that the file exists if that hasn't been done yet.
+     */
+    std::optional<QString> localPath(const QString &mxcId);
+
+    /**
+     * @brief Whether the file for the given mxc ID is known to exist.
+     */
+    bool isVerified(const QString &mxcId) const;
+
+    /**
+     * @brief Record a completed download.
+     */
+    void addDownload(const QString &mxcId, const QString &localPath);
+
+    /**
+     * @brief Forget the download of the given mxc ID.
+     */
+    void removeDownload(const QString &mxcId);
+
+    /**
+     * @brief Whether there are changes that haven't been written to the config yet.
+     */
+    [[nodiscard]] bool isSyncPending() const;
+
+    /**
+     * @brief Set how long a file that has been found is trusted to still exist.
+     */
+    void setRecheckInterval(std::chrono::milliseconds interval);
+
+Q_SIGNALS:
+    /**
+     * @brief The file for the given mxc ID has been checked.
+     *
+     * If the file doesn't exist the download has already been removed.
+     */
+    void downloadChecked(const QString &mxcId, bool exists);
+
+private:
+    DownloadIndex();
+
+    struct Download {
+        QString path;
+        bool verified = false;
+        bool checking = false;
+        // When a verified file needs to be checked again.
+        QDeadlineTimer recheck;
+    };
+    QHash<QString, Download> m_downloads;
+
+    struct Check {
+        QString mxcId;
+        QString path;
+        bool exists = false;
+    };
+    QList<Check> m_pendingChecks;
+    QTimer m_checkTimer;
+    void startChecks();
+    void finishChecks(const QList<Check> &checks);
+
+    std::chrono::milliseconds m_recheckInterval;
+    void markVerified(Download &download) const;
+
+    KSharedConfig::Ptr m_config;
+    KConfigGroup m_configGroup;
+    QTimer m_syncTimer;
+    void scheduleSync();
+    void sync();
+};
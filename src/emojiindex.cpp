@@ -0,0 +1,152 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "emojiindex.h"
+
+#include <algorithm>
+#include <array>
+
+namespace
+{
+bool isWordStart(const QString &text, qsizetype position)
+{
+    if (position == 0) {
+        return true;
+    }
+    const auto previous = text[position - 1];
+    return previous == u'_' || previous == u' ' || previous == u'-' || previous == u':';
+}
+
+bool hasWordPrefix(const QString &text, const QString &filter)
+{
+    for (auto position = text.indexOf(filter); position >= 0; position = text.indexOf(filter, position + 1)) {
+        if (isWordStart(text, position)) {
+            return true;
+        }
+    }
+    return false;
+}
+}
+
+int EmojiIndex::add(const QString &shortName, const QString &description)
+{
+    const int id = m_entries.size();
+    m_entries.append({.shortName = shortName.toLower(), .description = description.toLower()});
+    addGrams(m_entries.last().shortName, id);
+    addGrams(m_entries.last().description, id);
+    return id;
+}
+
+void EmojiIndex::reserve(qsizetype size)
+{
+    m_entries.reserve(size);
+}
+
+void EmojiIndex::clear()
+{
+    m_entries.clear();
+    m_grams.clear();
+}
+
+qsizetype EmojiIndex::size() const
+{
+    return m_entries.size();
+}
+
+quint64 EmojiIndex::gramKey(QStringView gram)
+{
+    // Up to three UTF-16 code units with the length in the top bits so that
+    // grams of different lengths never collide.
+    quint64 key = quint64(gram.size()) << 48;
+    for (qsizetype i = 0; i < gram.size(); ++i) {
+        key |= quint64(gram[i].unicode()) << (16 * i);
+    }
+    return key;
+}
+
+void EmojiIndex::addGrams(const QString &text, int id)
+{
+    for (qsizetype start = 0; start < text.size(); ++start) {
+        for (qsizetype length = 1; length <= GramSize && start + length <= text.size(); ++length) {
+            auto &ids = m_grams[gramKey(QStringView(text).sliced(start, length))];
+            // IDs are added in order so the list stays sorted and a repeated gram
+            // only needs to be compared with the last ID.
+            if (ids.isEmpty() || ids.last() != id) {
+                ids.append(id);
+            }
+        }
+    }
+}
+
+QList<int> EmojiIndex::search(const QString &filter, qsizetype limit) const
+{
+    QList<int> results;
+    if (filter.isEmpty()) {
+        const auto count = limit < 0 ? m_entries.size() : std::min(limit, m_entries.size());
+        results.reserve(count);
+        for (int id = 0; id < count; ++id) {
+            results.append(id);
+        }
+        return results;
+    }
+
+    const auto lowerFilter = filter.toLower();
+
+    // Every match contains every gram of the filter so only the entries with the
+    // rarest one need to be checked.
+    const auto gramLength = std::min(GramSize, lowerFilter.size());
+    const QList<int> *candidates = nullptr;
+    for (qsizetype start = 0; start + gramLength <= lowerFilter.size(); ++start) {
+        const auto it = m_grams.constFind(gramKey(QStringView(lowerFilter).sliced(start, gramLength)));
+        if (it == m_grams.constEnd()) {
+            return results;
+        }
+        if (!candidates || it->size() < candidates->size()) {
+            candidates = &*it;
+        }
+    }
+
+    // Candidates are in ID order so bucketing by rank keeps each bucket in ID order.
+    std::array<QList<int>, NoMatch> ranked;
+    for (const auto id : *candidates) {
+        const auto rank = lowerRank(id, lowerFilter);
+        if (rank != NoMatch) {
+            ranked[rank].append(id);
+        }
+    }
+    for (const auto &ids : ranked) {
+        for (const auto id : ids) {
+            if (limit >= 0 && results.size() >= limit) {
+                return results;
+            }
+            results.append(id);
+        }
+    }
+    return results;
+}
+
+EmojiIndex::Rank EmojiIndex::rank(int id, const QString &filter) const
+{
+    if (id < 0 || id >= m_entries.size()) {
+        return NoMatch;
+    }
+    return lowerRank(id, filter.toLower());
+}
+
+EmojiIndex::Rank EmojiIndex::lowerRank(int id, const QString &lowerFilter) const
+{
+    const auto &entry = m_entries[id];
+    if (entry.shortName == lowerFilter) {
+        return ExactName;
+    }
+    if (entry.shortName.startsWith(lowerFilter)) {
+        return NamePrefix;
+    }
+    if (entry.shortName.contains(lowerFilter)) {
+        return hasWordPrefix(entry.shortName, lowerFilter) ? NameWordPrefix : NameContains;
+    }
+    if (entry.description.contains(lowerFilter)) {
+        return hasWordPrefix(entry.description, lowerFilter) ? DescriptionWordPrefix : DescriptionContains;
+    }
+    return NoMatch;
+}
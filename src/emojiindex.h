@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+/**
+ * @class EmojiIndex
+ *
+ * A case insensitive substring search index over the short names and descriptions
+ * of a list of emojis.
+ *
+ * Every substring of up to three characters of each entry maps to the sorted list
+ * of entries that contain it. A filter of up to three characters is answered
+ * directly from its list, a longer filter only has to check the entries in the
+ * list of its rarest trigram rather than every entry.
+ *
+ * Entries are identified by the order they were added in, which is expected to
+ * match the row of the emoji in its model.
+ *
+ * @sa EmojiModel, CustomEmojiModel
+ */
+class EmojiIndex
+{
+public:
+    /**
+     * @brief How well an entry matches a filter, best first.
+     */
+    enum Rank {
+        ExactName, /**< The short name is the filter. */
+        NamePrefix, /**< The short name starts with the filter. */
+        NameWordPrefix, /**< A word in the short name starts with the filter. */
+        NameContains, /**< The short name contains the filter. */
+        DescriptionWordPrefix, /**< A word in the description starts with the filter. */
+        DescriptionContains, /**< The description contains the filter. */
+        NoMatch,
+    };
+
+    /**
+     * @brief Add an entry to the index.
+     *
+     * @return The ID of the entry, i.e. the number of entries added before it.
+     */
+    int add(const QString &shortName, const QString &description = {});
+
+    void reserve(qsizetype size);
+    void clear();
+
+    [[nodiscard]] qsizetype size() const;
+
+    /**
+     * @brief The IDs of the entries that contain the filter.
+     *
+     * Results are ordered by Rank and then by ID. An empty filter matches every
+     * entry.
+     *
+     * @param filter the text to search for.
+     * @param limit the maximum number of results, or -1 for all of them.
+     */
+    [[nodiscard]] QList<int> search(const QString &filter, qsizetype limit = -1) const;
+
+    /**
+     * @brief How well the given entry matches the given filter.
+     */
+    [[nodiscard]] Rank rank(int id, const QString &filter) const;
+
+private:
+    struct Entry {
+        QString shortName;
+        QString description;
+    };
+    QList<Entry> m_entries;
+    QHash<quint64, QList<int>> m_grams;
+
+    static constexpr qsizetype GramSize = 3;
+    static quint64 gramKey(QStringView gram);
+    void addGrams(const QString &text, int id);
+    Rank lowerRank(int id, const QString &lowerFilter) const;
+};
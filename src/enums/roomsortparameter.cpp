@@ -95,68 +95,81 @@ void RoomSortParameter::saveNewParameterList(const QList<Parameter> &newList)
     NeoChatConfig::self()->save();
 }
 
-int RoomSortParameter::compareParameter(Parameter parameter, NeoChatRoom *leftRoom, NeoChatRoom *rightRoom)
+RoomSortParameter::SortKeys RoomSortParameter::SortKeys::forRoom(NeoChatRoom *room)
+{
+    if (room == nullptr) {
+        return {};
+    }
+    return {
+        .displayName = room->displayName(),
+        .notificationCount = int(room->contextAwareNotificationCount()),
+        .highlightCount = int(room->highlightCount()),
+        .lastActiveTime = room->lastActiveTime(),
+    };
+}
+
+int RoomSortParameter::compareParameter(Parameter parameter, const SortKeys &leftKeys, const SortKeys &rightKeys)
 {
     switch (parameter) {
     case AlphabeticalAscending:
-        return compareParameter<AlphabeticalAscending>(leftRoom, rightRoom);
+        return compareParameter<AlphabeticalAscending>(leftKeys, rightKeys);
     case AlphabeticalDescending:
-        return compareParameter<AlphabeticalDescending>(leftRoom, rightRoom);
+        return compareParameter<AlphabeticalDescending>(leftKeys, rightKeys);
     case HasUnread:
-        return compareParameter<HasUnread>(leftRoom, rightRoom);
+        return compareParameter<HasUnread>(leftKeys, rightKeys);
     case MostUnread:
-        return compareParameter<MostUnread>(leftRoom, rightRoom);
+        return compareParameter<MostUnread>(leftKeys, rightKeys);
     case HasHighlight:
-        return compareParameter<HasHighlight>(leftRoom, rightRoom);
+        return compareParameter<HasHighlight>(leftKeys, rightKeys);
     case MostHighlights:
-        return compareParameter<MostHighlights>(leftRoom, rightRoom);
+        return compareParameter<MostHighlights>(leftKeys, rightKeys);
     case LastActive:
-        return compareParameter<LastActive>(leftRoom, rightRoom);
+        return compareParameter<LastActive>(leftKeys, rightKeys);
     default:
         return 0;
     }
 }
 
 template<>
-int RoomSortParameter::compareParameter<RoomSortParameter::AlphabeticalAscending>(NeoChatRoom *leftRoom, NeoChatRoom *rightRoom)
+int RoomSortParameter::compareParameter<RoomSortParameter::AlphabeticalAscending>(const SortKeys &leftKeys, const SortKeys &rightKeys)
 {
-    return -typeCompare(leftRoom->displayName(), rightRoom->displayName());
+    return -typeCompare(leftKeys.displayName, rightKeys.displayName);
 }
 
 template<>
-int RoomSortParameter::compareParameter<RoomSortParameter::AlphabeticalDescending>(NeoChatRoom *leftRoom, NeoChatRoom *rightRoom)
+int RoomSortParameter::compareParameter<RoomSortParameter::AlphabeticalDescending>(const SortKeys &leftKeys, const SortKeys &rightKeys)
 {
-    return typeCompare(leftRoom->displayName(), rightRoom->displayName());
+    return typeCompare(leftKeys.displayName, rightKeys.displayName);
 }
 
 template<>
-int RoomSortParameter::compareParameter<RoomSortParameter::HasUnread>(NeoChatRoom *leftRoom, NeoChatRoom *rightRoom)
+int RoomSortParameter::compareParameter<RoomSortParameter::HasUnread>(const SortKeys &leftKeys, const SortKeys &rightKeys)
 {
-    return typeCompare(leftRoom->contextAwareNotificationCount() > 0, rightRoom->contextAwareNotificationCount() > 0);
+    return typeCompare(leftKeys.notificationCount > 0, rightKeys.notificationCount > 0);
 }
 
 template<>
-int RoomSortParameter::compareParameter<RoomSortParameter::MostUnread>(NeoChatRoom *leftRoom, NeoChatRoom *rightRoom)
+int RoomSortParameter::compareParameter<RoomSortParameter::MostUnread>(const SortKeys &leftKeys, const SortKeys &rightKeys)
 {
-    return typeCompare(leftRoom->contextAwareNotificationCount(), rightRoom->contextAwareNotificationCount());
+    return typeCompare(leftKeys.notificationCount, rightKeys.notificationCount);
 }
 
 template<>
-int RoomSortParameter::compareParameter<RoomSortParameter::HasHighlight>(NeoChatRoom *leftRoom, NeoChatRoom *rightRoom)
+int RoomSortParameter::compareParameter<RoomSortParameter::HasHighlight>(const SortKeys &leftKeys, const SortKeys &rightKeys)
 {
-    const auto leftHighlight = leftRoom->highlightCount() > 0 && leftRoom->contextAwareNotificationCount() > 0;
-    const auto rightHighlight = rightRoom->highlightCount() > 0 && rightRoom->contextAwareNotificationCount() > 0;
+    const auto leftHighlight = leftKeys.highlightCount > 0 && leftKeys.notificationCount > 0;
+    const auto rightHighlight = rightKeys.highlightCount > 0 && rightKeys.notificationCount > 0;
     return typeCompare(leftHighlight, rightHighlight);
 }
 
 template<>
-int RoomSortParameter::compareParameter<RoomSortParameter::MostHighlights>(NeoChatRoom *leftRoom, NeoChatRoom *rightRoom)
+int RoomSortParameter::compareParameter<RoomSortParameter::MostHighlights>(const SortKeys &leftKeys, const SortKeys &rightKeys)
 {
-    return typeCompare(int(leftRoom->highlightCount()), int(rightRoom->highlightCount()));
+    return typeCompare(leftKeys.highlightCount, rightKeys.highlightCount);
 }
 
 template<>
-int RoomSortParameter::compareParameter<RoomSortParameter::LastActive>(NeoChatRoom *leftRoom, NeoChatRoom *rightRoom)
+int RoomSortParameter::compareParameter<RoomSortParameter::LastActive>(const SortKeys &leftKeys, const SortKeys &rightKeys)
 {
-    return typeCompare(leftRoom->lastActiveTime(), rightRoom->lastActiveTime());
+    return typeCompare(leftKeys.lastActiveTime, rightKeys.lastActiveTime);
 }
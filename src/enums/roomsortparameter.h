@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <QDateTime>
 #include <QObject>
 #include <QQmlEngine>
 
@@ -40,6 +41,25 @@ public:
     };
     Q_ENUM(Parameter)
 
+    /**
+     * @brief The values of a room that the sort parameters are compared on.
+     *
+     * Some of these are expensive to calculate (e.g. the last active time requires
+     * a scan of the timeline) so they are gathered once per room and only refreshed
+     * when the room reports that one of them has changed.
+     */
+    struct SortKeys {
+        QString displayName;
+        int notificationCount = 0;
+        int highlightCount = 0;
+        QDateTime lastActiveTime;
+
+        /**
+         * @brief Gather the current sort keys for the given room.
+         */
+        static SortKeys forRoom(NeoChatRoom *room);
+    };
+
     /**
      * @brief Translate the Parameter enum value to a human readable name string.
      *
@@ -110,33 +130,33 @@ public:
     static void saveNewParameterList(const QList<Parameter> &newList);
 
     /**
-     * @brief Compare the given parameter of the two given rooms.
+     * @brief Compare the given parameter of the two given sets of room sort keys.
      *
      * @return 0 if they are equal, 1 if the left is greater and -1 if the right is greater.
      *
-     * @sa Parameter
+     * @sa Parameter, SortKeys
      */
-    static int compareParameter(Parameter parameter, NeoChatRoom *leftRoom, NeoChatRoom *rightRoom);
+    static int compareParameter(Parameter parameter, const SortKeys &leftKeys, const SortKeys &rightKeys);
 
 private:
     template<Parameter parameter>
-    static int compareParameter(NeoChatRoom *, NeoChatRoom *)
+    static int compareParameter(const SortKeys &, const SortKeys &)
     {
         return false;
     }
 };
 
 template<>
-int RoomSortParameter::compareParameter<RoomSortParameter::AlphabeticalAscending>(NeoChatRoom *leftRoom, NeoChatRoom *rightRoom);
+int RoomSortParameter::compareParameter<RoomSortParameter::AlphabeticalAscending>(const SortKeys &leftKeys, const SortKeys &rightKeys);
 template<>
-int RoomSortParameter::compareParameter<RoomSortParameter::AlphabeticalDescending>(NeoChatRoom *leftRoom, NeoChatRoom *rightRoom);
+int RoomSortParameter::compareParameter<RoomSortParameter::AlphabeticalDescending>(const SortKeys &leftKeys, const SortKeys &rightKeys);
 template<>
-int RoomSortParameter::compareParameter<RoomSortParameter::HasUnread>(NeoChatRoom *leftRoom, NeoChatRoom *rightRoom);
+int RoomSortParameter::compareParameter<RoomSortParameter::HasUnread>(const SortKeys &leftKeys, const SortKeys &rightKeys);
 template<>
-int RoomSortParameter::compareParameter<RoomSortParameter::MostUnread>(NeoChatRoom *leftRoom, NeoChatRoom *rightRoom);
+int RoomSortParameter::compareParameter<RoomSortParameter::MostUnread>(const SortKeys &leftKeys, const SortKeys &rightKeys);
 template<>
-int RoomSortParameter::compareParameter<RoomSortParameter::HasHighlight>(NeoChatRoom *leftRoom, NeoChatRoom *rightRoom);
+int RoomSortParameter::compareParameter<RoomSortParameter::HasHighlight>(const SortKeys &leftKeys, const SortKeys &rightKeys);
 template<>
-int RoomSortParameter::compareParameter<RoomSortParameter::MostHighlights>(NeoChatRoom *leftRoom, NeoChatRoom *rightRoom);
+int RoomSortParameter::compareParameter<RoomSortParameter::MostHighlights>(const SortKeys &leftKeys, const SortKeys &rightKeys);
 template<>
-int RoomSortParameter::compareParameter<RoomSortParameter::LastActive>(NeoChatRoom *leftRoom, NeoChatRoom *rightRoom);
+int RoomSortParameter::compareParameter<RoomSortParameter::LastActive>(const SortKeys &leftKeys, const SortKeys &rightKeys);
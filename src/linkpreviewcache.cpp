@@ -0,0 +1,256 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "linkpreviewcache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPointer>
+#include <QSaveFile>
+
+#include <Quotient/connection.h>
+#include <Quotient/csapi/authed-content-repo.h>
+#include <Quotient/csapi/content-repo.h>
+
+#include "linkpreviewcache_logging.h"
+
+using namespace Quotient;
+using namespace Qt::StringLiterals;
+
+namespace
+{
+constexpr qsizetype DefaultMaxMemory = 1024 * 1024;
+constexpr std::chrono::seconds DefaultTimeToLive = std::chrono::days(7);
+
+int cost(const QUrl &url, const LinkPreviewCache::Preview &preview)
+{
+    const auto characters = url.toString().size() + preview.title.size() + preview.description.size() + preview.imageUrl.toString().size();
+    return int(sizeof(LinkPreviewCache::Preview) + characters * sizeof(QChar));
+}
+
+QJsonObject toJson(const QUrl &url, const LinkPreviewCache::Preview &preview)
+{
+    return {
+        {u"url"_s, url.toString()},
+        {u"title"_s, preview.title},
+        {u"description"_s, preview.description},
+        {u"image"_s, preview.imageUrl.toString()},
+        {u"fetched"_s, preview.fetched.toMSecsSinceEpoch()},
+    };
+}
+
+std::optional<LinkPreviewCache::Preview> readPreview(const QString &path, const QUrl &url)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return std::nullopt;
+    }
+    const auto json = QJsonDocument::fromJson(file.readAll()).object();
+    // Guard against hash collisions.
+    if (json["url"_L1].toString() != url.toString()) {
+        return std::nullopt;
+    }
+    return LinkPreviewCache::Preview{
+        .title = json["title"_L1].toString(),
+        .description = json["description"_L1].toString(),
+        .imageUrl = QUrl(json["image"_L1].toString()),
+        .fetched = QDateTime::fromMSecsSinceEpoch(json["fetched"_L1].toInteger()),
+    };
+}
+}
+
+LinkPreviewCache::LinkPreviewCache(const QString &directory, QObject *parent)
+    : QObject(parent)
+    , m_directory(directory)
+    , m_timeToLive(DefaultTimeToLive)
+{
+    m_previews.setMaxCost(DefaultMaxMemory);
+    m_diskPool.setMaxThreadCount(1);
+
+    // Previews that are never looked at again would otherwise stay forever.
+    m_diskPool.start([directory = m_directory, timeToLive = m_timeToLive]() {
+        QDir().mkpath(directory);
+        const auto cutoff = QDateTime::currentDateTime().addSecs(-timeToLive.count());
+        QDirIterator it(directory, {u"*.json"_s}, QDir::Files);
+        while (it.hasNext()) {
+            const auto info = it.nextFileInfo();
+            if (info.lastModified() < cutoff) {
+                QFile::remove(info.absoluteFilePath());
+            }
+        }
+    });
+}
+
+std::optional<LinkPreviewCache::Preview> LinkPreviewCache::preview(const QUrl &url, Connection *connection, bool persist)
+{
+    if (const auto preview = m_previews.object(url); preview && !isExpired(*preview)) {
+        ++m_memoryHits;
+        return *preview;
+    }
+
+    if (const auto it = m_loading.find(url); it != m_loading.end()) {
+        // Only write the shared result if every request allows it.
+        *it = *it && persist;
+        return std::nullopt;
+    }
+    m_loading.insert(url, persist);
+    loadFromDisk(url, connection);
+    return std::nullopt;
+}
+
+void LinkPreviewCache::insert(const QUrl &url, const Preview &preview, bool persist)
+{
+    insertInMemory(url, preview);
+    if (!persist) {
+        return;
+    }
+    m_diskPool.start([path = filePath(url), json = toJson(url, preview)]() {
+        QSaveFile file(path);
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(QJsonDocument(json).toJson(QJsonDocument::Compact));
+            file.commit();
+        }
+    });
+}
+
+void LinkPreviewCache::clear()
+{
+    m_previews.clear();
+    // Anything still loading belongs to the old state and is dropped when it finishes.
+    m_loading.clear();
+    ++m_generation;
+    m_diskPool.start([directory = m_directory]() {
+        QDir(directory).removeRecursively();
+    });
+}
+
+void LinkPreviewCache::waitForDisk()
+{
+    m_diskPool.waitForDone();
+}
+
+void LinkPreviewCache::setMaxMemory(qsizetype bytes)
+{
+    m_previews.setMaxCost(bytes);
+}
+
+void LinkPreviewCache::setTimeToLive(std::chrono::seconds timeToLive)
+{
+    m_timeToLive = timeToLive;
+}
+
+bool LinkPreviewCache::isExpired(const Preview &preview) const
+{
+    return preview.fetched.secsTo(QDateTime::currentDateTime()) >= m_timeToLive.count();
+}
+
+QString LinkPreviewCache::filePath(const QUrl &url) const
+{
+    const auto hash = QCryptographicHash::hash(url.toEncoded(), QCryptographicHash::Sha1).toHex();
+    return m_directory + u'/' + QString::fromLatin1(hash) + u".json"_s;
+}
+
+void LinkPreviewCache::insertInMemory(const QUrl &url, const Preview &preview)
+{
+    m_previews.insert(url, new Preview(preview), cost(url, preview));
+}
+
+void LinkPreviewCache::loadFromDisk(const QUrl &url, Connection *connection)
+{
+    m_diskPool.start([this, url, path = filePath(url), connection = QPointer(connection), generation = m_generation]() {
+        const auto preview = readPreview(path, url);
+        QMetaObject::invokeMethod(
+            this,
+            [this, url, preview, connection, generation]() {
+                if (generation != m_generation) {
+                    return;
+                }
+                if (preview && !isExpired(*preview)) {
+                    ++m_diskHits;
+                    logStats("Loaded from disk");
+                    insertInMemory(url, *preview);
+                    finishLoading(url, *preview);
+                    return;
+                }
+                ++m_misses;
+                logStats("Fetching from the server");
+                loadFromServer(url, connection);
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+void LinkPreviewCache::loadFromServer(const QUrl &url, Connection *connection)
+{
+    if (connection == nullptr) {
+        m_loading.remove(url);
+        return;
+    }
+
+    BaseJob *job = nullptr;
+    if (connection->supportedMatrixSpecVersions().contains("v1.11"_L1)) {
+        job = connection->callApi<GetUrlPreviewAuthedJob>(url);
+    } else {
+        QT_IGNORE_DEPRECATIONS(job = connection->callApi<GetUrlPreviewJob>(url);)
+    }
+
+    connect(job, &BaseJob::success, this, [this, job, url, generation = m_generation]() {
+        if (generation != m_generation) {
+            return;
+        }
+        const auto json = job->jsonData();
+        const auto imageUrl = QUrl(json["og:image"_L1].toString());
+        const Preview preview{
+            .title = json["og:title"_L1].toString().trimmed(),
+            .description = json["og:description"_L1].toString().trimmed().replace("\n"_L1, " "_L1),
+            .imageUrl = imageUrl.isValid() && imageUrl.scheme() == u"mxc"_s ? imageUrl : QUrl(),
+            .fetched = QDateTime::currentDateTime(),
+        };
+        insert(url, preview, m_loading.value(url, false));
+        finishLoading(url, preview);
+    });
+    connect(job, &BaseJob::failure, this, [this, url, generation = m_generation]() {
+        if (generation == m_generation) {
+            m_loading.remove(url);
+        }
+    });
+}
+
+void LinkPreviewCache::finishLoading(const QUrl &url, const Preview &preview)
+{
+    m_loading.remove(url);
+    Q_EMIT previewLoaded(url, preview);
+}
+
+quint64 LinkPreviewCache::memoryHits() const
+{
+    return m_memoryHits;
+}
+
+quint64 LinkPreviewCache::diskHits() const
+{
+    return m_diskHits;
+}
+
+quint64 LinkPreviewCache::misses() const
+{
+    return m_misses;
+}
+
+qreal LinkPreviewCache::hitRate() const
+{
+    const auto total = m_memoryHits + m_diskHits + m_misses;
+    return total > 0 ? qreal(m_memoryHits + m_diskHits) / qreal(total) : 0.0;
+}
+
+void LinkPreviewCache::logStats(const char *event) const
+{
+    qCDebug(LinkPreviews) << event << "- memory hits:" << m_memoryHits << "disk hits:" << m_diskHits << "misses:" << m_misses << "hit rate:" << hitRate();
+}
+
+#include "moc_linkpreviewcache.cpp"
@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QCache>
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QUrl>
+
+#include <chrono>
+#include <optional>
+
+namespace Quotient
+{
+class Connection;
+}
+
+/**
+ * @class LinkPreviewCache
+ *
+ * The URL previews fetched from the homeserver for a connection.
+ *
+ * Previews are kept in memory in a least recently used cache limited by size and
+ * on disk with one file per URL, so they survive restarts. A preview older than
+ * the time to live is fetched again. Previews of links in encrypted rooms are
+ * only kept in memory so that nothing from those rooms is written in plaintext.
+ *
+ * Any number of requests for the same URL share a single load from disk or the
+ * server, previewLoaded() is emitted once it is done.
+ *
+ * @sa LinkPreviewer, NeoChatConnection::linkPreviewCache()
+ */
+class LinkPreviewCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Preview {
+        QString title;
+        QString description;
+        /**
+         * @brief The mxc URL of the preview image, if any.
+         */
+        QUrl imageUrl;
+        QDateTime fetched;
+    };
+
+    /**
+     * @param directory where the previews are stored on disk.
+     */
+    explicit LinkPreviewCache(const QString &directory, QObject *parent = nullptr);
+
+    /**
+     * @brief The preview of the given URL if it is in memory.
+     *
+     * Otherwise the preview is loaded from disk, or from the server using the given
+     * connection, and previewLoaded() is emitted.
+     *
+     * @param persist whether a preview fetched from the server may be written to
+     *        disk, i.e. false for a link from an encrypted room.
+     */
+    std::optional<Preview> preview(const QUrl &url, Quotient::Connection *connection, bool persist = true);
+
+    /**
+     * @brief Add a preview to the cache, replacing any existing one.
+     *
+     * @param persist whether the preview is also written to disk.
+     */
+    void insert(const QUrl &url, const Preview &preview, bool persist = true);
+
+    /**
+     * @brief Remove every preview from memory and disk, e.g. when the account logs out.
+     */
+    void clear();
+
+    /**
+     * @brief Block until every disk read and write queued so far is done.
+     */
+    void waitForDisk();
+
+    /**
+     * @brief Set the maximum size of the previews kept in memory in bytes.
+     */
+    void setMaxMemory(qsizetype bytes);
+
+    void setTimeToLive(std::chrono::seconds timeToLive);
+
+    /**
+     * @brief The number of requests answered from memory.
+     */
+    [[nodiscard]] quint64 memoryHits() const;
+
+    /**
+     * @brief The number of loads that found a preview on disk.
+     */
+    [[nodiscard]] quint64 diskHits() const;
+
+    /**
+     * @brief The number of loads that had to fetch the preview from the server.
+     */
+    [[nodiscard]] quint64 misses() const;
+
+    /**
+     * @brief The fraction of requests that were answered without the server.
+     *
+     * Returns 0 if there have been no requests.
+     */
+    [[nodiscard]] qreal hitRate() const;
+
+Q_SIGNALS:
+    void previewLoaded(const QUrl &url, const LinkPreviewCache::Preview &preview);
+
+private:
+    QString m_directory;
+    QCache<QUrl, Preview> m_previews;
+    // Whether the loading preview may be written to disk.
+    QHash<QUrl, bool> m_loading;
+    std::chrono::seconds m_timeToLive;
+    // One thread so that disk access happens in order, e.g. clear() after any pending writes.
+    QThreadPool m_diskPool;
+
+    // Bumped by clear() so that loads started before it are dropped.
+    quint64 m_generation = 0;
+
+    quint64 m_memoryHits = 0;
+    quint64 m_diskHits = 0;
+    quint64 m_misses = 0;
+
+    [[nodiscard]] bool isExpired(const Preview &preview) const;
+    [[nodiscard]] QString filePath(const QUrl &url) const;
+    void insertInMemory(const QUrl &url, const Preview &preview);
+    void loadFromDisk(const QUrl &url, Quotient::Connection *connection);
+    void loadFromServer(const QUrl &url, Quotient::Connection *connection);
+    void finishLoading(const QUrl &url, const Preview &preview);
+    void logStats(const char *event) const;
+};
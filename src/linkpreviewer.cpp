@@ -4,29 +4,42 @@
 #include "linkpreviewer.h"
 
 #include <Quotient/connection.h>
-#include <Quotient/csapi/authed-content-repo.h>
-#include <Quotient/csapi/content-repo.h>
 
 #include <Quotient/events/roommessageevent.h>
 
 #include "neochatconfig.h"
+#include "neochatconnection.h"
 #include "utils.h"
 
 using namespace Quotient;
 
-LinkPreviewer::LinkPreviewer(const QUrl &url, QObject *parent)
+LinkPreviewer::LinkPreviewer(const QUrl &url, bool encrypted, QObject *parent)
     : QObject(parent)
     , m_loaded(false)
     , m_url(url)
+    , m_encrypted(encrypted)
 {
     Q_ASSERT(dynamic_cast<Connection *>(this->parent()));
 
     connect(this, &LinkPreviewer::urlChanged, this, &LinkPreviewer::emptyChanged);
     connect(NeoChatConfig::self(), &NeoChatConfig::ShowLinkPreviewChanged, this, &LinkPreviewer::loadUrlPreview);
+    if (const auto linkPreviewCache = cache()) {
+        connect(linkPreviewCache, &LinkPreviewCache::previewLoaded, this, [this](const QUrl &url, const LinkPreviewCache::Preview &preview) {
+            if (url == m_url) {
+                setPreview(preview);
+            }
+        });
+    }
 
     loadUrlPreview();
 }
 
+LinkPreviewCache *LinkPreviewer::cache() const
+{
+    const auto connection = dynamic_cast<NeoChatConnection *>(parent());
+    return connection ? connection->linkPreviewCache() : nullptr;
+}
+
 bool LinkPreviewer::loaded() const
 {
     return m_loaded;
@@ -59,60 +72,38 @@ void LinkPreviewer::loadUrlPreview()
         Q_EMIT loadedChanged();
 
         auto conn = dynamic_cast<Connection *>(this->parent());
-        if (conn == nullptr) {
+        const auto linkPreviewCache = cache();
+        if (conn == nullptr || linkPreviewCache == nullptr) {
             return;
         }
 
-        BaseJob *job = nullptr;
-        if (conn->supportedMatrixSpecVersions().contains("v1.11"_L1)) {
-            job = conn->callApi<GetUrlPreviewAuthedJob>(m_url);
-        } else {
-            QT_IGNORE_DEPRECATIONS(job = conn->callApi<GetUrlPreviewJob>(m_url);)
+        if (const auto preview = linkPreviewCache->preview(m_url, conn, !m_encrypted)) {
+            setPreview(*preview);
         }
-
-        connect(job, &BaseJob::success, this, [this, job, conn]() {
-            const auto json = job->jsonData();
-            m_title = json["og:title"_L1].toString().trimmed();
-            m_description = json["og:description"_L1].toString().trimmed().replace("\n"_L1, " "_L1);
-
-            auto imageUrl = QUrl(json["og:image"_L1].toString());
-            if (imageUrl.isValid() && imageUrl.scheme() == u"mxc"_s) {
-                m_imageSource = conn->makeMediaUrl(imageUrl);
-            } else {
-                m_imageSource = QUrl();
-            }
-
-            m_loaded = true;
-            Q_EMIT titleChanged();
-            Q_EMIT descriptionChanged();
-            Q_EMIT imageSourceChanged();
-            Q_EMIT loadedChanged();
-        });
     }
 }
 
-bool LinkPreviewer::empty() const
-{
-    return m_url.isEmpty();
-}
-
-QList<QUrl> LinkPreviewer::linkPreviews(QString string)
+void LinkPreviewer::setPreview(const LinkPreviewCache::Preview &preview)
 {
-    auto data = string.remove(TextRegex::removeRichReply);
-    auto linksMatch = TextRegex::url.globalMatch(data);
-    QList<QUrl> links;
-    while (linksMatch.hasNext()) {
-        auto link = linksMatch.next().captured();
-        if (!link.contains(u"matrix.to"_s) && !links.contains(QUrl(link))) {
-            links += QUrl(link);
-        }
+    auto conn = dynamic_cast<Connection *>(this->parent());
+    if (conn == nullptr) {
+        return;
     }
-    return links;
+
+    m_title = preview.title;
+    m_description = preview.description;
+    m_imageSource = preview.imageUrl.isEmpty() ? QUrl() : conn->makeMediaUrl(preview.imageUrl);
+
+    m_loaded = true;
+    Q_EMIT titleChanged();
+    Q_EMIT descriptionChanged();
+    Q_EMIT imageSourceChanged();
+    Q_EMIT loadedChanged();
 }
 
-bool LinkPreviewer::hasPreviewableLinks(const QString &string)
+bool LinkPreviewer::empty() const
 {
-    return !linkPreviews(string).isEmpty();
+    return m_url.isEmpty();
 }
 
 #include "moc_linkpreviewer.cpp"
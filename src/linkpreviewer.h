@@ -7,6 +7,8 @@
 #include <QQmlEngine>
 #include <QUrl>
 
+#include "linkpreviewcache.h"
+
 class NeoChatRoom;
 
 /**
@@ -56,7 +58,13 @@ class LinkPreviewer : public QObject
 
 public:
     LinkPreviewer() = default;
-    explicit LinkPreviewer(const QUrl &url, QObject *parent = nullptr);
+    /**
+     * @param url the link to preview.
+     * @param encrypted whether the link is from an encrypted room, in which case
+     *        the preview is only cached in memory.
+     * @param parent the NeoChatConnection to fetch the preview with.
+     */
+    explicit LinkPreviewer(const QUrl &url, bool encrypted, QObject *parent = nullptr);
 
     [[nodiscard]] QUrl url() const;
     [[nodiscard]] bool loaded() const;
@@ -65,29 +73,17 @@ public:
     [[nodiscard]] QUrl imageSource() const;
     [[nodiscard]] bool empty() const;
 
-    /**
-     * @brief Whether the given string has at least 1 pre-viewable link.
-     *
-     * A link is only pre-viewable if it is http, https or something starting with www.
-     */
-    static bool hasPreviewableLinks(const QString &string);
-
-    /**
-     * @brief Return previewable links from the given string.
-     *
-     * This function is designed to give only links that should be previewed so
-     * http, https or something starting with www. The first valid link is returned.
-     */
-    static QList<QUrl> linkPreviews(QString string);
-
 private:
     bool m_loaded;
     QString m_title = QString();
     QString m_description = QString();
     QUrl m_imageSource = QUrl();
     QUrl m_url;
+    bool m_encrypted = false;
 
+    LinkPreviewCache *cache() const;
     void loadUrlPreview();
+    void setPreview(const LinkPreviewCache::Preview &preview);
 
 Q_SIGNALS:
     void loadedChanged();
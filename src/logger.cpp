@@ -5,14 +5,19 @@
 // SPDX-License-Identifier: LGPL-2.0-or-later
 
 #include "logger.h"
+#include "logwriter.h"
 
 #include <QDateTime>
-#include <QDir>
-#include <QFileInfo>
+#include <QFile>
 #include <QLoggingCategory>
-#include <QMutex>
 #include <QStandardPaths>
 
+#include <utility>
+
+#if __has_include("KCrash")
+#include <KCrash>
+#endif
+
 using namespace Qt::StringLiterals;
 
 static QLoggingCategory::CategoryFilter oldCategoryFilter = nullptr;
@@ -81,12 +86,11 @@ public:
     ~DebugPrivate()
     {
         qInstallMessageHandler(origHandler);
-        file.close();
+        writer.stop();
     }
 
     void log(QtMsgType type, const QMessageLogContext &context, const QString &message)
     {
-        QMutexLocker locker(&mutex);
         QByteArray buf;
         QTextStream str(&buf);
         str << QDateTime::currentDateTime().toString(Qt::ISODate) << u" ["_s;
@@ -116,8 +120,7 @@ public:
         }
         str << message << u"\n"_s;
         str.flush();
-        file.write(buf.constData(), buf.size());
-        file.flush();
+        writer.write(std::move(buf));
 
         if (oldHandler && (!context.category || (strcmp(context.category, "quotient.e2ee") != 0 || e2eeDebugEnabled))) {
             oldHandler(type, context, message);
@@ -127,51 +130,10 @@ public:
     void setName(const QString &appName)
     {
         name = appName;
-
-        if (file.isOpen()) {
-            file.close();
-        }
-        const auto &filePath = u"%1%2%3"_s.arg(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation), QDir::separator(), appName);
-
-        QDir dir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QDir::separator());
-        auto entryList = dir.entryList({appName + u".*"_s});
-        std::sort(entryList.begin(), entryList.end(), [](const auto &left, const auto &right) {
-            auto leftIndex = left.split(u"."_s).last().toInt();
-            auto rightIndex = right.split(u"."_s).last().toInt();
-            return leftIndex > rightIndex;
-        });
-        for (const auto &entry : entryList) {
-            bool ok = false;
-            const auto index = entry.split(u"."_s).last().toInt(&ok);
-            if (!ok) {
-                continue;
-            }
-            QFileInfo info(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QDir::separator() + entry);
-            if (info.exists()) {
-                QFile file(info.absoluteFilePath());
-                if (index > 50) {
-                    file.remove();
-                    continue;
-                }
-                const auto &newName = u"%1.%2"_s.arg(filePath, QString::number(index + 1));
-                const auto success = file.copy(newName);
-                if (success) {
-                    file.remove();
-                } else {
-                    qFatal("Cannot rename log file '%s' to '%s': %s",
-                           qUtf8Printable(file.fileName()),
-                           qUtf8Printable(newName),
-                           qUtf8Printable(file.errorString()));
-                }
-            }
+        QString error;
+        if (!writer.start(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation), appName, &error)) {
+            qFatal("%s", qUtf8Printable(error));
         }
-
-        QFileInfo finfo(filePath);
-        if (!finfo.absoluteDir().exists()) {
-            QDir().mkpath(finfo.absolutePath());
-        }
-        file.setFileName(filePath + u".0"_s);
-        file.open(QIODevice::WriteOnly | QIODevice::Unbuffered);
     }
 
     void setOrigHandler(QtMessageHandler origHandler_)
@@ -179,8 +141,7 @@ public:
         origHandler = origHandler_;
     }
 
-    QMutex mutex;
-    QFile file;
+    LogWriter writer;
     QString name;
     QtMessageHandler origHandler;
     QByteArray loggingCategory;
@@ -199,6 +160,8 @@ void messageHandler(QtMsgType type, const QMessageLogContext &context, const QSt
         break;
     case QtFatalMsg:
         sInstance()->log(QtInfoMsg, context, message);
+        // The application is about to abort.
+        sInstance()->writer.flush();
     }
 }
 
@@ -218,6 +181,14 @@ void initLogging()
     oldHandler = qInstallMessageHandler(messageHandler);
     sInstance->setOrigHandler(oldHandler);
     sInstance->setName(u"neochat.log"_s);
+
+#if __has_include("KCrash")
+    KCrash::setEmergencySaveFunction([](int) {
+        if (!sInstance.isDestroyed()) {
+            sInstance->writer.emergencyFlush();
+        }
+    });
+#endif
 }
 
 #include "logger.moc"
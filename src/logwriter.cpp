@@ -0,0 +1,280 @@
+// SPDX-FileCopyrightText: 2023 Tobias Fella <fella@posteo.de>
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: LGPL-2.0-or-later
+
+#include "logwriter.h"
+
+#include <QDir>
+#include <QSemaphore>
+#include <QThread>
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Qt::StringLiterals;
+
+namespace
+{
+void rawWrite(int fd, const QByteArray &data)
+{
+    auto remaining = data.size();
+    auto position = data.constData();
+    while (remaining > 0) {
+#ifdef Q_OS_WIN
+        const auto written = _write(fd, position, static_cast<unsigned int>(remaining));
+#else
+        const auto written = ::write(fd, position, remaining);
+#endif
+        if (written <= 0) {
+            return;
+        }
+        remaining -= written;
+        position += written;
+    }
+}
+}
+
+LogWriter::LogWriter(qint64 maxFileSize, int maxFiles, qint64 maxQueueSize)
+    : m_maxFileSize(maxFileSize)
+    , m_maxFiles(std::max(maxFiles, 1))
+    , m_maxQueueSize(maxQueueSize)
+{
+}
+
+LogWriter::~LogWriter()
+{
+    stop();
+}
+
+bool LogWriter::start(const QString &directory, const QString &appName, QString *error)
+{
+    stop();
+
+    m_directory = directory;
+    m_appName = appName;
+    m_rotationFailed = false;
+    QDir().mkpath(directory);
+    if (!rotate(error)) {
+        return false;
+    }
+    openFile();
+
+    m_thread.reset(QThread::create([this]() {
+        run();
+    }));
+    m_thread->setObjectName(u"LogWriter"_s);
+    m_thread->start(QThread::LowPriority);
+    m_running = true;
+    return true;
+}
+
+void LogWriter::stop()
+{
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    push(new Entry{.kind = Entry::Stop});
+    m_thread->wait();
+    m_thread.reset();
+    // Anything written after the stop was queued.
+    deleteAll(takeAll());
+    m_queuedSize = 0;
+    closeFile();
+}
+
+void LogWriter::write(QByteArray &&data)
+{
+    if (!m_running) {
+        return;
+    }
+    const auto size = data.size();
+    if (m_queuedSize.fetch_add(size, std::memory_order_relaxed) + size > m_maxQueueSize) {
+        m_queuedSize.fetch_sub(size, std::memory_order_relaxed);
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    push(new Entry{.data = std::move(data)});
+}
+
+void LogWriter::flush()
+{
+    if (!m_running || QThread::currentThread() == m_thread.get()) {
+        return;
+    }
+    auto done = std::make_shared<QSemaphore>();
+    push(new Entry{.kind = Entry::Flush, .done = done});
+    // Don't hang forever if the writer is stuck, e.g. on a full disk.
+    done->tryAcquire(1, 5000);
+}
+
+void LogWriter::emergencyFlush()
+{
+    const auto fd = m_fd.load();
+    if (fd < 0) {
+        return;
+    }
+    // The entries are leaked, freeing them isn't safe in a crash handler.
+    for (auto entry = takeAll(); entry; entry = entry->next) {
+        if (entry->kind == Entry::Message) {
+            rawWrite(fd, entry->data);
+        }
+    }
+}
+
+QString LogWriter::fileName() const
+{
+    return u"%1%2%3.0"_s.arg(m_directory, QDir::separator(), m_appName);
+}
+
+void LogWriter::push(Entry *entry)
+{
+    auto head = m_head.load(std::memory_order_relaxed);
+    do {
+        entry->next = head;
+    } while (!m_head.compare_exchange_weak(head, entry, std::memory_order_release, std::memory_order_relaxed));
+    // The writer only sleeps once the queue is empty, so only the first entry
+    // after that needs to wake it.
+    if (!head) {
+        m_head.notify_one();
+    }
+}
+
+LogWriter::Entry *LogWriter::takeAll()
+{
+    // Take every queued entry and reverse them so that the oldest is first.
+    auto entries = m_head.exchange(nullptr, std::memory_order_acquire);
+    Entry *ordered = nullptr;
+    while (entries) {
+        const auto next = entries->next;
+        entries->next = ordered;
+        ordered = entries;
+        entries = next;
+    }
+    return ordered;
+}
+
+void LogWriter::deleteAll(Entry *entry)
+{
+    while (entry) {
+        // Don't leave a flush() waiting for the timeout.
+        if (entry->done) {
+            entry->done->release();
+        }
+        delete std::exchange(entry, entry->next);
+    }
+}
+
+bool LogWriter::rotate(QString *error)
+{
+    const auto filePath = u"%1%2%3"_s.arg(m_directory, QDir::separator(), m_appName);
+
+    QList<int> indices;
+    const auto entryList = QDir(m_directory).entryList({m_appName + u".*"_s}, QDir::Files);
+    for (const auto &entry : entryList) {
+        bool ok = false;
+        const auto index = entry.sliced(m_appName.size() + 1).toInt(&ok);
+        if (ok && index >= 0) {
+            indices += index;
+        }
+    }
+    // Highest first so that nothing is moved onto a file that is still to be moved.
+    std::sort(indices.begin(), indices.end(), std::greater<>());
+
+    for (const auto index : std::as_const(indices)) {
+        const auto oldName = u"%1.%2"_s.arg(filePath, QString::number(index));
+        if (index + 1 >= m_maxFiles) {
+            QFile::remove(oldName);
+            continue;
+        }
+        const auto newName = u"%1.%2"_s.arg(filePath, QString::number(index + 1));
+        QFile file(oldName);
+        if (!file.rename(newName)) {
+            if (error) {
+                *error = u"Cannot rename log file '%1' to '%2': %3"_s.arg(oldName, newName, file.errorString());
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+void LogWriter::openFile()
+{
+    m_file.setFileName(fileName());
+    m_file.open(QIODevice::WriteOnly);
+    m_fileSize = 0;
+    m_fd = m_file.isOpen() ? m_file.handle() : -1;
+}
+
+void LogWriter::closeFile()
+{
+    m_fd = -1;
+    m_file.close();
+}
+
+void LogWriter::run()
+{
+    bool stopping = false;
+    while (!stopping) {
+        m_head.wait(nullptr, std::memory_order_acquire);
+        auto entry = takeAll();
+        writeDropped();
+        qint64 written = 0;
+        while (entry) {
+            switch (entry->kind) {
+            case Entry::Message:
+                m_file.write(entry->data);
+                written += entry->data.size();
+                break;
+            case Entry::Flush:
+                m_file.flush();
+                entry->done->release();
+                break;
+            case Entry::Stop:
+                stopping = true;
+                break;
+            }
+            delete std::exchange(entry, entry->next);
+        }
+        m_queuedSize.fetch_sub(written, std::memory_order_relaxed);
+        m_fileSize += written;
+        m_file.flush();
+        rotateIfNeeded();
+    }
+}
+
+void LogWriter::writeDropped()
+{
+    const auto dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+    if (dropped == 0) {
+        return;
+    }
+    const auto note = u"[%1 log messages were dropped because the log file could not keep up]\n"_s.arg(dropped).toUtf8();
+    m_file.write(note);
+    m_fileSize += note.size();
+}
+
+void LogWriter::rotateIfNeeded()
+{
+    if (m_fileSize < m_maxFileSize || m_rotationFailed) {
+        return;
+    }
+    closeFile();
+    QString error;
+    if (!rotate(&error)) {
+        // Keep appending to the current file rather than retrying every batch.
+        m_rotationFailed = true;
+        m_file.open(QIODevice::WriteOnly | QIODevice::Append);
+        m_fd = m_file.isOpen() ? m_file.handle() : -1;
+        m_file.write(error.toUtf8() + '\n');
+        return;
+    }
+    openFile();
+}
@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText: 2023 Tobias Fella <fella@posteo.de>
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: LGPL-2.0-or-later
+
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+#include <atomic>
+#include <memory>
+
+class QSemaphore;
+class QThread;
+
+/**
+ * @class LogWriter
+ *
+ * Writes log messages to a log file on a dedicated thread.
+ *
+ * Messages are pushed onto a lock-free stack by the logging threads, the writer
+ * takes everything queued at once and writes it as a single batch, so a thread
+ * logging a message never waits for the file.
+ *
+ * The current log is `<appName>.0` in the given directory. Older logs are moved
+ * up by one, i.e. `<appName>.0` becomes `<appName>.1`, when the writer is started
+ * and whenever the current log reaches the maximum file size.
+ */
+class LogWriter
+{
+public:
+    /**
+     * @brief Start a new log file once the current one reaches this size.
+     */
+    static constexpr qint64 MaxFileSize = 20 * 1024 * 1024;
+
+    /**
+     * @brief The number of log files to keep, including the current one.
+     */
+    static constexpr int MaxFiles = 10;
+
+    /**
+     * @brief The number of bytes that can be waiting to be written.
+     *
+     * Messages logged while the writer is this far behind are dropped and a
+     * note saying how many were dropped is written instead.
+     */
+    static constexpr qint64 MaxQueueSize = 4 * 1024 * 1024;
+
+    explicit LogWriter(qint64 maxFileSize = MaxFileSize, int maxFiles = MaxFiles, qint64 maxQueueSize = MaxQueueSize);
+    ~LogWriter();
+
+    /**
+     * @brief Rotate the existing logs and start writing to a new log file.
+     *
+     * @return false and set error if the existing logs couldn't be rotated.
+     */
+    bool start(const QString &directory, const QString &appName, QString *error = nullptr);
+
+    /**
+     * @brief Write everything that has been queued and stop the writer thread.
+     */
+    void stop();
+
+    /**
+     * @brief Queue the given formatted message.
+     */
+    void write(QByteArray &&data);
+
+    /**
+     * @brief Block until everything queued so far has been written to the file.
+     */
+    void flush();
+
+    /**
+     * @brief Write whatever is still queued without the writer thread.
+     *
+     * This is called from the crash handler so it doesn't allocate or lock, the
+     * already formatted messages are written straight to the file descriptor.
+     * It is best effort, anything in the batch the writer is currently writing
+     * may still be lost.
+     */
+    void emergencyFlush();
+
+    /**
+     * @brief The path of the current log file.
+     */
+    [[nodiscard]] QString fileName() const;
+
+private:
+    struct Entry {
+        enum Kind {
+            Message,
+            Flush,
+            Stop,
+        };
+
+        QByteArray data;
+        Kind kind = Message;
+        // Shared so that a flush() that timed out doesn't leave the writer
+        // with a dangling semaphore.
+        std::shared_ptr<QSemaphore> done;
+        Entry *next = nullptr;
+    };
+
+    const qint64 m_maxFileSize;
+    const int m_maxFiles;
+    const qint64 m_maxQueueSize;
+
+    std::atomic<Entry *> m_head = nullptr;
+    std::atomic<bool> m_running = false;
+    std::atomic<qint64> m_queuedSize = 0;
+    std::atomic<qint64> m_dropped = 0;
+    // The descriptor of the current log file for emergencyFlush(), or -1.
+    std::atomic<int> m_fd = -1;
+    std::unique_ptr<QThread> m_thread;
+
+    // Only used by the writer thread once it has started.
+    QString m_directory;
+    QString m_appName;
+    QFile m_file;
+    qint64 m_fileSize = 0;
+    bool m_rotationFailed = false;
+
+    void push(Entry *entry);
+    Entry *takeAll();
+    void deleteAll(Entry *entry);
+    bool rotate(QString *error);
+    void openFile();
+    void closeFile();
+    void run();
+    void writeDropped();
+    void rotateIfNeeded();
+};
@@ -3,12 +3,18 @@
 
 #pragma once
 
+#include <QList>
+#include <QUrl>
+
 #include "enums/messagecomponenttype.h"
 
 struct MessageComponent {
     MessageComponentType::Type type = MessageComponentType::Other;
     QString content;
     QVariantMap attributes;
+    // The links in the content that can be previewed, found while the text was
+    // processed so that they don't have to be searched for again.
+    QList<QUrl> links;
 
     int operator==(const MessageComponent &right) const
     {
@@ -0,0 +1,107 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "modelcache.h"
+
+#include <QCoreApplication>
+#include <QSet>
+
+#include "modelcache_logging.h"
+
+namespace
+{
+qsizetype globalCapacity = 0;
+quint64 globalEvictions = 0;
+QSet<const void *> protectedModels;
+bool releaseScheduled = false;
+}
+
+ModelCacheBase::~ModelCacheBase() = default;
+
+std::list<ModelCacheBase::GlobalEntry> &ModelCacheBase::globalOrder()
+{
+    static std::list<GlobalEntry> order;
+    return order;
+}
+
+qsizetype ModelCacheBase::globalCapacity()
+{
+    return ::globalCapacity;
+}
+
+void ModelCacheBase::setGlobalCapacity(qsizetype capacity)
+{
+    ::globalCapacity = capacity;
+    enforceGlobalCapacity();
+}
+
+qsizetype ModelCacheBase::globalSize()
+{
+    return qsizetype(globalOrder().size());
+}
+
+quint64 ModelCacheBase::globalEvictions()
+{
+    return ::globalEvictions;
+}
+
+quint64 ModelCacheBase::evictions() const
+{
+    return m_evictions;
+}
+
+ModelCacheBase::GlobalPosition ModelCacheBase::modelAdded(const QString &key)
+{
+    globalOrder().push_front({.cache = this, .key = key});
+    return globalOrder().begin();
+}
+
+void ModelCacheBase::modelRemoved(GlobalPosition position, bool evicted)
+{
+    globalOrder().erase(position);
+    if (evicted) {
+        ++m_evictions;
+        ++::globalEvictions;
+        qCDebug(ModelCache) << "Evicted model, cache evictions:" << m_evictions << "global evictions:" << ::globalEvictions << "global size:" << globalSize();
+    }
+}
+
+void ModelCacheBase::modelUsed(GlobalPosition position)
+{
+    globalOrder().splice(globalOrder().begin(), globalOrder(), position);
+}
+
+void ModelCacheBase::protect(const void *model)
+{
+    const auto app = QCoreApplication::instance();
+    if (!app) {
+        protectedModels = {model};
+        return;
+    }
+    protectedModels.insert(model);
+    if (!releaseScheduled) {
+        releaseScheduled = true;
+        QMetaObject::invokeMethod(
+            app,
+            []() {
+                protectedModels.clear();
+                releaseScheduled = false;
+            },
+            Qt::QueuedConnection);
+    }
+}
+
+bool ModelCacheBase::isProtected(const void *model)
+{
+    return protectedModels.contains(model);
+}
+
+void ModelCacheBase::enforceGlobalCapacity()
+{
+    // Each failed attempt moves the model to the front, so once every model has
+    // been tried the rest are in use.
+    for (auto attempts = globalSize(); ::globalCapacity > 0 && globalSize() > ::globalCapacity && attempts > 0; --attempts) {
+        const auto oldest = globalOrder().back();
+        oldest.cache->tryEvict(oldest.key);
+    }
+}
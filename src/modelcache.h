@@ -0,0 +1,293 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QList>
+#include <QString>
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+/**
+ * @class ModelCacheBase
+ *
+ * The non-template part of ModelCache.
+ *
+ * Every model in any cache is also kept in a global least recently used list so
+ * that the total number of cached models across all caches can be kept below a
+ * global capacity. When the global capacity is exceeded the least recently used
+ * unused model of any cache is evicted.
+ *
+ * @sa ModelCache
+ */
+class ModelCacheBase
+{
+public:
+    virtual ~ModelCacheBase();
+
+    /**
+     * @brief The maximum number of models to keep across all caches, 0 for no limit.
+     */
+    static qsizetype globalCapacity();
+    static void setGlobalCapacity(qsizetype capacity);
+
+    /**
+     * @brief The number of models currently held by all caches.
+     */
+    static qsizetype globalSize();
+
+    /**
+     * @brief The number of models evicted across all caches since startup.
+     */
+    static quint64 globalEvictions();
+
+    /**
+     * @brief The number of models evicted from this cache.
+     */
+    [[nodiscard]] quint64 evictions() const;
+
+protected:
+    ModelCacheBase() = default;
+
+    struct GlobalEntry {
+        ModelCacheBase *cache;
+        QString key;
+    };
+    using GlobalPosition = std::list<GlobalEntry>::iterator;
+
+    /**
+     * @brief Try to evict the model for the given key.
+     *
+     * A model that can't be evicted, because it is in use or protected, is marked
+     * as recently used instead so that it isn't looked at again straight away.
+     *
+     * @return whether the model was evicted.
+     */
+    virtual bool tryEvict(const QString &key) = 0;
+
+    /**
+     * @brief Add the model for the given key as the most recently used globally.
+     */
+    GlobalPosition modelAdded(const QString &key);
+
+    /**
+     * @brief Remove the model at the given position from the global list.
+     */
+    void modelRemoved(GlobalPosition position, bool evicted);
+
+    /**
+     * @brief Mark the model at the given position as the most recently used globally.
+     */
+    static void modelUsed(GlobalPosition position);
+
+    /**
+     * @brief Protect the given model from eviction until the next event loop turn.
+     *
+     * The model is about to be returned to the caller, which may not have started
+     * using it yet, e.g. QML only connects to a model once the binding that asked
+     * for it has been evaluated. Every model returned during the current turn is
+     * protected. Without an application only the last model passed is protected.
+     */
+    static void protect(const void *model);
+    [[nodiscard]] static bool isProtected(const void *model);
+
+    /**
+     * @brief Evict models across all caches until the global capacity is respected.
+     */
+    static void enforceGlobalCapacity();
+
+private:
+    quint64 m_evictions = 0;
+
+    // Most recently used first.
+    static std::list<GlobalEntry> &globalOrder();
+};
+
+/**
+ * @class ModelCache
+ *
+ * A bounded, least recently used cache of models keyed by a string ID.
+ *
+ * Unlike QCache a model will never be evicted while it is still in use, which is
+ * determined by calling Model::isInUse(). Evicted models are deleted with
+ * QObject::deleteLater() so that any QML object that has just let go of one can
+ * finish with it safely.
+ *
+ * The models are kept in least recently used order so eviction starts from the
+ * back of the list rather than searching for the oldest model. A model that is
+ * in use when it reaches the back is moved to the front.
+ *
+ * The cache respects both its own capacity and the global capacity shared by all
+ * caches.
+ *
+ * @sa ModelCacheBase
+ */
+template<typename Model>
+class ModelCache : public ModelCacheBase
+{
+public:
+    explicit ModelCache(qsizetype capacity = 0)
+        : m_capacity(capacity)
+    {
+    }
+
+    ~ModelCache() override
+    {
+        clear();
+    }
+
+    /**
+     * @brief The maximum number of models in this cache, 0 for no limit.
+     */
+    [[nodiscard]] qsizetype capacity() const
+    {
+        return m_capacity;
+    }
+
+    void setCapacity(qsizetype capacity)
+    {
+        m_capacity = capacity;
+        trim();
+    }
+
+    [[nodiscard]] qsizetype size() const
+    {
+        return qsizetype(m_entries.size());
+    }
+
+    [[nodiscard]] bool contains(const QString &key) const
+    {
+        return m_entries.contains(key);
+    }
+
+    /**
+     * @brief The keys of the cached models, most recently used first.
+     */
+    [[nodiscard]] QList<QString> keys() const
+    {
+        return QList<QString>(m_order.cbegin(), m_order.cend());
+    }
+
+    /**
+     * @brief Return the model for the given key marking it as recently used.
+     *
+     * Returns nullptr if there is no model for the key.
+     */
+    Model *object(const QString &key)
+    {
+        const auto it = m_entries.find(key);
+        if (it == m_entries.end()) {
+            return nullptr;
+        }
+        used(it->second);
+        protect(it->second.model.get());
+        return it->second.model.get();
+    }
+
+    /**
+     * @brief Insert a model for the given key and return it.
+     *
+     * If necessary other models are evicted to respect the capacities, the new
+     * model is never evicted by this call.
+     */
+    Model *insert(const QString &key, std::unique_ptr<Model> model)
+    {
+        remove(key);
+        m_order.push_front(key);
+        auto &entry = m_entries[key];
+        entry.model = std::move(model);
+        entry.position = m_order.begin();
+        entry.globalPosition = modelAdded(key);
+
+        auto newModel = entry.model.get();
+        protect(newModel);
+        trim();
+        enforceGlobalCapacity();
+        return newModel;
+    }
+
+    /**
+     * @brief Remove the model for the given key from the cache and return it.
+     */
+    std::unique_ptr<Model> take(const QString &key)
+    {
+        const auto it = m_entries.find(key);
+        if (it == m_entries.end()) {
+            return {};
+        }
+        auto model = std::move(it->second.model);
+        erase(it, false);
+        return model;
+    }
+
+    /**
+     * @brief Delete the model for the given key.
+     */
+    void remove(const QString &key)
+    {
+        take(key);
+    }
+
+    /**
+     * @brief Delete all the models in the cache.
+     */
+    void clear()
+    {
+        while (!m_entries.empty()) {
+            erase(m_entries.begin(), false);
+        }
+    }
+
+protected:
+    bool tryEvict(const QString &key) override
+    {
+        const auto it = m_entries.find(key);
+        if (it == m_entries.end()) {
+            return false;
+        }
+        if (isProtected(it->second.model.get()) || it->second.model->isInUse()) {
+            used(it->second);
+            return false;
+        }
+        it->second.model.release()->deleteLater();
+        erase(it, true);
+        return true;
+    }
+
+private:
+    struct Entry {
+        std::unique_ptr<Model> model;
+        typename std::list<QString>::iterator position;
+        GlobalPosition globalPosition;
+    };
+    std::unordered_map<QString, Entry> m_entries;
+    // Most recently used first.
+    std::list<QString> m_order;
+    qsizetype m_capacity = 0;
+
+    void used(Entry &entry)
+    {
+        m_order.splice(m_order.begin(), m_order, entry.position);
+        modelUsed(entry.globalPosition);
+    }
+
+    void erase(typename std::unordered_map<QString, Entry>::iterator it, bool evicted)
+    {
+        m_order.erase(it->second.position);
+        const auto globalPosition = it->second.globalPosition;
+        m_entries.erase(it);
+        modelRemoved(globalPosition, evicted);
+    }
+
+    void trim()
+    {
+        // Each failed attempt moves the model to the front, so once every model
+        // has been tried the rest are in use.
+        for (auto attempts = size(); m_capacity > 0 && size() > m_capacity && attempts > 0; --attempts) {
+            const auto key = m_order.back();
+            tryEvict(key);
+        }
+    }
+};
@@ -5,6 +5,8 @@
 
 #include <QDebug>
 
+#include "userlistmodel.h"
+
 bool CompletionProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
 {
     Q_UNUSED(sourceParent);
@@ -12,6 +14,14 @@ bool CompletionProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &so
         return false;
     }
 
+    // Completing a user doesn't need to go through data() for every member of a large room.
+    if (const auto userListModel = qobject_cast<UserListModel *>(sourceModel());
+        userListModel && filterRole() == UserListModel::UserIdRole && m_secondaryFilterRole == UserListModel::DisplayNameRole) {
+        const auto &member = userListModel->member(sourceRow);
+        return (member.foldedId.startsWith(m_foldedFilterText) && !m_fullText.startsWith(member.id))
+            || member.foldedName.startsWith(QStringView(m_foldedFilterText).sliced(1));
+    }
+
     if (sourceModel()->data(sourceModel()->index(sourceRow, 0), filterRole()).toString().isEmpty()) {
         return false;
     }
@@ -54,6 +64,7 @@ QString CompletionProxyModel::filterText() const
 void CompletionProxyModel::setFilterText(const QString &filterText)
 {
     m_filterText = filterText;
+    m_foldedFilterText = filterText.toCaseFolded();
 }
 
 void CompletionProxyModel::setFullText(const QString &fullText)
@@ -73,5 +73,6 @@ public:
 private:
     int m_secondaryFilterRole = -1;
     QString m_filterText;
+    QString m_foldedFilterText;
     QString m_fullText;
 };
@@ -0,0 +1,191 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "contentmodeldispatcher.h"
+
+#include <Quotient/roommember.h>
+
+#include "chatbarcache.h"
+#include "messagecontentmodel.h"
+#include "neochatroom.h"
+
+using namespace Quotient;
+
+ContentModelDispatcher::ContentModelDispatcher(NeoChatRoom *room)
+    : QObject(room)
+    , m_room(room)
+{
+    Q_ASSERT(m_room);
+
+    // A new pending event has no ID the models could know yet so any model waiting
+    // for its event may be interested. This only happens when the local user sends.
+    connect(m_room, &NeoChatRoom::pendingEventAdded, this, [this]() {
+        dispatchToAll([](MessageContentModel *model) {
+            model->handlePendingEventAdded();
+        });
+    });
+    connect(m_room, &NeoChatRoom::pendingEventAboutToMerge, this, [this](Quotient::RoomEvent *serverEvent) {
+        m_mergingEventIds += serverEvent->id();
+        const auto handler = [serverEvent](MessageContentModel *model) {
+            model->handlePendingEventAboutToMerge(serverEvent);
+        };
+        dispatchToEvent(serverEvent->transactionId(), handler);
+        dispatchToEvent(serverEvent->id(), handler);
+    });
+    connect(m_room, &NeoChatRoom::pendingEventMerged, this, [this]() {
+        const auto mergedEventIds = std::exchange(m_mergingEventIds, {});
+        for (const auto &eventId : mergedEventIds) {
+            dispatchToEvent(eventId, [](MessageContentModel *model) {
+                model->handlePendingEventMerged();
+            });
+        }
+    });
+    connect(m_room, &NeoChatRoom::addedMessages, this, [this](int fromIndex, int toIndex) {
+        for (int i = fromIndex; i <= toIndex; i++) {
+            dispatchToEvent(m_room->findInTimeline(i)->event()->id(), [](MessageContentModel *model) {
+                model->handleEventAdded();
+            });
+        }
+    });
+    connect(m_room, &NeoChatRoom::replacedEvent, this, [this](const Quotient::RoomEvent *newEvent) {
+        dispatchToEvent(newEvent->id(), [](MessageContentModel *model) {
+            model->handleReplacedEvent();
+        });
+    });
+    connect(m_room, &NeoChatRoom::updatedEvent, this, [this](const QString &eventId) {
+        dispatchToEvent(eventId, [](MessageContentModel *model) {
+            model->handleEventUpdated();
+        });
+    });
+
+    connect(m_room, &NeoChatRoom::newFileTransfer, this, [this](const QString &eventId) {
+        dispatchToEvent(eventId, [](MessageContentModel *model) {
+            model->handleFileTransferChanged(false);
+        });
+    });
+    connect(m_room, &NeoChatRoom::fileTransferProgress, this, [this](const QString &eventId) {
+        dispatchToEvent(eventId, [](MessageContentModel *model) {
+            model->handleFileTransferChanged(false);
+        });
+    });
+    connect(m_room, &NeoChatRoom::fileTransferCompleted, this, [this](const QString &eventId) {
+        dispatchToEvent(eventId, [](MessageContentModel *model) {
+            model->handleFileTransferChanged(true);
+        });
+    });
+    connect(m_room, &NeoChatRoom::fileTransferFailed, this, [this](const QString &eventId) {
+        dispatchToEvent(eventId, [](MessageContentModel *model) {
+            model->handleFileTransferChanged(true);
+        });
+    });
+    connect(m_room, &NeoChatRoom::cachedFileTransferInfoChanged, this, [this](const QString &eventId) {
+        dispatchToEvent(eventId, [](MessageContentModel *model) {
+            model->handleFileTransferChanged(true);
+        });
+    });
+
+    connect(m_room->editCache(), &ChatBarCache::relationIdChanged, this, [this](const QString &oldEventId, const QString &newEventId) {
+        if (oldEventId != newEventId) {
+            dispatchToEvent(oldEventId, [](MessageContentModel *model) {
+                model->handleEditRelationChanged(false);
+            });
+        }
+        dispatchToEvent(newEventId, [](MessageContentModel *model) {
+            model->handleEditRelationChanged(true);
+        });
+    });
+    connect(m_room->threadCache(), &ChatBarCache::threadIdChanged, this, [this](const QString &oldThreadId, const QString &newThreadId) {
+        if (oldThreadId != newThreadId) {
+            dispatchToEvent(oldThreadId, [](MessageContentModel *model) {
+                model->handleThreadChanged(false);
+            });
+        }
+        dispatchToEvent(newThreadId, [](MessageContentModel *model) {
+            model->handleThreadChanged(true);
+        });
+    });
+
+    const auto memberUpdated = [this](RoomMember member) {
+        const auto handler = [](MessageContentModel *model) {
+            model->handleSenderUpdated();
+        };
+        dispatchToSender(member.id(), handler);
+        // Models whose event isn't available yet don't know their sender.
+        dispatchToSender({}, handler);
+    };
+    connect(m_room, &Room::memberNameUpdated, this, memberUpdated);
+    connect(m_room, &Room::memberAvatarUpdated, this, memberUpdated);
+}
+
+void ContentModelDispatcher::registerModel(MessageContentModel *model, const QString &eventId, const QString &senderId)
+{
+    Q_ASSERT(model);
+
+    const auto it = m_keys.constFind(model);
+    if (it != m_keys.constEnd()) {
+        if (it->eventId == eventId && it->senderId == senderId) {
+            return;
+        }
+        m_eventModels.remove(it->eventId, model);
+        m_senderModels.remove(it->senderId, model);
+    } else {
+        connect(model, &QObject::destroyed, this, [this, model]() {
+            unregisterModel(model);
+        });
+    }
+
+    m_keys[model] = Keys{eventId, senderId};
+    m_eventModels.insert(eventId, model);
+    m_senderModels.insert(senderId, model);
+}
+
+void ContentModelDispatcher::unregisterModel(MessageContentModel *model)
+{
+    const auto keys = m_keys.take(model);
+    m_eventModels.remove(keys.eventId, model);
+    m_senderModels.remove(keys.senderId, model);
+}
+
+qsizetype ContentModelDispatcher::modelCount() const
+{
+    return m_keys.size();
+}
+
+void ContentModelDispatcher::dispatchToEvent(const QString &eventId, const std::function<void(MessageContentModel *)> &function)
+{
+    if (eventId.isEmpty() || !m_eventModels.contains(eventId)) {
+        return;
+    }
+    // Copy as the handlers may change the registrations.
+    const auto models = m_eventModels.values(eventId);
+    for (const auto &model : models) {
+        if (m_keys.contains(model)) {
+            function(model);
+        }
+    }
+}
+
+void ContentModelDispatcher::dispatchToSender(const QString &senderId, const std::function<void(MessageContentModel *)> &function)
+{
+    if (!m_senderModels.contains(senderId)) {
+        return;
+    }
+    const auto models = m_senderModels.values(senderId);
+    for (const auto &model : models) {
+        if (m_keys.contains(model)) {
+            function(model);
+        }
+    }
+}
+
+void ContentModelDispatcher::dispatchToAll(const std::function<void(MessageContentModel *)> &function)
+{
+    const auto models = m_keys.keys();
+    for (const auto &model : models) {
+        if (m_keys.contains(model)) {
+            function(model);
+        }
+    }
+}
+
+#include "moc_contentmodeldispatcher.cpp"
@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QHash>
+#include <QMultiHash>
+#include <QObject>
+#include <QString>
+
+#include <functional>
+
+namespace Quotient
+{
+class RoomEvent;
+}
+
+class MessageContentModel;
+class NeoChatRoom;
+
+/**
+ * @class ContentModelDispatcher
+ *
+ * This class routes a room's signals to the MessageContentModels they affect.
+ *
+ * Rather than every MessageContentModel connecting to every room signal and then
+ * discarding everything not for its event, the dispatcher connects once per room
+ * and looks up the affected models by event ID or sender ID. This means the cost of
+ * a signal is independent of the number of live content models in the room.
+ *
+ * Signals that affect all models, e.g. config changes, are not handled here.
+ *
+ * @sa MessageContentModel, NeoChatRoom
+ */
+class ContentModelDispatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ContentModelDispatcher(NeoChatRoom *room);
+
+    /**
+     * @brief Start routing signals for the given event and sender IDs to the model.
+     *
+     * If the model is already registered its IDs are updated. The model is
+     * automatically unregistered when it is destroyed.
+     *
+     * @note The sender ID may be empty if the event is not yet available, the model
+     *       will then receive all member updates.
+     */
+    void registerModel(MessageContentModel *model, const QString &eventId, const QString &senderId);
+
+    /**
+     * @brief Stop routing signals to the given model.
+     */
+    void unregisterModel(MessageContentModel *model);
+
+    /**
+     * @brief The number of models currently registered.
+     */
+    [[nodiscard]] qsizetype modelCount() const;
+
+private:
+    NeoChatRoom *m_room;
+
+    struct Keys {
+        QString eventId;
+        QString senderId;
+    };
+    QHash<MessageContentModel *, Keys> m_keys;
+    QMultiHash<QString, MessageContentModel *> m_eventModels;
+    QMultiHash<QString, MessageContentModel *> m_senderModels;
+    QStringList m_mergingEventIds;
+
+    /**
+     * @brief Call the given function for every model registered for the event ID.
+     *
+     * Models registered or unregistered by the function are handled safely.
+     */
+    void dispatchToEvent(const QString &eventId, const std::function<void(MessageContentModel *)> &function);
+    void dispatchToSender(const QString &senderId, const std::function<void(MessageContentModel *)> &function);
+    void dispatchToAll(const std::function<void(MessageContentModel *)> &function);
+};
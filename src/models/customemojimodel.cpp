@@ -50,14 +50,19 @@ void CustomEmojiModel::fetchEmojis()
 
     beginResetModel();
     m_emojis.clear();
+    m_index.clear();
 
+    QList<QString> names;
     for (const auto &emoji : emojis.keys()) {
         const auto &data = emojis[emoji];
 
         const auto e = emoji.startsWith(":"_L1) ? emoji : (u":"_s + emoji + u":"_s);
 
-        m_emojis << CustomEmoji{e, data.toObject()["url"_L1].toString(), QRegularExpression(e)};
+        m_emojis << CustomEmoji{e, data.toObject()["url"_L1].toString()};
+        m_index.add(e);
+        names += e;
     }
+    m_matcher.setPatterns(names);
 
     endResetModel();
 }
@@ -188,22 +193,29 @@ QHash<int, QByteArray> CustomEmojiModel::roleNames() const
 
 QString CustomEmojiModel::preprocessText(QString text)
 {
-    for (const auto &emoji : std::as_const(m_emojis)) {
-        text.replace(emoji.regexp,
-                     uR"(<img data-mx-emoticon="" src="%1" alt="%2" title="%2" height="32" vertical-align="middle" />)"_s.arg(emoji.url, emoji.name));
+    const auto matches = m_matcher.matches(text);
+    if (matches.isEmpty()) {
+        return text;
     }
-    return text;
+
+    QString result;
+    qsizetype position = 0;
+    for (const auto &match : matches) {
+        const auto &emoji = m_emojis[match.pattern];
+        result += QStringView(text).sliced(position, match.start - position);
+        result += uR"(<img data-mx-emoticon="" src="%1" alt="%2" title="%2" height="32" vertical-align="middle" />)"_s.arg(emoji.url, emoji.name);
+        position = match.start + match.length;
+    }
+    result += QStringView(text).sliced(position);
+    return result;
 }
 
 QVariantList CustomEmojiModel::filterModel(const QString &filter)
 {
     QVariantList results;
-    for (const auto &emoji : std::as_const(m_emojis)) {
-        if (results.length() >= 10)
-            break;
-        if (!emoji.name.contains(filter, Qt::CaseInsensitive))
-            continue;
-
+    const auto rows = m_index.search(filter, 10);
+    for (const auto row : rows) {
+        const auto &emoji = m_emojis[row];
         results << QVariant::fromValue(Emoji(m_connection->makeMediaUrl(QUrl(emoji.url)).toString(), emoji.name, true));
     }
     return results;
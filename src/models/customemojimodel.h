@@ -5,14 +5,14 @@
 
 #include <QAbstractListModel>
 #include <QQmlEngine>
-#include <QRegularExpression>
 
+#include "emojiindex.h"
 #include "neochatconnection.h"
+#include "shortcodematcher.h"
 
 struct CustomEmoji {
     QString name; // with :semicolons:
     QString url; // mxc://
-    QRegularExpression regexp;
 
     Q_GADGET
     Q_PROPERTY(QString unicode MEMBER url)
@@ -88,6 +88,8 @@ public:
 
     /**
      * @brief Return a list of custom emojis where the name contains the filter text.
+     *
+     * At most 10 emojis are returned, best matches first.
      */
     Q_INVOKABLE QVariantList filterModel(const QString &filter);
 
@@ -110,6 +112,10 @@ Q_SIGNALS:
 private:
     explicit CustomEmojiModel(QObject *parent = nullptr);
     QList<CustomEmoji> m_emojis;
+    // Names of m_emojis.
+    EmojiIndex m_index;
+    // Names of m_emojis, for preprocessText().
+    ShortcodeMatcher m_matcher;
     QPointer<NeoChatConnection> m_connection;
 
     void fetchEmojis();
@@ -22,40 +22,55 @@ EmojiModel::EmojiModel(QObject *parent)
     if (_emojis.isEmpty()) {
 #include "emojis.h"
     }
+
+    // Flatten the categories once so that rows and search results map straight
+    // to an emoji rather than walking the categories and unwrapping QVariants.
+    qsizetype total = 0;
+    for (const auto &category : std::as_const(_emojis)) {
+        total += category.count();
+    }
+    m_table.reserve(total);
+    m_variants.reserve(total);
+    m_index.reserve(total);
+    for (int category = Smileys; category <= Component; ++category) {
+        for (const auto &variant : std::as_const(_emojis[Category(category)])) {
+            const auto emoji = variant.value<Emoji>();
+            // A few short names are used twice, history shows the first.
+            if (!m_rowForShortName.contains(emoji.shortName)) {
+                m_rowForShortName.insert(emoji.shortName, m_table.size());
+            }
+            m_index.add(emoji.shortName, emoji.description);
+            m_table.append(emoji);
+            m_variants.append(variant);
+        }
+    }
 }
 
 int EmojiModel::rowCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
-    int total = 0;
-    for (const auto &category : std::as_const(_emojis)) {
-        total += category.count();
-    }
-    return total;
+    return m_table.size();
 }
 
 QVariant EmojiModel::data(const QModelIndex &index, int role) const
 {
-    auto row = index.row();
-    for (const auto &category : std::as_const(_emojis)) {
-        if (row >= category.count()) {
-            row -= category.count();
-            continue;
-        }
-        auto emoji = category[row].value<Emoji>();
-        switch (role) {
-        case ShortNameRole:
-            return u":%1:"_s.arg(emoji.shortName);
-        case UnicodeRole:
-        case ReplacedTextRole:
-            return emoji.unicode;
-        case InvalidRole:
-            return u"invalid"_s;
-        case DisplayRole:
-            return u"%2   :%1:"_s.arg(emoji.shortName, emoji.unicode);
-        case DescriptionRole:
-            return emoji.description;
-        }
+    const auto row = index.row();
+    if (row < 0 || row >= m_table.size()) {
+        return {};
+    }
+    const auto &emoji = m_table[row];
+    switch (role) {
+    case ShortNameRole:
+        return u":%1:"_s.arg(emoji.shortName);
+    case UnicodeRole:
+    case ReplacedTextRole:
+        return emoji.unicode;
+    case InvalidRole:
+        return u"invalid"_s;
+    case DisplayRole:
+        return u"%2   :%1:"_s.arg(emoji.shortName, emoji.unicode);
+    case DescriptionRole:
+        return emoji.description;
     }
     return {};
 }
@@ -79,19 +94,13 @@ QVariantList EmojiModel::filterModel(const QString &filter, bool limit)
 
 QVariantList EmojiModel::filterModelNoCustom(const QString &filter, bool limit)
 {
-    QVariantList result;
+    const auto &model = instance();
+    const auto rows = model.m_index.search(filter, limit ? 10 : -1);
 
-    const auto &values = _emojis.values();
-    for (const auto &e : values) {
-        for (const auto &variant : e) {
-            const auto &emoji = qvariant_cast<Emoji>(variant);
-            if (emoji.shortName.contains(filter, Qt::CaseInsensitive)) {
-                result.append(variant);
-                if (result.length() > 10 && limit) {
-                    return result;
-                }
-            }
-        }
+    QVariantList result;
+    result.reserve(rows.size());
+    for (const auto row : rows) {
+        result.append(model.m_variants[row]);
     }
     return result;
 }
@@ -230,12 +239,9 @@ QVariantList EmojiModel::emojiHistory() const
     QVariantList list;
     const auto &lastUsed = lastUsedEmojis();
     for (const auto &historicEmoji : lastUsed) {
-        for (const auto &emojiCategory : std::as_const(_emojis)) {
-            for (const auto &emoji : emojiCategory) {
-                if (qvariant_cast<Emoji>(emoji).shortName == historicEmoji) {
-                    list.append(emoji);
-                }
-            }
+        const auto it = m_rowForShortName.constFind(historicEmoji);
+        if (it != m_rowForShortName.constEnd()) {
+            list.append(m_variants[*it]);
         }
     }
     return list;
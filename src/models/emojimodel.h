@@ -9,6 +9,8 @@
 #include <QObject>
 #include <QQmlEngine>
 
+#include "emojiindex.h"
+
 struct Emoji {
     Emoji(QString unicode, QString shortname, bool isCustom = false)
         : unicode(std::move(unicode))
@@ -142,6 +144,9 @@ public:
     /**
      * @brief Return a filtered list of emojis without custom emojis.
      *
+     * Emojis whose short name or description contains the filter are returned,
+     * best matches first. See EmojiIndex::Rank.
+     *
      * @note Use filterModel to return a result with custom emojis.
      *
      * @sa filterModel
@@ -175,6 +180,14 @@ public Q_SLOTS:
 private:
     static QHash<Category, QVariantList> _emojis;
 
+    // Every emoji in category order, along with the QVariant from _emojis so that
+    // results can be returned without wrapping them again.
+    QList<Emoji> m_table;
+    QVariantList m_variants;
+    // Short names and descriptions of m_table.
+    EmojiIndex m_index;
+    QHash<QString, int> m_rowForShortName;
+
     /// Returns QVariants containing the last used Emojis
     QVariantList emojiHistory() const;
 
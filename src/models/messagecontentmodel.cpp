@@ -7,6 +7,7 @@
 #include "neochatconfig.h"
 
 #include <QImageReader>
+#include <QMetaMethod>
 
 #include <Quotient/events/eventcontent.h>
 #include <Quotient/events/redactionevent.h>
@@ -28,13 +29,28 @@
 #include "chatbarcache.h"
 #include "filetype.h"
 #include "linkpreviewer.h"
+#include "models/contentmodeldispatcher.h"
 #include "models/reactionmodel.h"
 #include "neochatconnection.h"
 #include "neochatroom.h"
+#include "textfilepreview.h"
 #include "texthandler.h"
 
 using namespace Quotient;
 
+#ifndef Q_OS_ANDROID
+namespace
+{
+// Loading the syntax definitions is expensive so only do it once, the first
+// time a text file is shown.
+KSyntaxHighlighting::Repository &syntaxRepository()
+{
+    static KSyntaxHighlighting::Repository repository;
+    return repository;
+}
+}
+#endif
+
 MessageContentModel::MessageContentModel(NeoChatRoom *room, const QString &eventId, bool isReply, bool isPending, MessageContentModel *parent)
     : QAbstractListModel(parent)
     , m_room(room)
@@ -50,116 +66,20 @@ void MessageContentModel::initializeModel()
     Q_ASSERT(m_room != nullptr);
     Q_ASSERT(!m_eventId.isEmpty());
 
-    connect(m_room, &NeoChatRoom::pendingEventAdded, this, [this]() {
-        if (m_room != nullptr && m_currentState == Unknown) {
-            initializeEvent();
-            updateReplyModel();
-            resetModel();
-        }
-    });
-    connect(m_room, &NeoChatRoom::pendingEventAboutToMerge, this, [this](Quotient::RoomEvent *serverEvent) {
-        if (m_room != nullptr) {
-            if (m_eventId == serverEvent->id() || m_eventId == serverEvent->transactionId()) {
-                m_eventId = serverEvent->id();
-            }
-        }
-    });
-    connect(m_room, &NeoChatRoom::pendingEventMerged, this, [this]() {
-        if (m_room != nullptr && m_currentState == Pending) {
-            initializeEvent();
-            updateReplyModel();
-            resetModel();
-        }
-    });
-    connect(m_room, &NeoChatRoom::addedMessages, this, [this](int fromIndex, int toIndex) {
-        if (m_room != nullptr) {
-            for (int i = fromIndex; i <= toIndex; i++) {
-                if (m_room->findInTimeline(i)->event()->id() == m_eventId) {
-                    initializeEvent();
-                    updateReplyModel();
-                    resetModel();
-                }
-            }
-        }
-    });
-    connect(m_room, &NeoChatRoom::replacedEvent, this, [this](const Quotient::RoomEvent *newEvent) {
-        if (m_room != nullptr) {
-            if (m_eventId == newEvent->id()) {
-                beginResetModel();
-                initializeEvent();
-                resetContent();
-                endResetModel();
-            }
-        }
-    });
-    connect(m_room, &NeoChatRoom::newFileTransfer, this, [this](const QString &eventId) {
-        if (eventId == m_eventId) {
-            Q_EMIT dataChanged(index(0), index(rowCount() - 1), {FileTransferInfoRole});
-        }
-    });
-    connect(m_room, &NeoChatRoom::fileTransferProgress, this, [this](const QString &eventId) {
-        if (eventId == m_eventId) {
-            Q_EMIT dataChanged(index(0), index(rowCount() - 1), {FileTransferInfoRole});
-        }
-    });
-    connect(m_room, &NeoChatRoom::fileTransferCompleted, this, [this](const QString &eventId) {
-        if (m_room != nullptr && eventId == m_eventId) {
-            resetContent();
-            Q_EMIT dataChanged(index(0), index(rowCount() - 1), {FileTransferInfoRole});
-        }
-    });
-    connect(m_room, &NeoChatRoom::fileTransferFailed, this, [this](const QString &eventId) {
-        if (eventId == m_eventId) {
-            resetContent();
-            Q_EMIT dataChanged(index(0), index(rowCount() - 1), {FileTransferInfoRole});
-        }
-    });
-    connect(m_room->editCache(), &ChatBarCache::relationIdChanged, this, [this](const QString &oldEventId, const QString &newEventId) {
-        if (oldEventId == m_eventId || newEventId == m_eventId) {
-            // HACK: Because DelegateChooser can't switch the delegate on dataChanged it has to think there is a new delegate.
-            beginResetModel();
-            resetContent(newEventId == m_eventId);
-            endResetModel();
-        }
-    });
-    connect(m_room->threadCache(), &ChatBarCache::threadIdChanged, this, [this](const QString &oldThreadId, const QString &newThreadId) {
-        if (oldThreadId == m_eventId || newThreadId == m_eventId) {
-            beginResetModel();
-            resetContent(false, newThreadId == m_eventId);
-            endResetModel();
-        }
-    });
+    // Signals for a specific event or sender are routed by the room's dispatcher
+    // to avoid every model having to check every signal.
+    updateDispatcherKeys();
+
     connect(m_room, &NeoChatRoom::urlPreviewEnabledChanged, this, [this]() {
         resetContent();
     });
     connect(NeoChatConfig::self(), &NeoChatConfig::ShowLinkPreviewChanged, this, [this]() {
         resetContent();
     });
-    connect(m_room, &Room::memberNameUpdated, this, [this](RoomMember member) {
-        if (m_room != nullptr) {
-            if (senderId().isEmpty() || senderId() == member.id()) {
-                Q_EMIT dataChanged(index(0, 0), index(rowCount() - 1, 0), {AuthorRole});
-            }
-        }
-    });
-    connect(m_room, &Room::memberAvatarUpdated, this, [this](RoomMember member) {
-        if (m_room != nullptr) {
-            if (senderId().isEmpty() || senderId() == member.id()) {
-                Q_EMIT dataChanged(index(0, 0), index(rowCount() - 1, 0), {AuthorRole});
-            }
-        }
-    });
-
     connect(NeoChatConfig::self(), &NeoChatConfig::ThreadsChanged, this, [this]() {
         updateReplyModel();
         resetModel();
     });
-    connect(m_room, &Room::updatedEvent, this, [this](const QString &eventId) {
-        if (eventId == m_eventId) {
-            updateReactionModel();
-        }
-    });
-
     initializeEvent();
     if (m_currentState == Available || m_currentState == Pending) {
         updateReplyModel();
@@ -168,6 +88,95 @@ void MessageContentModel::initializeModel()
     updateReactionModel();
 }
 
+void MessageContentModel::updateDispatcherKeys()
+{
+    if (m_room != nullptr) {
+        m_room->contentModelDispatcher()->registerModel(this, m_eventId, senderId());
+    }
+}
+
+void MessageContentModel::handlePendingEventAdded()
+{
+    if (m_room != nullptr && m_currentState == Unknown) {
+        initializeEvent();
+        updateReplyModel();
+        resetModel();
+    }
+}
+
+void MessageContentModel::handlePendingEventAboutToMerge(Quotient::RoomEvent *serverEvent)
+{
+    if (m_room != nullptr) {
+        if (m_eventId == serverEvent->id() || m_eventId == serverEvent->transactionId()) {
+            m_eventId = serverEvent->id();
+            updateDispatcherKeys();
+        }
+    }
+}
+
+void MessageContentModel::handlePendingEventMerged()
+{
+    if (m_room != nullptr && m_currentState == Pending) {
+        initializeEvent();
+        updateReplyModel();
+        resetModel();
+    }
+}
+
+void MessageContentModel::handleEventAdded()
+{
+    if (m_room != nullptr) {
+        initializeEvent();
+        updateReplyModel();
+        resetModel();
+    }
+}
+
+void MessageContentModel::handleReplacedEvent()
+{
+    if (m_room != nullptr) {
+        beginResetModel();
+        initializeEvent();
+        resetContent();
+        endResetModel();
+    }
+}
+
+void MessageContentModel::handleEventUpdated()
+{
+    updateReactionModel();
+}
+
+void MessageContentModel::handleFileTransferChanged(bool finished)
+{
+    if (m_room != nullptr && finished) {
+        resetContent();
+    }
+    Q_EMIT dataChanged(index(0), index(rowCount() - 1), {FileTransferInfoRole});
+}
+
+void MessageContentModel::handleEditRelationChanged(bool isEditing)
+{
+    // HACK: Because DelegateChooser can't switch the delegate on dataChanged it has to think there is a new delegate.
+    beginResetModel();
+    resetContent(isEditing);
+    endResetModel();
+}
+
+void MessageContentModel::handleThreadChanged(bool isThreading)
+{
+    beginResetModel();
+    resetContent(false, isThreading);
+    endResetModel();
+}
+
+void MessageContentModel::handleSenderUpdated()
+{
+    if (m_room != nullptr) {
+        Q_EMIT dataChanged(index(0, 0), index(rowCount() - 1, 0), {AuthorRole});
+    }
+}
+
 void MessageContentModel::initializeEvent()
 {
     if (m_currentState == UnAvailable) {
@@ -186,6 +195,7 @@ void MessageContentModel::initializeEvent()
     } else {
         m_currentState = Available;
     }
+    updateDispatcherKeys();
     Q_EMIT eventUpdated();
 }
 
@@ -216,6 +226,11 @@ void MessageContentModel::getEvent()
     m_room->downloadEventFromServer(m_eventId);
 }
 
+bool MessageContentModel::isInUse() const
+{
+    return isSignalConnected(QMetaMethod::fromSignal(&QAbstractItemModel::dataChanged));
+}
+
 QString MessageContentModel::senderId() const
 {
     const auto eventResult = m_room->getEvent(m_eventId);
@@ -366,7 +381,7 @@ QVariant MessageContentModel::data(const QModelIndex &index, int role) const
     if (role == LinkPreviewerRole) {
         if (component.type == MessageComponentType::LinkPreview) {
             return QVariant::fromValue<LinkPreviewer *>(
-                dynamic_cast<NeoChatConnection *>(m_room->connection())->previewerForLink(component.attributes["link"_L1].toUrl()));
+                dynamic_cast<NeoChatConnection *>(m_room->connection())->previewerForLink(component.attributes["link"_L1].toUrl(), m_room->usesEncryption()));
         } else {
             return QVariant::fromValue<LinkPreviewer *>(emptyLinkPreview);
         }
@@ -582,17 +597,13 @@ QList<MessageComponent> MessageContentModel::componentsForType(MessageComponentT
                     if (originalName.isEmpty()) {
                         originalName = roomMessageEvent->plainBody();
                     }
-                    KSyntaxHighlighting::Repository repository;
+                    auto &repository = syntaxRepository();
                     KSyntaxHighlighting::Definition definitionForFile = repository.definitionForFileName(originalName);
                     if (!definitionForFile.isValid()) {
                         definitionForFile = repository.definitionForMimeType(mimeType.name());
                     }
 
-                    QFile file(fileTransferInfo.localPath.path());
-                    file.open(QIODevice::ReadOnly);
-                    components += MessageComponent{MessageComponentType::Code,
-                                                   QString::fromStdString(file.readAll().toStdString()),
-                                                   {{u"class"_s, definitionForFile.name()}}};
+                    components += filePreviewComponent(fileTransferInfo.localPath.path(), definitionForFile.name());
                 }
 #endif
 
@@ -646,9 +657,48 @@ QList<MessageComponent> MessageContentModel::componentsForType(MessageComponentT
     }
 }
 
+MessageComponent MessageContentModel::filePreviewComponent(const QString &path, const QString &definition)
+{
+    if (path.isEmpty() || (path == m_filePreviewPath && m_filePreviewLoaded)) {
+        return MessageComponent{MessageComponentType::Code, m_filePreview, {{u"class"_s, definition}, {u"truncated"_s, m_filePreviewTruncated}}};
+    }
+
+    // Show a loading component until the file has been read.
+    const MessageComponent loading{MessageComponentType::Loading, QString(), {{u"class"_s, definition}, {u"path"_s, path}}};
+    if (path == m_filePreviewPath) {
+        return loading;
+    }
+    m_filePreviewPath = path;
+    m_filePreviewLoaded = false;
+    m_filePreview.clear();
+    m_filePreviewTruncated = false;
+    TextFilePreview::forFile(path).then(this, [this, path](const TextFilePreview::Preview &preview) {
+        // The file may have been replaced while it was being read.
+        if (path != m_filePreviewPath) {
+            return;
+        }
+        m_filePreview = preview.text;
+        m_filePreviewTruncated = preview.truncated;
+        m_filePreviewLoaded = true;
+        for (qsizetype i = 0; i < m_components.size(); ++i) {
+            auto &component = m_components[i];
+            if (component.type == MessageComponentType::Loading && component.attributes[u"path"_s].toString() == path) {
+                // HACK: Because DelegateChooser can't switch the delegate on dataChanged it has to think there is a new delegate.
+                beginResetModel();
+                component.type = MessageComponentType::Code;
+                component.content = m_filePreview;
+                component.attributes.remove(u"path"_s);
+                component.attributes[u"truncated"_s] = m_filePreviewTruncated;
+                endResetModel();
+            }
+        }
+    });
+    return loading;
+}
+
 MessageComponent MessageContentModel::linkPreviewComponent(const QUrl &link)
 {
-    const auto linkPreviewer = dynamic_cast<NeoChatConnection *>(m_room->connection())->previewerForLink(link);
+    const auto linkPreviewer = dynamic_cast<NeoChatConnection *>(m_room->connection())->previewerForLink(link, m_room->usesEncryption());
     if (linkPreviewer == nullptr) {
         return {};
     }
@@ -656,7 +706,7 @@ MessageComponent MessageContentModel::linkPreviewComponent(const QUrl &link)
         return MessageComponent{MessageComponentType::LinkPreview, QString(), {{"link"_L1, link}}};
     } else {
         connect(linkPreviewer, &LinkPreviewer::loadedChanged, this, [this, link]() {
-            const auto linkPreviewer = dynamic_cast<NeoChatConnection *>(m_room->connection())->previewerForLink(link);
+            const auto linkPreviewer = dynamic_cast<NeoChatConnection *>(m_room->connection())->previewerForLink(link, m_room->usesEncryption());
             if (linkPreviewer != nullptr && linkPreviewer->loaded()) {
                 for (auto &component : m_components) {
                     if (component.attributes["link"_L1].toUrl() == link) {
@@ -678,14 +728,12 @@ QList<MessageComponent> MessageContentModel::addLinkPreviews(QList<MessageCompon
     while (i < inputComponents.size()) {
         const auto component = inputComponents.at(i);
         if (component.type == MessageComponentType::Text || component.type == MessageComponentType::Quote) {
-            if (LinkPreviewer::hasPreviewableLinks(component.content)) {
-                const auto links = LinkPreviewer::linkPreviews(component.content);
-                for (qsizetype j = 0; j < links.size(); ++j) {
-                    const auto linkPreview = linkPreviewComponent(links[j]);
-                    if (!m_removedLinkPreviews.contains(links[j]) && !linkPreview.isEmpty()) {
-                        inputComponents.insert(i + j + 1, linkPreview);
-                    }
-                };
+            // The links were found by TextHandler when the component was created.
+            for (qsizetype j = 0; j < component.links.size(); ++j) {
+                const auto linkPreview = linkPreviewComponent(component.links[j]);
+                if (!m_removedLinkPreviews.contains(component.links[j]) && !linkPreview.isEmpty()) {
+                    inputComponents.insert(i + j + 1, linkPreview);
+                }
             }
         }
         i++;
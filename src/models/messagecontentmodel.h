@@ -102,11 +102,21 @@ public:
      */
     Q_INVOKABLE void closeLinkPreview(int row);
 
+    /**
+     * @brief Whether anything is currently using the model, e.g. a QML delegate.
+     *
+     * This is based on whether anything is connected to the model's signals as
+     * views and proxy models always are.
+     */
+    [[nodiscard]] bool isInUse() const;
+
 Q_SIGNALS:
     void showAuthorChanged();
     void eventUpdated();
 
 private:
+    friend class ContentModelDispatcher;
+
     QPointer<NeoChatRoom> m_room;
     QString m_eventId;
     QString senderId() const;
@@ -119,6 +129,23 @@ private:
     void initializeEvent();
     void getEvent();
 
+    /**
+     * @brief Register the current event and sender IDs with the room's ContentModelDispatcher.
+     */
+    void updateDispatcherKeys();
+
+    // Called by ContentModelDispatcher for signals affecting this model's event or sender.
+    void handlePendingEventAdded();
+    void handlePendingEventAboutToMerge(Quotient::RoomEvent *serverEvent);
+    void handlePendingEventMerged();
+    void handleEventAdded();
+    void handleReplacedEvent();
+    void handleEventUpdated();
+    void handleFileTransferChanged(bool finished);
+    void handleEditRelationChanged(bool isEditing);
+    void handleThreadChanged(bool isThreading);
+    void handleSenderUpdated();
+
     QList<MessageComponent> m_components;
     void resetModel();
     void resetContent(bool isEditing = false, bool isThreading = false);
@@ -132,6 +159,21 @@ private:
 
     QList<MessageComponent> componentsForType(MessageComponentType::Type type);
     MessageComponent linkPreviewComponent(const QUrl &link);
+
+    /**
+     * @brief The Code component showing the start of the downloaded text file.
+     *
+     * The file is read on a thread pool thread, until it has been a Loading
+     * component is returned which is switched to Code once the text is available.
+     * The Code component has a "truncated" attribute when only the start of the
+     * file is shown.
+     */
+    MessageComponent filePreviewComponent(const QString &path, const QString &definition);
+    QString m_filePreviewPath;
+    QString m_filePreview;
+    bool m_filePreviewTruncated = false;
+    bool m_filePreviewLoaded = false;
+
     QList<MessageComponent> addLinkPreviews(QList<MessageComponent> inputComponents);
 
     QList<QUrl> m_removedLinkPreviews;
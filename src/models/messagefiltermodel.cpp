@@ -10,6 +10,7 @@
 #include "messagecontentmodel.h"
 #include "neochatconfig.h"
 #include "timelinemessagemodel.h"
+#include "visiblerowindex.h"
 
 using namespace Quotient;
 
@@ -18,6 +19,15 @@ MessageFilterModel::MessageFilterModel(QObject *parent, QAbstractItemModel *sour
 {
     Q_ASSERT(sourceModel);
     setSourceModel(sourceModel);
+    // Whether a row is hidden can change with its delivery status or thread, which
+    // aren't signalled with SpecialMarksRole, so every dataChanged is handled.
+    m_visibleRows = new VisibleRowIndex(
+        this,
+        [this](int row) {
+            return index(row, 0).data(TimelineMessageModel::SpecialMarksRole) != EventStatus::Hidden;
+        },
+        {},
+        this);
 
     connect(NeoChatConfig::self(), &NeoChatConfig::ShowStateEventChanged, this, [this] {
         invalidateFilter();
@@ -110,21 +120,17 @@ QHash<int, QByteArray> MessageFilterModel::roleNames() const
 
 bool MessageFilterModel::showAuthor(QModelIndex index) const
 {
-    for (auto r = index.row() + 1; r < rowCount(); ++r) {
-        auto i = this->index(r, 0);
-        // Note !itemData(i).empty() is a check for instances where rows have been removed, e.g. when the read marker is moved.
-        // While the row is removed the subsequent row indexes are not changed so we need to skip over the removed index.
-        // See - https://doc.qt.io/qt-5/qabstractitemmodel.html#beginRemoveRows
-        if (data(i, TimelineMessageModel::SpecialMarksRole) != EventStatus::Hidden && !itemData(i).empty()) {
-            return data(i, TimelineMessageModel::AuthorRole) != data(index, TimelineMessageModel::AuthorRole)
-                || data(i, TimelineMessageModel::DelegateTypeRole) == DelegateType::State
-                || data(i, TimelineMessageModel::TimeRole).toDateTime().msecsTo(data(index, TimelineMessageModel::TimeRole).toDateTime()) > 600000
-                || data(i, TimelineMessageModel::TimeRole).toDateTime().toLocalTime().date().day()
-                != data(index, TimelineMessageModel::TimeRole).toDateTime().toLocalTime().date().day();
-        }
+    const auto nextRow = m_visibleRows->nextVisibleRow(index.row());
+    if (nextRow < 0) {
+        return true;
     }
 
-    return true;
+    const auto i = this->index(nextRow, 0);
+    return data(i, TimelineMessageModel::AuthorRole) != data(index, TimelineMessageModel::AuthorRole)
+        || data(i, TimelineMessageModel::DelegateTypeRole) == DelegateType::State
+        || data(i, TimelineMessageModel::TimeRole).toDateTime().msecsTo(data(index, TimelineMessageModel::TimeRole).toDateTime()) > 600000
+        || data(i, TimelineMessageModel::TimeRole).toDateTime().toLocalTime().date().day()
+        != data(index, TimelineMessageModel::TimeRole).toDateTime().toLocalTime().date().day();
 }
 
 QString MessageFilterModel::aggregateEventToString(int sourceRow) const
@@ -9,6 +9,8 @@
 #include "timelinemessagemodel.h"
 #include "timelinemodel.h"
 
+class VisibleRowIndex;
+
 /**
  * @class MessageFilterModel
  *
@@ -59,6 +61,11 @@ public:
     [[nodiscard]] QHash<int, QByteArray> roleNames() const override;
 
 private:
+    /**
+     * @brief Index of the next non-hidden row used to calculate whether the author should be shown.
+     */
+    VisibleRowIndex *m_visibleRows = nullptr;
+
     bool eventIsVisible(int sourceRow, const QModelIndex &sourceParent) const;
 
     bool showAuthor(QModelIndex index) const;
@@ -17,18 +17,50 @@
 #include "enums/messagecomponenttype.h"
 #include "eventhandler.h"
 #include "events/pollevent.h"
+#include "messagemodel_logging.h"
 #include "models/reactionmodel.h"
+#include "models/visiblerowindex.h"
 #include "neochatroommember.h"
 
 using namespace Quotient;
 
 MessageModel::MessageModel(QObject *parent)
     : QAbstractListModel(parent)
+    , m_renderCache(MaxRenderCacheEvents)
 {
+    // This must be created before anything else connects to the row signals so
+    // that it is up to date when they are handled. Whether a row is hidden can also
+    // change with its delivery status or thread, which aren't signalled with
+    // SpecialMarksRole, so every dataChanged is handled.
+    m_visibleRows = new VisibleRowIndex(
+        this,
+        [this](int row) {
+            return data(index(row), SpecialMarksRole) != EventStatus::Hidden;
+        },
+        {},
+        this);
+    // The read marker is hidden when all the events after it are, which can change
+    // when rows are added or removed above it.
+    const auto refreshReadMarker = [this](const QModelIndex &, int first) {
+        if (m_lastReadEventIndex.isValid() && first <= m_lastReadEventIndex.row()) {
+            Q_EMIT dataChanged(m_lastReadEventIndex, m_lastReadEventIndex, {SpecialMarksRole});
+        }
+    };
+    connect(this, &MessageModel::rowsInserted, this, refreshReadMarker);
+    connect(this, &MessageModel::rowsRemoved, this, refreshReadMarker);
+    connect(this, &MessageModel::rowsAboutToBeRemoved, this, [this](const QModelIndex &, int first, int last) {
+        for (auto row = first; row <= last; ++row) {
+            if (const auto event = getEventForIndex(index(row))) {
+                invalidateRenderCache(event->get().id());
+            }
+        }
+    });
+
     connect(this, &MessageModel::newEventAdded, this, &MessageModel::createEventObjects);
 
     connect(this, &MessageModel::modelAboutToBeReset, this, [this]() {
         resetting = true;
+        clearRenderCache();
     });
     connect(this, &MessageModel::modelReset, this, [this]() {
         resetting = false;
@@ -38,6 +70,13 @@ MessageModel::MessageModel(QObject *parent)
         beginResetModel();
         endResetModel();
     });
+    connect(NeoChatConfig::self(), &NeoChatConfig::configChanged, this, &MessageModel::clearRenderCache);
+    connect(NeoChatConfig::self(), &NeoChatConfig::configChanged, m_visibleRows, &VisibleRowIndex::invalidate);
+    connect(NeoChatConfig::self(), &NeoChatConfig::ShowStateEventChanged, m_visibleRows, &VisibleRowIndex::invalidate);
+    connect(NeoChatConfig::self(), &NeoChatConfig::ShowLeaveJoinEventChanged, m_visibleRows, &VisibleRowIndex::invalidate);
+    connect(NeoChatConfig::self(), &NeoChatConfig::ShowRenameChanged, m_visibleRows, &VisibleRowIndex::invalidate);
+    connect(NeoChatConfig::self(), &NeoChatConfig::ShowAvatarUpdateChanged, m_visibleRows, &VisibleRowIndex::invalidate);
+    connect(NeoChatConfig::self(), &NeoChatConfig::ShowDeletedMessagesChanged, m_visibleRows, &VisibleRowIndex::invalidate);
 }
 
 NeoChatRoom *MessageModel::room() const
@@ -57,6 +96,16 @@ void MessageModel::setRoom(NeoChatRoom *room)
     m_room = room;
     if (m_room != nullptr) {
         m_room->setVisible(true);
+
+        connect(m_room, &Room::replacedEvent, this, [this](const RoomEvent *newEvent) {
+            invalidateRenderCache(newEvent->id());
+        });
+        connect(m_room, &Room::updatedEvent, this, &MessageModel::invalidateRenderCache);
+        // State event strings contain member display names so can't be trusted after a rename.
+        connect(m_room, &Room::memberNameUpdated, this, &MessageModel::clearRenderCache);
+        connect(m_room, &NeoChatRoom::cachedFileTransferInfoChanged, this, [this](const QString &eventId) {
+            refreshEventRoles(eventId, {ProgressInfoRole});
+        });
     }
     Q_EMIT roomChanged();
     endResetModel();
@@ -116,7 +165,9 @@ QVariant MessageModel::data(const QModelIndex &idx, int role) const
     }
 
     if (role == Qt::DisplayRole) {
-        return EventHandler::richBody(m_room, &event.value().get());
+        return cachedRoleData(event.value().get(), role, isPending, [this, &event]() {
+            return QVariant(EventHandler::richBody(m_room, &event.value().get()));
+        });
     }
 
     if (role == ContentModelRole) {
@@ -128,11 +179,15 @@ QVariant MessageModel::data(const QModelIndex &idx, int role) const
     }
 
     if (role == GenericDisplayRole) {
-        return EventHandler::genericBody(m_room, &event.value().get());
+        return cachedRoleData(event.value().get(), role, isPending, [this, &event]() {
+            return QVariant(EventHandler::genericBody(m_room, &event.value().get()));
+        });
     }
 
     if (role == DelegateTypeRole) {
-        return DelegateType::typeForEvent(event.value().get());
+        return cachedRoleData(event.value().get(), role, isPending, [&event]() {
+            return QVariant(DelegateType::typeForEvent(event.value().get()));
+        });
     }
 
     if (role == AuthorRole) {
@@ -212,7 +267,18 @@ QVariant MessageModel::data(const QModelIndex &idx, int role) const
     }
 
     if (role == SectionRole) {
-        return EventHandler::timeString(m_room, &event.value().get(), true, QLocale::ShortFormat, isPending);
+        // The section string is relative to the current day so must be refreshed
+        // once the day changes.
+        if (const auto today = QDate::currentDate(); today != m_renderCacheDate) {
+            const auto eventIds = m_renderCache.keys();
+            for (const auto &eventId : eventIds) {
+                m_renderCache.object(eventId)->remove(SectionRole);
+            }
+            m_renderCacheDate = today;
+        }
+        return cachedRoleData(event.value().get(), role, isPending, [this, &event, isPending]() {
+            return QVariant(EventHandler::timeString(m_room, &event.value().get(), true, QLocale::ShortFormat, isPending));
+        });
     }
 
     if (role == IsThreadedRole) {
@@ -231,19 +297,14 @@ QVariant MessageModel::data(const QModelIndex &idx, int role) const
     }
 
     if (role == ShowSectionRole) {
-        for (auto r = row + 1; r < rowCount(); ++r) {
-            auto i = index(r);
-            // Note !itemData(i).empty() is a check for instances where rows have been removed, e.g. when the read marker is moved.
-            // While the row is removed the subsequent row indexes are not changed so we need to skip over the removed index.
-            // See - https://doc.qt.io/qt-5/qabstractitemmodel.html#beginRemoveRows
-            if (data(i, SpecialMarksRole) != EventStatus::Hidden && !itemData(i).empty()) {
-                const auto day = data(idx, TimeRole).toDateTime().toLocalTime().date().dayOfYear();
-                const auto previousEventDay = data(i, TimeRole).toDateTime().toLocalTime().date().dayOfYear();
-                return day != previousEventDay;
-            }
+        const auto nextRow = m_visibleRows->nextVisibleRow(row);
+        // The index can be ahead of rowCount() while rows are being removed.
+        if (nextRow < 0 || nextRow >= rowCount()) {
+            return false;
         }
-
-        return false;
+        const auto day = data(idx, TimeRole).toDateTime().toLocalTime().date().dayOfYear();
+        const auto previousEventDay = data(index(nextRow), TimeRole).toDateTime().toLocalTime().date().dayOfYear();
+        return day != previousEventDay;
     }
 
     if (role == ReadMarkersRole) {
@@ -280,7 +341,9 @@ QVariant MessageModel::data(const QModelIndex &idx, int role) const
     }
 
     if (role == MediaInfoRole) {
-        return EventHandler::mediaInfo(m_room, &event.value().get());
+        return cachedRoleData(event.value().get(), role, isPending, [this, &event]() {
+            return QVariant(EventHandler::mediaInfo(m_room, &event.value().get()));
+        });
     }
 
     if (role == IsEditableRole) {
@@ -295,6 +358,62 @@ QVariant MessageModel::data(const QModelIndex &idx, int role) const
     return {};
 }
 
+QVariant MessageModel::cachedRoleData(const Quotient::RoomEvent &event, int role, bool isPending, const std::function<QVariant()> &calculate) const
+{
+    // Pending events can change their ID and content before they are merged so
+    // are always calculated.
+    if (isPending || event.id().isEmpty()) {
+        return calculate();
+    }
+
+    if (const auto eventCache = m_renderCache.object(event.id())) {
+        const auto it = eventCache->constFind(role);
+        if (it != eventCache->constEnd()) {
+            ++m_renderCacheHits;
+            return *it;
+        }
+    }
+
+    ++m_renderCacheMisses;
+    const auto value = calculate();
+    // Look the event up again, calculating may have reentered data() and evicted it.
+    auto eventCache = m_renderCache.object(event.id());
+    if (!eventCache) {
+        eventCache = new QHash<int, QVariant>;
+        m_renderCache.insert(event.id(), eventCache);
+    }
+    eventCache->insert(role, value);
+    return value;
+}
+
+void MessageModel::invalidateRenderCache(const QString &eventId)
+{
+    m_renderCache.remove(eventId);
+}
+
+void MessageModel::clearRenderCache()
+{
+    if (!m_renderCache.isEmpty()) {
+        qCDebug(Message) << "Clearing render cache of" << m_renderCache.size() << "events, hits:" << m_renderCacheHits << "misses:" << m_renderCacheMisses;
+    }
+    m_renderCache.clear();
+}
+
+qsizetype MessageModel::renderCacheSize() const
+{
+    return m_renderCache.size();
+}
+
+quint64 MessageModel::renderCacheHits() const
+{
+    return m_renderCacheHits;
+}
+
+quint64 MessageModel::renderCacheMisses() const
+{
+    return m_renderCacheMisses;
+}
+
 QHash<int, QByteArray> MessageModel::roleNames() const
 {
     QHash<int, QByteArray> roles = QAbstractItemModel::roleNames();
@@ -471,6 +590,8 @@ void MessageModel::clearEventObjects()
 bool MessageModel::event(QEvent *event)
 {
     if (event->type() == QEvent::ApplicationPaletteChange) {
+        // Rich text contains colors taken from the palette.
+        clearRenderCache();
         Q_EMIT dataChanged(index(0, 0), index(rowCount() - 1, 0), {AuthorRole, ReadMarkersRole});
     }
     return QObject::event(event);
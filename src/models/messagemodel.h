@@ -4,6 +4,7 @@
 #pragma once
 
 #include <QAbstractListModel>
+#include <QCache>
 #include <QQmlEngine>
 #include <functional>
 
@@ -13,6 +14,7 @@
 #include "threadmodel.h"
 
 class ReactionModel;
+class VisibleRowIndex;
 
 /**
  * @class MessageModel
@@ -117,6 +119,32 @@ public:
      */
     Q_INVOKABLE ThreadModel *threadModelForRootId(const QString &threadRootId) const;
 
+    /**
+     * @brief The maximum number of events whose role values are kept in the render cache.
+     *
+     * The least recently used event is evicted first.
+     */
+    static constexpr qsizetype MaxRenderCacheEvents = 1000;
+
+    /**
+     * @brief The number of events that currently have role values in the render cache.
+     */
+    [[nodiscard]] qsizetype renderCacheSize() const;
+
+    /**
+     * @brief The number of role requests served from the render cache.
+     *
+     * @sa renderCacheMisses()
+     */
+    [[nodiscard]] quint64 renderCacheHits() const;
+
+    /**
+     * @brief The number of role requests that had to be calculated and were then cached.
+     *
+     * @sa renderCacheHits()
+     */
+    [[nodiscard]] quint64 renderCacheMisses() const;
+
 Q_SIGNALS:
     /**
      * @brief Emitted when the room is changed.
@@ -146,6 +174,19 @@ protected:
     void clearModel();
     void clearEventObjects();
 
+    /**
+     * @brief Remove any cached role values for the given event ID.
+     *
+     * This must be called whenever an event changes in a way that would alter
+     * its rendered output, e.g. when it is edited or redacted.
+     */
+    void invalidateRenderCache(const QString &eventId);
+
+    /**
+     * @brief Remove all cached role values.
+     */
+    void clearRenderCache();
+
     bool event(QEvent *event) override;
 
 private:
@@ -154,5 +195,25 @@ private:
 
     QMap<QString, QSharedPointer<ReadMarkerModel>> m_readMarkerModels;
 
+    /**
+     * @brief The next row that isn't hidden for each row, used by ShowSectionRole.
+     */
+    VisibleRowIndex *m_visibleRows = nullptr;
+
+    /**
+     * @brief Cache of the expensive to derive role values, keyed by event ID.
+     *
+     * Only roles whose value depends solely on the event content, the room and the
+     * config are stored here, i.e. DisplayRole, GenericDisplayRole, DelegateTypeRole,
+     * SectionRole and MediaInfoRole. Pending events are never cached as they don't
+     * have a stable ID. An event's values are removed when its row is removed.
+     */
+    mutable QCache<QString, QHash<int, QVariant>> m_renderCache;
+    mutable quint64 m_renderCacheHits = 0;
+    mutable quint64 m_renderCacheMisses = 0;
+    mutable QDate m_renderCacheDate;
+
+    QVariant cachedRoleData(const Quotient::RoomEvent &event, int role, bool isPending, const std::function<QVariant()> &calculate) const;
+
     void createEventObjects(const Quotient::RoomEvent *event, bool isPending = false);
 };
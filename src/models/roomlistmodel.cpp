@@ -3,7 +3,6 @@
 
 #include "roomlistmodel.h"
 
-#include "eventhandler.h"
 #include "neochatconnection.h"
 #include "neochatroom.h"
 #include "roommanager.h"
@@ -128,10 +127,7 @@ void RoomListModel::connectRoomSignals(NeoChatRoom *room)
     connect(room, &Room::joinStateChanged, this, [this, room] {
         refresh(room);
     });
-    connect(room, &Room::addedMessages, this, [this, room] {
-        refresh(room, {SubtitleTextRole});
-    });
-    connect(room, &Room::pendingEventMerged, this, [this, room] {
+    connect(room, &NeoChatRoom::subtitleTextChanged, this, [this, room] {
         refresh(room, {SubtitleTextRole});
     });
 }
@@ -239,10 +235,7 @@ QVariant RoomListModel::data(const QModelIndex &index, int role) const
         return QVariant::fromValue(room);
     }
     if (role == SubtitleTextRole) {
-        if (room->lastEvent() == nullptr || room->lastEventIsSpoiler()) {
-            return QString();
-        }
-        return EventHandler::subtitleText(room, room->lastEvent());
+        return room->subtitleText();
     }
     if (role == AvatarImageRole) {
         return room->avatar(128);
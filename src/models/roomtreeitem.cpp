@@ -8,6 +8,7 @@ RoomTreeItem::RoomTreeItem(TreeData data, RoomTreeItem *parent)
     : m_parentItem(parent)
     , m_data(data)
 {
+    updateSortKeys();
 }
 
 bool RoomTreeItem::operator==(const RoomTreeItem &other) const
@@ -98,3 +99,16 @@ std::optional<int> RoomTreeItem::rowForRoom(Quotient::Room *room) const
 
     return std::nullopt;
 }
+
+const RoomSortParameter::SortKeys &RoomTreeItem::sortKeys() const
+{
+    return m_sortKeys;
+}
+
+void RoomTreeItem::updateSortKeys()
+{
+    if (!std::holds_alternative<NeoChatRoom *>(m_data)) {
+        return;
+    }
+    m_sortKeys = RoomSortParameter::SortKeys::forRoom(std::get<NeoChatRoom *>(m_data));
+}
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "enums/neochatroomtype.h"
+#include "enums/roomsortparameter.h"
 
 class NeoChatRoom;
 
@@ -70,9 +71,24 @@ public:
 
     std::optional<int> rowForRoom(Quotient::Room *room) const;
 
+    /**
+     * @brief The cached sort keys for this item's room.
+     *
+     * The keys are empty for category items.
+     *
+     * @sa RoomSortParameter::SortKeys
+     */
+    const RoomSortParameter::SortKeys &sortKeys() const;
+
+    /**
+     * @brief Recalculate the cached sort keys from the item's room.
+     */
+    void updateSortKeys();
+
 private:
     std::vector<std::unique_ptr<RoomTreeItem>> m_children;
     RoomTreeItem *m_parentItem;
 
     TreeData m_data;
+    RoomSortParameter::SortKeys m_sortKeys;
 };
@@ -3,9 +3,11 @@
 
 #include "roomtreemodel.h"
 
+#include <algorithm>
+#include <utility>
+
 #include <Quotient/room.h>
 
-#include "eventhandler.h"
 #include "neochatconnection.h"
 #include "neochatroomtype.h"
 #include "spacehierarchycache.h"
@@ -16,6 +18,9 @@ RoomTreeModel::RoomTreeModel(QObject *parent)
     : QAbstractItemModel(parent)
     , m_rootItem(new RoomTreeItem(nullptr))
 {
+    m_refreshTimer.setSingleShot(true);
+    m_refreshTimer.setInterval(0);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &RoomTreeModel::refreshQueuedRooms);
 }
 
 RoomTreeItem *RoomTreeModel::getItem(const QModelIndex &index) const
@@ -31,6 +36,9 @@ RoomTreeItem *RoomTreeModel::getItem(const QModelIndex &index) const
 
 void RoomTreeModel::resetModel()
 {
+    // The rooms may not be in the model any more.
+    m_queuedRefreshes.clear();
+
     if (m_connection == nullptr) {
         beginResetModel();
         m_rootItem.reset();
@@ -111,6 +119,7 @@ void RoomTreeModel::leftRoom(Room *r)
     beginRemoveRows(index.parent(), index.row(), index.row());
     parentItem->removeChild(index.row());
     room->disconnect(this);
+    m_queuedRefreshes.remove(room);
     endRemoveRows();
 }
 
@@ -175,15 +184,15 @@ void RoomTreeModel::connectRoomSignals(NeoChatRoom *room)
     connect(room, &Room::joinStateChanged, this, [this, room] {
         refreshRoomRoles(room);
     });
-    connect(room, &Room::addedMessages, this, [this, room] {
-        refreshRoomRoles(room, {SubtitleTextRole});
-    });
-    connect(room, &Room::pendingEventMerged, this, [this, room] {
-        refreshRoomRoles(room, {SubtitleTextRole});
+    connect(room, &NeoChatRoom::subtitleTextChanged, this, [this, room] {
+        queueRoomRefresh(room, {SubtitleTextRole});
     });
     connect(room, &NeoChatRoom::pushNotificationStateChanged, this, [this, room] {
         refreshRoomRoles(room, {ContextNotificationCountRole, HasHighlightNotificationsRole});
     });
+    connect(room, &NeoChatRoom::lastActiveTimeChanged, this, [this, room] {
+        queueRoomRefresh(room, {SubtitleTextRole});
+    });
 }
 
 void RoomTreeModel::refreshRoomRoles(NeoChatRoom *room, const QList<int> &roles)
@@ -193,9 +202,44 @@ void RoomTreeModel::refreshRoomRoles(NeoChatRoom *room, const QList<int> &roles)
         qCritical() << "Room" << room->id() << "not found in the room list";
         return;
     }
+
+    // Only refresh the sort keys when something they depend on may have changed.
+    static const QList<int> sortKeyRoles{DisplayNameRole, ContextNotificationCountRole, HasHighlightNotificationsRole, SubtitleTextRole};
+    if (roles.isEmpty() || std::any_of(roles.cbegin(), roles.cend(), [](int role) {
+            return sortKeyRoles.contains(role);
+        })) {
+        getItem(index)->updateSortKeys();
+    }
     Q_EMIT dataChanged(index, index, roles);
 }
 
+void RoomTreeModel::queueRoomRefresh(NeoChatRoom *room, const QList<int> &roles)
+{
+    auto &queuedRoles = m_queuedRefreshes[room];
+    for (const auto role : roles) {
+        if (!queuedRoles.contains(role)) {
+            queuedRoles += role;
+        }
+    }
+    m_refreshTimer.start();
+}
+
+void RoomTreeModel::refreshQueuedRooms()
+{
+    const auto queuedRefreshes = std::exchange(m_queuedRefreshes, {});
+    for (auto it = queuedRefreshes.cbegin(); it != queuedRefreshes.cend(); ++it) {
+        refreshRoomRoles(it.key(), it.value());
+    }
+}
+
+const RoomSortParameter::SortKeys *RoomTreeModel::sortKeys(const QModelIndex &index) const
+{
+    if (!index.isValid() || !index.parent().isValid()) {
+        return nullptr;
+    }
+    return &getItem(index)->sortKeys();
+}
+
 NeoChatConnection *RoomTreeModel::connection() const
 {
     return m_connection;
@@ -348,10 +392,7 @@ QVariant RoomTreeModel::data(const QModelIndex &index, int role) const
         return QVariant::fromValue(room);
     }
     if (role == SubtitleTextRole) {
-        if (room->lastEvent() == nullptr || room->lastEventIsSpoiler()) {
-            return QString();
-        }
-        return EventHandler::subtitleText(room, room->lastEvent());
+        return room->subtitleText();
     }
     if (role == AvatarImageRole) {
         return room->avatar(128);
@@ -4,7 +4,9 @@
 #pragma once
 
 #include <QAbstractItemModel>
+#include <QHash>
 #include <QPointer>
+#include <QTimer>
 
 #include "enums/neochatroomtype.h"
 #include "roomtreeitem.h"
@@ -77,6 +79,18 @@ public:
 
     Q_INVOKABLE QModelIndex indexForRoom(NeoChatRoom *room) const;
 
+    /**
+     * @brief The cached sort keys for the room at the given index.
+     *
+     * The keys are only recalculated when the room signals a change to one of
+     * the values they hold so this is cheap enough to call from a sort comparator.
+     *
+     * @return Nullptr if the index isn't for a room.
+     *
+     * @sa RoomSortParameter::SortKeys
+     */
+    const RoomSortParameter::SortKeys *sortKeys(const QModelIndex &index) const;
+
 Q_SIGNALS:
     void connectionChanged();
 
@@ -94,4 +108,16 @@ private:
     void moveRoom(Quotient::Room *room);
 
     void refreshRoomRoles(NeoChatRoom *room, const QList<int> &roles = {});
+
+    /**
+     * @brief Refresh the room's roles once control returns to the event loop.
+     *
+     * Refreshes queued for the same room in the meantime are merged, so signals
+     * that are emitted together, e.g. lastActiveTimeChanged() and subtitleTextChanged()
+     * when the last event changes, only update the row once.
+     */
+    void queueRoomRefresh(NeoChatRoom *room, const QList<int> &roles);
+    void refreshQueuedRooms();
+    QHash<NeoChatRoom *, QList<int>> m_queuedRefreshes;
+    QTimer m_refreshTimer;
 };
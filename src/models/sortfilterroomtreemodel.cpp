@@ -4,7 +4,6 @@
 
 #include "sortfilterroomtreemodel.h"
 
-#include "enums/roomsortparameter.h"
 #include "neochatconfig.h"
 #include "neochatconnection.h"
 #include "neochatroom.h"
@@ -24,6 +23,10 @@ SortFilterRoomTreeModel::SortFilterRoomTreeModel(RoomTreeModel *sourceModel, QOb
         setRoomSortOrder(static_cast<RoomSortOrder>(NeoChatConfig::sortOrder()));
         invalidateFilter();
     });
+    connect(NeoChatConfig::self(), &NeoChatConfig::CustomSortOrderChanged, this, [this]() {
+        m_sortParameters = RoomSortParameter::currentParameterList();
+        invalidate();
+    });
 
     setRecursiveFilteringEnabled(true);
     sort(0);
@@ -46,6 +49,7 @@ SortFilterRoomTreeModel::SortFilterRoomTreeModel(RoomTreeModel *sourceModel, QOb
 void SortFilterRoomTreeModel::setRoomSortOrder(SortFilterRoomTreeModel::RoomSortOrder sortOrder)
 {
     m_sortOrder = sortOrder;
+    m_sortParameters = RoomSortParameter::currentParameterList();
     invalidate();
 }
 
@@ -78,14 +82,14 @@ bool SortFilterRoomTreeModel::lessThan(const QModelIndex &source_left, const QMo
         return false;
     }
 
-    const auto leftRoom = dynamic_cast<NeoChatRoom *>(treeModel->connection()->room(source_left.data(RoomTreeModel::RoomIdRole).toString()));
-    const auto rightRoom = dynamic_cast<NeoChatRoom *>(treeModel->connection()->room(source_right.data(RoomTreeModel::RoomIdRole).toString()));
-    if (leftRoom == nullptr || rightRoom == nullptr) {
+    const auto leftKeys = treeModel->sortKeys(source_left);
+    const auto rightKeys = treeModel->sortKeys(source_right);
+    if (leftKeys == nullptr || rightKeys == nullptr) {
         return false;
     }
 
-    for (auto sortRole : RoomSortParameter::currentParameterList()) {
-        auto result = RoomSortParameter::compareParameter(sortRole, leftRoom, rightRoom);
+    for (auto sortRole : m_sortParameters) {
+        auto result = RoomSortParameter::compareParameter(sortRole, *leftKeys, *rightKeys);
 
         if (result != 0) {
             return result > 0;
@@ -152,8 +156,7 @@ bool SortFilterRoomTreeModel::filterAcceptsRow(int source_row, const QModelIndex
         }
         return false;
     } else {
-        const auto &rooms = SpaceHierarchyCache::instance().getRoomListForSpace(m_activeSpaceId, false);
-        return std::find(rooms.begin(), rooms.end(), sourceModel()->data(index, RoomTreeModel::RoomIdRole).toString()) != rooms.end() && acceptRoom;
+        return SpaceHierarchyCache::instance().isSpaceChild(m_activeSpaceId, sourceModel()->data(index, RoomTreeModel::RoomIdRole).toString()) && acceptRoom;
     }
 }
 
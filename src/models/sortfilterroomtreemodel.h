@@ -7,6 +7,8 @@
 #include <QQmlEngine>
 #include <QSortFilterProxyModel>
 
+#include "enums/roomsortparameter.h"
+
 class RoomTreeModel;
 
 /**
@@ -104,4 +106,7 @@ private:
     Mode m_mode = All;
     QString m_filterText;
     QString m_activeSpaceId;
+
+    // Cached copy of RoomSortParameter::currentParameterList() so the config isn't read on every comparison.
+    QList<RoomSortParameter::Parameter> m_sortParameters;
 };
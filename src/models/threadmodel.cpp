@@ -3,6 +3,8 @@
 
 #include "threadmodel.h"
 
+#include <QMetaMethod>
+
 #include <Quotient/events/event.h>
 #include <Quotient/events/stickerevent.h>
 #include <Quotient/jobs/basejob.h>
@@ -73,6 +75,11 @@ QString ThreadModel::threadRootId() const
     return m_threadRootId;
 }
 
+bool ThreadModel::isInUse() const
+{
+    return isSignalConnected(QMetaMethod::fromSignal(&QAbstractItemModel::dataChanged));
+}
+
 QHash<int, QByteArray> ThreadModel::roleNames() const
 {
     return MessageContentModel::roleNamesStatic();
@@ -149,18 +156,11 @@ void ThreadModel::addModels()
 
 void ThreadModel::clearModels()
 {
-    const auto room = dynamic_cast<NeoChatRoom *>(QObject::parent());
-    if (room == nullptr) {
-        return;
-    }
-    removeSourceModel(m_threadFetchModel);
-    for (const auto &model : m_events) {
-        const auto contentModel = room->contentModelForEvent(model);
-        if (sourceModels().contains(contentModel)) {
-            removeSourceModel(contentModel);
-        }
+    // Asking the room for the content models could recreate any that were evicted.
+    const auto models = sourceModels();
+    for (const auto &model : models) {
+        removeSourceModel(model);
     }
-    removeSourceModel(m_threadChatBarModel);
 }
 
 void ThreadModel::closeLinkPreview(int row)
@@ -160,6 +160,13 @@ public:
      */
     Q_INVOKABLE void closeLinkPreview(int row);
 
+    /**
+     * @brief Whether anything is currently using the model, e.g. a QML delegate.
+     *
+     * @sa MessageContentModel::isInUse()
+     */
+    [[nodiscard]] bool isInUse() const;
+
 Q_SIGNALS:
     void moreEventsAvailableChanged();
 
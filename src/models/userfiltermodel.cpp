@@ -11,6 +11,11 @@ bool UserFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceP
     if (!m_allowEmpty && m_filterText.length() < 1) {
         return false;
     }
+    // Use the member values UserListModel has already cached and folded.
+    if (const auto userListModel = qobject_cast<UserListModel *>(sourceModel())) {
+        const auto &member = userListModel->member(sourceRow);
+        return member.foldedName.contains(m_foldedFilterText) || member.foldedId.contains(m_foldedFilterText);
+    }
     return sourceModel()->data(sourceModel()->index(sourceRow, 0), UserListModel::DisplayNameRole).toString().contains(m_filterText, Qt::CaseInsensitive)
         || sourceModel()->data(sourceModel()->index(sourceRow, 0), UserListModel::UserIdRole).toString().contains(m_filterText, Qt::CaseInsensitive);
 }
@@ -23,6 +28,7 @@ QString UserFilterModel::filterText() const
 void UserFilterModel::setFilterText(const QString &filterText)
 {
     m_filterText = filterText;
+    m_foldedFilterText = filterText.toCaseFolded();
     Q_EMIT filterTextChanged();
     invalidateFilter();
 }
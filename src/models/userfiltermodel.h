@@ -46,5 +46,6 @@ Q_SIGNALS:
 
 private:
     QString m_filterText;
+    QString m_foldedFilterText;
     bool m_allowEmpty = false;
 };
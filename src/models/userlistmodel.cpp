@@ -5,6 +5,10 @@
 
 #include <QGuiApplication>
 
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
 #include <Quotient/avatar.h>
 #include <Quotient/events/roompowerlevelsevent.h>
 
@@ -13,10 +17,19 @@
 
 using namespace Quotient;
 
+namespace
+{
+// Above this many pending joins and leaves it is quicker to rebuild the whole list.
+constexpr int MaxIncrementalChanges = 100;
+}
+
 UserListModel::UserListModel(QObject *parent)
     : QAbstractListModel(parent)
     , m_currentRoom(nullptr)
 {
+    m_pendingTimer.setSingleShot(true);
+    m_pendingTimer.setInterval(0);
+    connect(&m_pendingTimer, &QTimer::timeout, this, &UserListModel::applyPendingMembers);
 }
 
 void UserListModel::setRoom(NeoChatRoom *room)
@@ -35,6 +48,8 @@ void UserListModel::setRoom(NeoChatRoom *room)
         m_members.clear();
         endResetModel();
     }
+    m_pendingMembers.clear();
+    m_pendingTimer.stop();
 
     m_currentRoom = room;
 
@@ -48,9 +63,12 @@ void UserListModel::setRoom(NeoChatRoom *room)
             refreshMember(member, {AvatarRole});
         });
         connect(m_currentRoom, &Room::memberListChanged, this, [this]() {
-            // this is slow
-            UserListModel::refreshAllMembers();
+            // The joins and leaves have been queued already, this only checks that
+            // none were missed once they are applied.
+            m_checkMemberCount = true;
+            m_pendingTimer.start();
         });
+        connect(m_currentRoom, &Room::changed, this, &UserListModel::refreshPowerLevels);
         connect(m_currentRoom->connection(), &Connection::loggedOut, this, [this]() {
             setRoom(nullptr);
         });
@@ -79,40 +97,33 @@ QVariant UserListModel::data(const QModelIndex &index, int role) const
                     "users.count()";
         return {};
     }
-    auto memberId = m_members.at(index.row());
+    const auto &member = m_members.at(index.row());
     if (role == DisplayNameRole) {
-        return m_currentRoom->member(memberId).disambiguatedName();
+        return member.displayName;
     }
     if (role == UserIdRole) {
-        return memberId;
+        return member.id;
     }
     if (role == AvatarRole) {
-        return m_currentRoom->member(memberId).avatarUrl();
+        return member.avatar;
     }
     if (role == ObjectRole) {
-        return QVariant::fromValue(memberId);
+        return QVariant::fromValue(member.id);
     }
     if (role == PowerLevelRole) {
-        auto plEvent = m_currentRoom->currentState().get<RoomPowerLevelsEvent>();
-        if (!plEvent) {
-            return 0;
-        }
-        return plEvent->powerLevelForUser(memberId);
+        return member.powerLevel;
     }
     if (role == PowerLevelStringRole) {
-        auto pl = m_currentRoom->currentState().get<RoomPowerLevelsEvent>();
-        // User might not in the room yet, in this case pl can be nullptr.
+        // User might not in the room yet, in this case there are no power levels.
         // e.g. When invited but user not accepted or denied the invitation.
-        if (!pl) {
+        if (!m_hasPowerLevels) {
             return u"Not Available"_s;
         }
 
-        auto userPl = pl->powerLevelForUser(memberId);
-
         return i18nc("%1 is the name of the power level, e.g. admin and %2 is the value that represents.",
                      "%1 (%2)",
-                     PowerLevel::nameForLevel(PowerLevel::levelForValue(userPl)),
-                     userPl);
+                     PowerLevel::nameForLevel(PowerLevel::levelForValue(member.powerLevel)),
+                     member.powerLevel);
     }
 
     return {};
@@ -126,6 +137,11 @@ int UserListModel::rowCount(const QModelIndex &parent) const
     return m_members.count();
 }
 
+const UserListModel::Member &UserListModel::member(int row) const
+{
+    return m_members.at(row);
+}
+
 bool UserListModel::event(QEvent *event)
 {
     if (event->type() == QEvent::ApplicationPaletteChange) {
@@ -136,71 +152,220 @@ bool UserListModel::event(QEvent *event)
 
 void UserListModel::memberJoined(const Quotient::RoomMember &member)
 {
-    auto pos = findUserPos(member);
-    beginInsertRows(QModelIndex(), pos, pos);
-    m_members.insert(pos, member.id());
-    endInsertRows();
+    m_pendingMembers.insert(member.id(), true);
+    m_pendingTimer.start();
 }
 
 void UserListModel::memberLeft(const Quotient::RoomMember &member)
 {
-    auto pos = findUserPos(member);
-    if (pos != m_members.size()) {
-        beginRemoveRows(QModelIndex(), pos, pos);
-        m_members.removeAt(pos);
-        endRemoveRows();
-    } else {
-        qWarning() << "Trying to remove a room member not in the user list";
+    m_pendingMembers.insert(member.id(), false);
+    m_pendingTimer.start();
+}
+
+void UserListModel::applyPendingMembers()
+{
+    if (!m_active || !m_currentRoom) {
+        m_pendingMembers.clear();
+        m_checkMemberCount = false;
+        return;
+    }
+    if (m_pendingMembers.size() > MaxIncrementalChanges) {
+        refreshAllMembers();
+        return;
+    }
+    const auto checkMemberCount = std::exchange(m_checkMemberCount, false);
+
+    const auto pendingMembers = std::exchange(m_pendingMembers, {});
+    for (auto it = pendingMembers.constBegin(); it != pendingMembers.constEnd(); ++it) {
+        const auto pos = findUserPos(it.key());
+        const auto inList = pos != m_members.size();
+        if (it.value() && !inList) {
+            auto member = makeMember(it.key());
+            const auto insertPos = insertPosition(member);
+            beginInsertRows(QModelIndex(), insertPos, insertPos);
+            m_members.insert(insertPos, std::move(member));
+            endInsertRows();
+        } else if (!it.value() && inList) {
+            beginRemoveRows(QModelIndex(), pos, pos);
+            m_members.removeAt(pos);
+            endRemoveRows();
+        }
+    }
+
+    if (checkMemberCount && m_members.size() != m_currentRoom->joinedMemberIds().size()) {
+        refreshAllMembers();
     }
 }
 
 void UserListModel::refreshMember(const Quotient::RoomMember &member, const QList<int> &roles)
 {
-    auto pos = findUserPos(member);
-    if (pos != m_members.size()) {
-        // The update will have changed the state event so we need to insert the updated member object.
-        m_members.insert(pos, member.id());
-        Q_EMIT dataChanged(index(pos), index(pos), roles);
-    } else {
-        qWarning() << "Trying to access a room member not in the user list";
+    auto pos = findUserPos(member.id());
+    if (pos == m_members.size()) {
+        // Either not loaded yet or waiting in m_pendingMembers.
+        return;
+    }
+
+    auto updated = makeMember(member.id());
+    // A new name may move the member, find where it goes with it taken out of the list.
+    auto current = m_members.takeAt(pos);
+    const auto newPos = insertPosition(updated);
+    m_members.insert(pos, std::move(current));
+    if (newPos != pos) {
+        // The destination is given in terms of the list before the move.
+        beginMoveRows(QModelIndex(), pos, pos, QModelIndex(), newPos > pos ? newPos + 1 : newPos);
+        m_members.move(pos, newPos);
+        endMoveRows();
+        pos = newPos;
     }
+    m_members[pos] = std::move(updated);
+    Q_EMIT dataChanged(index(pos), index(pos), roles);
 }
 
 void UserListModel::refreshAllMembers()
 {
     beginResetModel();
 
+    m_members.clear();
+    m_pendingMembers.clear();
+    m_checkMemberCount = false;
+    m_pendingTimer.stop();
     if (m_currentRoom != nullptr) {
-        m_members = m_currentRoom->joinedMemberIds();
-        MemberSorter sorter;
-        std::sort(m_members.begin(), m_members.end(), [&sorter, this](const auto &left, const auto &right) {
-            const auto leftPl = m_currentRoom->memberEffectivePowerLevel(left);
-            const auto rightPl = m_currentRoom->memberEffectivePowerLevel(right);
-            if (leftPl > rightPl) {
-                return true;
-            } else if (rightPl > leftPl) {
-                return false;
-            }
-
-            return sorter(m_currentRoom->member(left), m_currentRoom->member(right));
-        });
+        const auto plEvent = m_currentRoom->currentState().get<RoomPowerLevelsEvent>();
+        m_hasPowerLevels = plEvent != nullptr;
+        m_powerLevelsEventId = plEvent ? plEvent->id() : QString();
+
+        const auto memberIds = m_currentRoom->joinedMemberIds();
+        m_members.reserve(memberIds.size());
+        for (const auto &memberId : memberIds) {
+            m_members.append(makeMember(memberId));
+        }
+        sortMembers(m_members);
     }
     endResetModel();
     Q_EMIT usersRefreshed();
 }
 
-int UserListModel::findUserPos(const RoomMember &member) const
+void UserListModel::refreshPowerLevels()
+{
+    if (!m_active || !m_currentRoom) {
+        return;
+    }
+    const auto plEvent = m_currentRoom->currentState().get<RoomPowerLevelsEvent>();
+    const auto eventId = plEvent ? plEvent->id() : QString();
+    if (m_hasPowerLevels == (plEvent != nullptr) && m_powerLevelsEventId == eventId) {
+        return;
+    }
+    m_hasPowerLevels = plEvent != nullptr;
+    m_powerLevelsEventId = eventId;
+
+    bool orderChanged = false;
+    for (auto &member : m_members) {
+        const auto previous = member.effectivePowerLevel;
+        updatePowerLevel(member);
+        orderChanged |= member.effectivePowerLevel != previous;
+    }
+
+    if (orderChanged) {
+        Q_EMIT layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+        const auto oldMembers = m_members;
+        sortMembers(m_members);
+        QHash<QString, int> newRows;
+        newRows.reserve(m_members.size());
+        for (int row = 0; row < m_members.size(); ++row) {
+            newRows.insert(m_members[row].id, row);
+        }
+        const auto persistentIndexes = persistentIndexList();
+        QModelIndexList newIndexes;
+        newIndexes.reserve(persistentIndexes.size());
+        for (const auto &persistentIndex : persistentIndexes) {
+            newIndexes += index(newRows.value(oldMembers[persistentIndex.row()].id));
+        }
+        changePersistentIndexList(persistentIndexes, newIndexes);
+        Q_EMIT layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+    }
+    if (!m_members.isEmpty()) {
+        Q_EMIT dataChanged(index(0), index(m_members.size() - 1), {PowerLevelRole, PowerLevelStringRole});
+    }
+}
+
+UserListModel::Member UserListModel::makeMember(const QString &memberId) const
 {
-    return findUserPos(member.id());
+    const auto roomMember = m_currentRoom->member(memberId);
+    Member member{
+        .id = memberId,
+        .displayName = roomMember.disambiguatedName(),
+        .avatar = roomMember.avatarUrl(),
+    };
+    auto name = roomMember.displayName();
+    member.sortName = name.startsWith(u'@') ? name.sliced(1) : name;
+    member.foldedName = member.displayName.toCaseFolded();
+    member.foldedId = memberId.toCaseFolded();
+    updatePowerLevel(member);
+    return member;
 }
 
-int UserListModel::findUserPos(const QString &userId) const
+void UserListModel::updatePowerLevel(Member &member) const
 {
-    if (!m_currentRoom) {
-        return 0;
+    const auto plEvent = m_currentRoom->currentState().get<RoomPowerLevelsEvent>();
+    member.powerLevel = plEvent ? plEvent->powerLevelForUser(member.id) : 0;
+    member.effectivePowerLevel = m_currentRoom->memberEffectivePowerLevel(member.id);
+}
+
+bool UserListModel::lessThan(const Member &left, const Member &right) const
+{
+    if (left.effectivePowerLevel != right.effectivePowerLevel) {
+        return left.effectivePowerLevel > right.effectivePowerLevel;
     }
-    const auto pos = std::find_if(m_members.cbegin(), m_members.cend(), [&userId](const QString &memberId) {
-        return userId == memberId;
+    if (const auto result = m_collator.compare(left.sortName, right.sortName); result != 0) {
+        return result < 0;
+    }
+    return left.id < right.id;
+}
+
+void UserListModel::sortMembers(QList<Member> &members) const
+{
+    // Compare precomputed collation keys rather than collating the names for
+    // every comparison.
+    std::vector<QCollatorSortKey> keys;
+    keys.reserve(members.size());
+    for (const auto &member : std::as_const(members)) {
+        keys.push_back(m_collator.sortKey(member.sortName));
+    }
+    std::vector<int> order(members.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&members, &keys](int left, int right) {
+        if (members[left].effectivePowerLevel != members[right].effectivePowerLevel) {
+            return members[left].effectivePowerLevel > members[right].effectivePowerLevel;
+        }
+        if (const auto result = keys[left].compare(keys[right]); result != 0) {
+            return result < 0;
+        }
+        return members[left].id < members[right].id;
+    });
+
+    QList<Member> sorted;
+    sorted.reserve(members.size());
+    for (const auto i : order) {
+        sorted.append(std::move(members[i]));
+    }
+    members = std::move(sorted);
+}
+
+int UserListModel::insertPosition(const Member &member) const
+{
+    return std::lower_bound(m_members.cbegin(),
+                            m_members.cend(),
+                            member,
+                            [this](const Member &left, const Member &right) {
+                                return lessThan(left, right);
+                            })
+        - m_members.cbegin();
+}
+
+int UserListModel::findUserPos(const QString &userId) const
+{
+    const auto pos = std::find_if(m_members.cbegin(), m_members.cend(), [&userId](const Member &member) {
+        return userId == member.id;
     });
     return pos - m_members.cbegin();
 }
@@ -6,9 +6,13 @@
 #include <Quotient/room.h>
 
 #include <QAbstractListModel>
+#include <QCollator>
+#include <QHash>
 #include <QObject>
 #include <QPointer>
 #include <QQmlEngine>
+#include <QTimer>
+#include <QUrl>
 
 class NeoChatRoom;
 
@@ -23,7 +27,13 @@ class User;
  * This class defines the model for listing the users in a room.
  *
  * As well as gathering all the users from a room, the model ensures that they are
- * sorted in alphabetical order.
+ * sorted by power level and then in alphabetical order.
+ *
+ * The values shown for each member are cached when the member is added and kept up
+ * to date by the room's member and power level changes, so reading the model
+ * doesn't look anything up in the room state. The members are sorted once when
+ * the model is activated and after that joins, leaves and renames are placed
+ * individually.
  *
  * @sa NeoChatRoom
  */
@@ -51,6 +61,20 @@ public:
     };
     Q_ENUM(EventRoles)
 
+    /**
+     * @brief The cached values for a room member.
+     */
+    struct Member {
+        QString id;
+        QString displayName; /**< The disambiguated name of the member. */
+        QUrl avatar;
+        int powerLevel = 0; /**< The power level from the power levels event, 0 if there isn't one. */
+        int effectivePowerLevel = 0; /**< The power level used for sorting, see Room::memberEffectivePowerLevel(). */
+        QString sortName; /**< The display name without any leading @. */
+        QString foldedName; /**< The case folded display name, for filtering. */
+        QString foldedId; /**< The case folded ID, for filtering. */
+    };
+
     explicit UserListModel(QObject *parent = nullptr);
 
     [[nodiscard]] NeoChatRoom *room() const;
@@ -79,6 +103,13 @@ public:
 
     void activate();
 
+    /**
+     * @brief The cached values for the member at the given row.
+     *
+     * This lets filter models match rows without going through data().
+     */
+    [[nodiscard]] const Member &member(int row) const;
+
 Q_SIGNALS:
     void roomChanged();
     void usersRefreshed();
@@ -91,13 +122,30 @@ private Q_SLOTS:
     void memberLeft(const Quotient::RoomMember &member);
     void refreshMember(const Quotient::RoomMember &member, const QList<int> &roles = {});
     void refreshAllMembers();
+    void refreshPowerLevels();
 
 private:
     QPointer<NeoChatRoom> m_currentRoom;
-    QList<QString> m_members;
+    QList<Member> m_members;
+    QCollator m_collator;
+
+    // The ID of the power levels event the cached power levels were read from.
+    QString m_powerLevelsEventId;
+    bool m_hasPowerLevels = false;
+
+    // Joins and leaves are applied in batches so that loading the member list
+    // doesn't insert the members one at a time, true for a join.
+    QHash<QString, bool> m_pendingMembers;
+    bool m_checkMemberCount = false;
+    QTimer m_pendingTimer;
+    void applyPendingMembers();
 
     bool m_active = false;
 
-    int findUserPos(const Quotient::RoomMember &member) const;
-    [[nodiscard]] int findUserPos(const QString &username) const;
+    [[nodiscard]] Member makeMember(const QString &memberId) const;
+    void updatePowerLevel(Member &member) const;
+    [[nodiscard]] bool lessThan(const Member &left, const Member &right) const;
+    void sortMembers(QList<Member> &members) const;
+    [[nodiscard]] int insertPosition(const Member &member) const;
+    [[nodiscard]] int findUserPos(const QString &userId) const;
 };
@@ -0,0 +1,163 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "visiblerowindex.h"
+
+#include <algorithm>
+
+VisibleRowIndex::VisibleRowIndex(QAbstractItemModel *model, Predicate isVisible, const QList<int> &roles, QObject *parent)
+    : QObject(parent)
+    , m_model(model)
+    , m_isVisible(std::move(isVisible))
+    , m_roles(roles)
+{
+    Q_ASSERT(m_model);
+    Q_ASSERT(m_isVisible);
+
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex &parent, int first, int last) {
+        if (!parent.isValid()) {
+            rowsInserted(first, last);
+        }
+    });
+    connect(m_model, &QAbstractItemModel::rowsRemoved, this, [this](const QModelIndex &parent, int first, int last) {
+        if (!parent.isValid()) {
+            rowsRemoved(first, last);
+        }
+    });
+    connect(m_model, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles) {
+        rowsChanged(topLeft.row(), bottomRight.row(), roles);
+    });
+    connect(m_model, &QAbstractItemModel::rowsMoved, this, &VisibleRowIndex::invalidate);
+    connect(m_model, &QAbstractItemModel::layoutChanged, this, &VisibleRowIndex::invalidate);
+    connect(m_model, &QAbstractItemModel::modelReset, this, &VisibleRowIndex::invalidate);
+}
+
+int VisibleRowIndex::nextVisibleRow(int row)
+{
+    if (m_dirty) {
+        rebuild();
+    }
+    if (row < 0 || row >= m_distance.size()) {
+        return -1;
+    }
+    const auto distance = m_distance[row];
+    return distance > 0 ? row + distance : -1;
+}
+
+void VisibleRowIndex::invalidate()
+{
+    m_dirty = true;
+    m_visible.clear();
+    m_distance.clear();
+}
+
+void VisibleRowIndex::rebuild()
+{
+    m_dirty = false;
+    if (!m_model) {
+        m_visible.clear();
+        m_distance.clear();
+        return;
+    }
+
+    const auto rowCount = m_model->rowCount();
+    m_visible.resize(rowCount);
+    m_distance.resize(rowCount);
+    for (int row = 0; row < rowCount; ++row) {
+        m_visible[row] = m_isVisible(row);
+    }
+    for (int row = rowCount - 1; row >= 0; --row) {
+        m_distance[row] = distanceFor(row);
+    }
+}
+
+void VisibleRowIndex::rowsInserted(int first, int last)
+{
+    if (m_dirty) {
+        return;
+    }
+    if (first > m_visible.size()) {
+        invalidate();
+        return;
+    }
+
+    const auto count = last - first + 1;
+    m_visible.insert(first, count, false);
+    m_distance.insert(first, count, 0);
+    for (int row = first; row <= last; ++row) {
+        m_visible[row] = m_isVisible(row);
+    }
+    recalculate(last, first);
+}
+
+void VisibleRowIndex::rowsRemoved(int first, int last)
+{
+    if (m_dirty) {
+        return;
+    }
+    if (last >= m_visible.size()) {
+        invalidate();
+        return;
+    }
+
+    const auto count = last - first + 1;
+    m_visible.remove(first, count);
+    m_distance.remove(first, count);
+    recalculate(first - 1, first);
+}
+
+void VisibleRowIndex::rowsChanged(int first, int last, const QList<int> &roles)
+{
+    if (m_dirty) {
+        return;
+    }
+    if (!roles.isEmpty() && !m_roles.isEmpty()
+        && std::none_of(m_roles.cbegin(), m_roles.cend(), [&roles](int role) {
+               return roles.contains(role);
+           })) {
+        return;
+    }
+    if (first < 0 || last >= m_visible.size()) {
+        invalidate();
+        return;
+    }
+
+    bool changed = false;
+    for (int row = first; row <= last; ++row) {
+        const auto visible = m_isVisible(row);
+        if (visible != m_visible[row]) {
+            m_visible[row] = visible;
+            changed = true;
+        }
+    }
+    if (changed) {
+        // A row's distance depends on the visibility of the rows after it so the
+        // first row that can be affected is the one before the last changed.
+        recalculate(last - 1, first - 1);
+    }
+}
+
+void VisibleRowIndex::recalculate(int from, int stopBelow)
+{
+    for (int row = std::min(from, int(m_distance.size()) - 1); row >= 0; --row) {
+        const auto distance = distanceFor(row);
+        if (row < stopBelow && distance == m_distance[row]) {
+            return;
+        }
+        m_distance[row] = distance;
+    }
+}
+
+int VisibleRowIndex::distanceFor(int row) const
+{
+    if (row + 1 >= m_visible.size()) {
+        return 0;
+    }
+    if (m_visible[row + 1]) {
+        return 1;
+    }
+    const auto nextDistance = m_distance[row + 1];
+    return nextDistance > 0 ? nextDistance + 1 : 0;
+}
+
+#include "moc_visiblerowindex.cpp"
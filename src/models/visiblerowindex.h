@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+
+#include <functional>
+
+/**
+ * @class VisibleRowIndex
+ *
+ * This class keeps track of the next visible row for every row of a list model.
+ *
+ * Whether a row is visible is decided by the predicate given on construction. The
+ * predicate is evaluated once per row and then only again for rows that are inserted
+ * or changed, so that finding the next visible neighbour of a row is O(1) no matter
+ * how long the run of hidden rows in between is.
+ *
+ * The index follows the given model's rowsInserted, rowsRemoved and dataChanged
+ * signals and updates itself incrementally. Any other structural change (reset,
+ * layout change or move) causes a full rebuild the next time the index is queried.
+ *
+ * @note The connections to the model are made on construction so if the index
+ *       needs to be up to date before another object handles the model's signals it
+ *       must be created first.
+ */
+class VisibleRowIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Function that returns whether the given row of the model is visible.
+     */
+    using Predicate = std::function<bool(int row)>;
+
+    /**
+     * @brief Create an index for the given model.
+     *
+     * @param model the model to track.
+     * @param isVisible the predicate that decides whether a row is visible.
+     * @param roles the roles that the predicate depends upon. A dataChanged signal
+     *        that doesn't include one of these roles is ignored. If empty all
+     *        dataChanged signals are handled.
+     */
+    explicit VisibleRowIndex(QAbstractItemModel *model, Predicate isVisible, const QList<int> &roles = {}, QObject *parent = nullptr);
+
+    /**
+     * @brief The next visible row after the given row, -1 if there is none.
+     */
+    [[nodiscard]] int nextVisibleRow(int row);
+
+    /**
+     * @brief Force the index to be rebuilt the next time it is queried.
+     *
+     * This should be called when something that the predicate depends upon changes
+     * without the model emitting a signal, e.g. a config value.
+     */
+    void invalidate();
+
+private:
+    QPointer<QAbstractItemModel> m_model;
+    Predicate m_isVisible;
+    QList<int> m_roles;
+
+    bool m_dirty = true;
+    QList<bool> m_visible;
+    // The distance to the next visible row, 0 if there is none.
+    QList<int> m_distance;
+
+    void rebuild();
+    void rowsInserted(int first, int last);
+    void rowsRemoved(int first, int last);
+    void rowsChanged(int first, int last, const QList<int> &roles);
+
+    /**
+     * @brief Recalculate the distances from the given row backwards to the start.
+     *
+     * Once a row below stopBelow is reached the calculation finishes as soon as a
+     * row's distance is unchanged, as all rows before it must then also be unchanged.
+     */
+    void recalculate(int from, int stopBelow);
+    [[nodiscard]] int distanceFor(int row) const;
+};
@@ -3,8 +3,10 @@
 
 #include "neochatconnection.h"
 
+#include <QCryptographicHash>
 #include <QImageReader>
 #include <QJsonDocument>
+#include <QStandardPaths>
 
 #include "neochatconfig.h"
 #include "neochatroom.h"
@@ -79,51 +81,27 @@ void NeoChatConnection::connectSignals()
     });
     connect(this, &NeoChatConnection::directChatsListChanged, this, [this](DirectChatsMap additions, DirectChatsMap removals) {
         Q_EMIT directChatInvitesChanged();
-        for (const auto &chatId : additions) {
-            if (const auto chat = room(chatId)) {
-                connect(chat, &Room::unreadStatsChanged, this, [this]() {
-                    refreshBadgeNotificationCount();
-                    Q_EMIT directChatNotificationsChanged();
-                    Q_EMIT directChatsHaveHighlightNotificationsChanged();
-                });
-            }
-        }
-        for (const auto &chatId : removals) {
-            if (const auto chat = room(chatId)) {
-                disconnect(chat, &Room::unreadStatsChanged, this, nullptr);
+        for (const auto &chats : {additions, removals}) {
+            for (const auto &chatId : chats) {
+                if (const auto chat = room(chatId, JoinState::Join)) {
+                    updateRoomNotifications(chat, true);
+                }
+                if (const auto chat = room(chatId, JoinState::Invite)) {
+                    updateRoomNotifications(chat, true);
+                }
             }
         }
     });
-    connect(this, &NeoChatConnection::joinedRoom, this, [this](Room *room) {
-        if (room->isDirectChat()) {
-            connect(room, &Room::unreadStatsChanged, this, [this]() {
-                Q_EMIT directChatNotificationsChanged();
-                Q_EMIT directChatsHaveHighlightNotificationsChanged();
-            });
-        }
-        connect(room, &Room::unreadStatsChanged, this, [this]() {
-            refreshBadgeNotificationCount();
-            Q_EMIT homeNotificationsChanged();
-            Q_EMIT homeHaveHighlightNotificationsChanged();
-        });
-    });
+    connect(this, &NeoChatConnection::newRoom, this, &NeoChatConnection::trackRoomNotifications);
+    connect(this, &NeoChatConnection::aboutToDeleteRoom, this, &NeoChatConnection::untrackRoomNotifications);
     connect(this, &NeoChatConnection::leftRoom, this, [this](Room *room, Room *prev) {
         Q_UNUSED(room)
         if (prev && prev->isDirectChat()) {
             Q_EMIT directChatInvitesChanged();
-            Q_EMIT directChatNotificationsChanged();
-            Q_EMIT directChatsHaveHighlightNotificationsChanged();
         }
-        refreshBadgeNotificationCount();
-        Q_EMIT homeNotificationsChanged();
-        Q_EMIT homeHaveHighlightNotificationsChanged();
     });
 
-    connect(&SpaceHierarchyCache::instance(), &SpaceHierarchyCache::spaceHierarchyChanged, this, [this]() {
-        refreshBadgeNotificationCount();
-        Q_EMIT homeNotificationsChanged();
-        Q_EMIT homeHaveHighlightNotificationsChanged();
-    });
+    connect(&SpaceHierarchyCache::instance(), &SpaceHierarchyCache::spaceChildrenChanged, this, &NeoChatConnection::updateRoomPlacements);
 
     // Fetch unstable features
     // TODO: Expose unstableFeatures() in libQuotient
@@ -152,17 +130,154 @@ int NeoChatConnection::badgeNotificationCount() const
     return m_badgeNotificationCount;
 }
 
-void NeoChatConnection::refreshBadgeNotificationCount()
+void NeoChatConnection::trackRoomNotifications(Room *room)
+{
+    const auto update = [this, room]() {
+        updateRoomNotifications(room);
+    };
+    connect(room, &Room::unreadStatsChanged, this, update);
+    connect(room, &Room::tagsChanged, this, update);
+    connect(room, &Room::joinStateChanged, this, update);
+    connect(static_cast<NeoChatRoom *>(room), &NeoChatRoom::pushNotificationStateChanged, this, update);
+    connect(room, &Room::baseStateLoaded, this, [this, room]() {
+        updateRoomNotifications(room, true);
+    });
+
+    m_roomNotifications.insert(room, {});
+    updateRoomNotifications(room, true);
+}
+
+void NeoChatConnection::untrackRoomNotifications(Room *room)
+{
+    const auto it = m_roomNotifications.constFind(room);
+    if (it == m_roomNotifications.constEnd()) {
+        return;
+    }
+    const auto previous = notificationTotals();
+    const auto spaces = it->spaces;
+    addRoomNotifications(*it, -1);
+    m_roomNotifications.erase(it);
+    emitNotificationChanges(previous);
+    if (!spaces.isEmpty()) {
+        Q_EMIT spaceNotificationsChanged(spaces);
+    }
+}
+
+NeoChatConnection::RoomNotifications NeoChatConnection::roomNotifications(Room *room, bool updatePlacement) const
+{
+    const auto neoChatRoom = static_cast<NeoChatRoom *>(room);
+    auto notifications = m_roomNotifications.value(room);
+    notifications.notifications = neoChatRoom->contextAwareNotificationCount();
+    notifications.highlight = neoChatRoom->highlightCount() > 0;
+    if (updatePlacement) {
+        notifications.direct = room->isDirectChat();
+        notifications.spaces = SpaceHierarchyCache::instance().parentSpaces(room->id());
+        notifications.home = !notifications.direct && notifications.spaces.isEmpty();
+    }
+    return notifications;
+}
+
+void NeoChatConnection::updateRoomNotifications(Room *room, bool updatePlacement)
+{
+    const auto previous = notificationTotals();
+    QSet<QString> spaces;
+    replaceRoomNotifications(room, updatePlacement, spaces);
+    emitNotificationChanges(previous);
+    if (!spaces.isEmpty()) {
+        Q_EMIT spaceNotificationsChanged(spaces.values());
+    }
+}
+
+void NeoChatConnection::updateRoomPlacements(const QStringList &roomIds)
+{
+    const auto previous = notificationTotals();
+    QSet<QString> spaces;
+    for (const auto &roomId : roomIds) {
+        // Invites are separate room objects.
+        if (const auto joinedRoom = room(roomId, JoinState::Join)) {
+            replaceRoomNotifications(joinedRoom, true, spaces);
+        }
+        if (const auto invitedRoom = room(roomId, JoinState::Invite)) {
+            replaceRoomNotifications(invitedRoom, true, spaces);
+        }
+    }
+    emitNotificationChanges(previous);
+    if (!spaces.isEmpty()) {
+        Q_EMIT spaceNotificationsChanged(spaces.values());
+    }
+}
+
+void NeoChatConnection::replaceRoomNotifications(Room *room, bool updatePlacement, QSet<QString> &changedSpaces)
+{
+    const auto it = m_roomNotifications.find(room);
+    if (it == m_roomNotifications.end()) {
+        return;
+    }
+    const auto updated = roomNotifications(room, updatePlacement);
+    if (updated == *it) {
+        return;
+    }
+
+    for (const auto &space : std::as_const(it->spaces)) {
+        changedSpaces.insert(space);
+    }
+    for (const auto &space : updated.spaces) {
+        changedSpaces.insert(space);
+    }
+    addRoomNotifications(*it, -1);
+    *it = updated;
+    addRoomNotifications(*it, 1);
+}
+
+void NeoChatConnection::addRoomNotifications(const RoomNotifications &notifications, int sign)
 {
-    int count = 0;
-    for (const auto &r : allRooms()) {
-        if (const auto room = static_cast<NeoChatRoom *>(r)) {
-            count += room->contextAwareNotificationCount();
+    const auto highlight = notifications.highlight ? sign : 0;
+    m_totalNotifications += sign * notifications.notifications;
+    if (notifications.direct) {
+        m_directChatNotifications += sign * notifications.notifications;
+        m_directChatHighlights += highlight;
+    }
+    if (notifications.home) {
+        m_homeNotifications += sign * notifications.notifications;
+        m_homeHighlights += highlight;
+    }
+    for (const auto &space : notifications.spaces) {
+        if ((m_spaceNotifications[space] += sign * notifications.notifications) == 0) {
+            m_spaceNotifications.remove(space);
+        }
+        if ((m_spaceHighlights[space] += highlight) == 0) {
+            m_spaceHighlights.remove(space);
         }
     }
+}
 
-    if (count != m_badgeNotificationCount) {
-        m_badgeNotificationCount = count;
+NeoChatConnection::NotificationTotals NeoChatConnection::notificationTotals() const
+{
+    return {
+        .directChatNotifications = m_directChatNotifications,
+        .directChatsHaveHighlights = m_directChatHighlights > 0,
+        .homeNotifications = m_homeNotifications,
+        .homeHaveHighlights = m_homeHighlights > 0,
+    };
+}
+
+void NeoChatConnection::emitNotificationChanges(const NotificationTotals &previous)
+{
+    const auto current = notificationTotals();
+    if (current.directChatNotifications != previous.directChatNotifications) {
+        Q_EMIT directChatNotificationsChanged();
+    }
+    if (current.directChatsHaveHighlights != previous.directChatsHaveHighlights) {
+        Q_EMIT directChatsHaveHighlightNotificationsChanged();
+    }
+    if (current.homeNotifications != previous.homeNotifications) {
+        Q_EMIT homeNotificationsChanged();
+    }
+    if (current.homeHaveHighlights != previous.homeHaveHighlights) {
+        Q_EMIT homeHaveHighlightNotificationsChanged();
+    }
+    if (int(m_totalNotifications) != m_badgeNotificationCount) {
+        m_badgeNotificationCount = int(m_totalNotifications);
         Q_EMIT badgeNotificationCountChanged(this, m_badgeNotificationCount);
     }
 }
@@ -170,6 +285,8 @@ void NeoChatConnection::refreshBadgeNotificationCount()
 void NeoChatConnection::logout(bool serverSideLogout)
 {
     SettingsGroup(u"Accounts"_s).remove(userId());
+    m_linkPreviewers.clear();
+    linkPreviewCache()->clear();
 
     QKeychain::DeletePasswordJob job(qAppName());
     job.setAutoDelete(true);
@@ -382,58 +499,32 @@ bool NeoChatConnection::directChatExists(Quotient::User *user)
 
 qsizetype NeoChatConnection::directChatNotifications() const
 {
-    qsizetype notifications = 0;
-    QStringList added; // The same ID can be in the list multiple times.
-    for (const auto &chatId : directChats()) {
-        if (!added.contains(chatId)) {
-            if (const auto chat = room(chatId)) {
-                notifications += dynamic_cast<NeoChatRoom *>(chat)->contextAwareNotificationCount();
-                added += chatId;
-            }
-        }
-    }
-    return notifications;
+    return m_directChatNotifications;
 }
 
 bool NeoChatConnection::directChatsHaveHighlightNotifications() const
 {
-    for (const auto &childId : directChats()) {
-        if (const auto child = static_cast<NeoChatRoom *>(room(childId))) {
-            if (child->highlightCount() > 0) {
-                return true;
-            }
-        }
-    }
-    return false;
+    return m_directChatHighlights > 0;
 }
 
 qsizetype NeoChatConnection::homeNotifications() const
 {
-    qsizetype notifications = 0;
-    QStringList added;
-    const auto &spaceHierarchyCache = SpaceHierarchyCache::instance();
-    for (const auto &r : allRooms()) {
-        if (const auto room = static_cast<NeoChatRoom *>(r)) {
-            if (!added.contains(room->id()) && !room->isDirectChat() && !spaceHierarchyCache.isChild(room->id())) {
-                notifications += dynamic_cast<NeoChatRoom *>(room)->contextAwareNotificationCount();
-                added += room->id();
-            }
-        }
-    }
-    return notifications;
+    return m_homeNotifications;
 }
 
 bool NeoChatConnection::homeHaveHighlightNotifications() const
 {
-    const auto &spaceHierarchyCache = SpaceHierarchyCache::instance();
-    for (const auto &r : allRooms()) {
-        if (const auto room = static_cast<NeoChatRoom *>(r)) {
-            if (!room->isDirectChat() && !spaceHierarchyCache.isChild(room->id()) && room->highlightCount() > 0) {
-                return true;
-            }
-        }
-    }
-    return false;
+    return m_homeHighlights > 0;
+}
+
+qsizetype NeoChatConnection::spaceNotifications(const QString &spaceId) const
+{
+    return m_spaceNotifications.value(spaceId);
+}
+
+bool NeoChatConnection::spaceHaveHighlightNotifications(const QString &spaceId) const
+{
+    return m_spaceHighlights.value(spaceId) > 0;
 }
 
 bool NeoChatConnection::directChatInvites() const
@@ -500,7 +591,7 @@ QString NeoChatConnection::accountDataJsonString(const QString &type) const
     return QString::fromUtf8(QJsonDocument(accountDataJson(type)).toJson());
 }
 
-LinkPreviewer *NeoChatConnection::previewerForLink(const QUrl &link)
+LinkPreviewer *NeoChatConnection::previewerForLink(const QUrl &link, bool encrypted)
 {
     if (!NeoChatConfig::showLinkPreview()) {
         return nullptr;
@@ -511,11 +602,22 @@ LinkPreviewer *NeoChatConnection::previewerForLink(const QUrl &link)
         return previewer;
     }
 
-    previewer = new LinkPreviewer(link, this);
+    previewer = new LinkPreviewer(link, encrypted, this);
     m_linkPreviewers.insert(link, previewer);
     return previewer;
 }
 
+LinkPreviewCache *NeoChatConnection::linkPreviewCache()
+{
+    if (m_linkPreviewCache == nullptr) {
+        // Keyed by a hash so that the user ID doesn't have to be a valid file name.
+        const auto account = QCryptographicHash::hash(userId().toUtf8(), QCryptographicHash::Sha1).toHex();
+        m_linkPreviewCache =
+            new LinkPreviewCache(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + u"/linkpreviews/"_s + QString::fromLatin1(account), this);
+    }
+    return m_linkPreviewCache;
+}
+
 KeyImport::Error NeoChatConnection::exportMegolmSessions(const QString &passphrase, const QString &path)
 {
     KeyImport keyImport;
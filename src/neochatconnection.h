@@ -6,6 +6,7 @@
 #include <QCache>
 #include <QObject>
 #include <QQmlEngine>
+#include <QSet>
 
 #include <QCoroTask>
 #include <Quotient/connection.h>
@@ -169,8 +170,17 @@ public:
     qsizetype homeNotifications() const;
     bool homeHaveHighlightNotifications() const;
 
+    /**
+     * @brief The total number of notifications for the child rooms of the given space.
+     */
+    qsizetype spaceNotifications(const QString &spaceId) const;
+
+    /**
+     * @brief Whether any of the child rooms of the given space have highlight notifications.
+     */
+    bool spaceHaveHighlightNotifications(const QString &spaceId) const;
+
     int badgeNotificationCount() const;
-    void refreshBadgeNotificationCount();
 
     bool directChatInvites() const;
 
@@ -180,7 +190,20 @@ public:
 
     bool isOnline() const;
 
-    LinkPreviewer *previewerForLink(const QUrl &link);
+    /**
+     * @brief The previewer for the given link, nullptr if link previews are disabled.
+     *
+     * @param encrypted whether the link is from an encrypted room, so that its
+     *        preview isn't written to disk.
+     */
+    LinkPreviewer *previewerForLink(const QUrl &link, bool encrypted);
+
+    /**
+     * @brief The cache of this account's link previews.
+     *
+     * It is stored in its own directory and removed when the account logs out.
+     */
+    LinkPreviewCache *linkPreviewCache();
 
 Q_SIGNALS:
     void labelChanged();
@@ -197,6 +220,11 @@ Q_SIGNALS:
     void canCheckMutualRoomsChanged();
     void canEraseDataChanged();
 
+    /**
+     * @brief The notification count or highlight state of the given spaces has changed.
+     */
+    void spaceNotificationsChanged(const QStringList &spaceIds);
+
     /**
      * @brief Request a message be shown to the user of the given type.
      */
@@ -215,9 +243,65 @@ private:
 
     void connectSignals();
 
+    /**
+     * @brief A room's contribution to the notification totals.
+     *
+     * Storing this for every room means a change to one room only has to remove
+     * its old contribution and add the new one rather than summing all the rooms
+     * again.
+     */
+    struct RoomNotifications {
+        qsizetype notifications = 0;
+        bool highlight = false;
+        bool direct = false;
+        bool home = false;
+        QStringList spaces;
+
+        bool operator==(const RoomNotifications &other) const = default;
+    };
+    QHash<Quotient::Room *, RoomNotifications> m_roomNotifications;
+
+    qsizetype m_directChatNotifications = 0;
+    qsizetype m_directChatHighlights = 0;
+    qsizetype m_homeNotifications = 0;
+    qsizetype m_homeHighlights = 0;
+    QHash<QString, qsizetype> m_spaceNotifications;
+    QHash<QString, qsizetype> m_spaceHighlights;
+    qsizetype m_totalNotifications = 0;
     int m_badgeNotificationCount = 0;
 
+    void trackRoomNotifications(Quotient::Room *room);
+    void untrackRoomNotifications(Quotient::Room *room);
+    RoomNotifications roomNotifications(Quotient::Room *room, bool updatePlacement) const;
+    void updateRoomNotifications(Quotient::Room *room, bool updatePlacement = false);
+
+    /**
+     * @brief Work out again which tabs and spaces the given rooms are in.
+     *
+     * Called when the space hierarchy changes, with only the rooms whose parent
+     * spaces may have changed.
+     */
+    void updateRoomPlacements(const QStringList &roomIds);
+
+    /**
+     * @brief Replace the room's contribution to the totals without emitting anything.
+     *
+     * Any spaces whose totals may have changed are added to changedSpaces.
+     */
+    void replaceRoomNotifications(Quotient::Room *room, bool updatePlacement, QSet<QString> &changedSpaces);
+    void addRoomNotifications(const RoomNotifications &notifications, int sign);
+
+    struct NotificationTotals {
+        qsizetype directChatNotifications = 0;
+        bool directChatsHaveHighlights = false;
+        qsizetype homeNotifications = 0;
+        bool homeHaveHighlights = false;
+    };
+    NotificationTotals notificationTotals() const;
+    void emitNotificationChanges(const NotificationTotals &previous);
+
     QCache<QUrl, LinkPreviewer> m_linkPreviewers;
+    LinkPreviewCache *m_linkPreviewCache = nullptr;
 
     bool m_canCheckMutualRooms = false;
     bool m_canEraseData = false;
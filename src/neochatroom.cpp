@@ -3,17 +3,21 @@
 
 #include "neochatroom.h"
 
+#include <QBuffer>
 #include <QFileInfo>
 #include <QMediaMetaData>
 #include <QMediaPlayer>
 #include <QMimeDatabase>
 #include <QTemporaryFile>
+#include <QVideoFrame>
+#include <QVideoSink>
 
 #include <Quotient/events/eventcontent.h>
 #include <Quotient/events/eventrelation.h>
 #include <Quotient/events/roommessageevent.h>
 #include <Quotient/jobs/basejob.h>
 #include <Quotient/quotient_common.h>
+#include <qcoro/qcorofuture.h>
 #include <qcoro/qcorosignal.h>
 
 #include <Quotient/avatar.h>
@@ -39,14 +43,17 @@
 
 #include "chatbarcache.h"
 #include "clipboard.h"
+#include "downloadindex.h"
 #include "eventhandler.h"
 #include "events/pollevent.h"
 #include "filetransferpseudojob.h"
+#include "models/contentmodeldispatcher.h"
 #include "neochatconfig.h"
 #include "neochatroommember.h"
 #include "roomlastmessageprovider.h"
 #include "spacehierarchycache.h"
 #include "texthandler.h"
+#include "uploadpreview.h"
 #include "urlhelper.h"
 
 #ifndef Q_OS_ANDROID
@@ -64,6 +71,14 @@ NeoChatRoom::NeoChatRoom(Connection *connection, QString roomId, JoinState joinS
     m_mainCache = new ChatBarCache(this);
     m_editCache = new ChatBarCache(this);
     m_threadCache = new ChatBarCache(this);
+    m_contentModelDispatcher = new ContentModelDispatcher(this);
+
+    m_eventContentModels.setCapacity(NeoChatConfig::roomModelCacheSize());
+    m_threadModels.setCapacity(NeoChatConfig::roomModelCacheSize());
+    connect(NeoChatConfig::self(), &NeoChatConfig::RoomModelCacheSizeChanged, this, [this]() {
+        m_eventContentModels.setCapacity(NeoChatConfig::roomModelCacheSize());
+        m_threadModels.setCapacity(NeoChatConfig::roomModelCacheSize());
+    });
 
     connect(connection, &Connection::accountDataChanged, this, &NeoChatRoom::updatePushNotificationState);
     connect(this, &Room::fileTransferCompleted, this, [this] {
@@ -85,9 +100,16 @@ NeoChatRoom::NeoChatRoom(Connection *connection, QString roomId, JoinState joinS
             if (mxcUrl.isEmpty()) {
                 return;
             }
-            auto localPath = this->fileTransferInfo(eventId).localPath.toLocalFile();
-            auto config = KSharedConfig::openStateConfig(u"neochatdownloads"_s)->group(u"downloads"_s);
-            config.writePathEntry(mxcUrl.mid(6), localPath);
+            DownloadIndex::instance().addDownload(mxcUrl.mid(6), this->fileTransferInfo(eventId).localPath.toLocalFile());
+        }
+    });
+    connect(&DownloadIndex::instance(), &DownloadIndex::downloadChecked, this, [this](const QString &mxcId, bool exists) {
+        const auto eventIds = m_uncheckedDownloads.values(mxcId);
+        m_uncheckedDownloads.remove(mxcId);
+        if (!exists) {
+            for (const auto &eventId : eventIds) {
+                Q_EMIT cachedFileTransferInfoChanged(eventId);
+            }
         }
     });
 
@@ -108,6 +130,29 @@ NeoChatRoom::NeoChatRoom(Connection *connection, QString roomId, JoinState joinS
         }
     }
     connect(this, &Room::addedMessages, this, &NeoChatRoom::cacheLastEvent);
+    connect(this, &Room::addedMessages, this, &NeoChatRoom::invalidateSubtitleText);
+    connect(this, &Room::pendingEventMerged, this, &NeoChatRoom::invalidateSubtitleText);
+    connect(this, &Room::memberNameUpdated, this, [this](RoomMember member) {
+        // Only a rename of the last event's author or subject changes the subtitle.
+        const auto event = m_subtitleText ? lastEvent() : nullptr;
+        if (event == nullptr) {
+            return;
+        }
+        const auto stateEvent = eventCast<const StateEvent>(event);
+        if (event->senderId() == member.id() || (stateEvent && stateEvent->stateKey() == member.id())) {
+            invalidateSubtitleText();
+        }
+    });
+    connect(this, &Room::replacedEvent, this, [this](const RoomEvent *newEvent) {
+        if (isTrackedLastEvent(newEvent->id())) {
+            invalidateLastEvent();
+        }
+    });
+    connect(connection, &Connection::ignoredUsersListChanged, this, &NeoChatRoom::invalidateLastEvent);
+    connect(NeoChatConfig::self(), &NeoChatConfig::ShowStateEventChanged, this, &NeoChatRoom::invalidateLastEvent);
+    connect(NeoChatConfig::self(), &NeoChatConfig::ShowLeaveJoinEventChanged, this, &NeoChatRoom::invalidateLastEvent);
+    connect(NeoChatConfig::self(), &NeoChatConfig::ShowRenameChanged, this, &NeoChatRoom::invalidateLastEvent);
+    connect(NeoChatConfig::self(), &NeoChatConfig::ShowAvatarUpdateChanged, this, &NeoChatRoom::invalidateLastEvent);
 
     connect(this, &Quotient::Room::eventsHistoryJobChanged, this, &NeoChatRoom::lastActiveTimeChanged);
 
@@ -221,6 +266,54 @@ void NeoChatRoom::uploadFile(const QUrl &url, const QString &body)
     doUploadFile(url, body);
 }
 
+namespace
+{
+/**
+ * Image and video content that also sends the blurhash of the media in its info.
+ */
+template<typename ContentT>
+class PreviewContent : public ContentT
+{
+public:
+    using ContentT::ContentT;
+
+    QString blurhash;
+
+protected:
+    void fillInfoJson(QJsonObject &infoJson) const override
+    {
+        ContentT::fillInfoJson(infoJson);
+        if (!blurhash.isEmpty()) {
+            infoJson.insert("xyz.amorgan.blurhash"_L1, blurhash);
+        }
+    }
+};
+
+template<typename ContentT>
+QCoro::Task<void> addUploadPreview(NeoChatRoom *room, ContentT *content, UploadPreview::Preview preview)
+{
+    content->blurhash = preview.blurhash;
+
+    // The thumbnail would have to be encrypted alongside the file, which postFile()
+    // doesn't support, so encrypted rooms only get the blurhash.
+    if (preview.thumbnail.isEmpty() || room->usesEncryption()) {
+        co_return;
+    }
+
+    QBuffer buffer(&preview.thumbnail);
+    buffer.open(QIODevice::ReadOnly);
+    auto job = room->connection()->uploadContent(&buffer, u"thumbnail"_s, preview.thumbnailMimeType);
+    co_await qCoro(job.get(), &BaseJob::finished);
+    if (job->error() != BaseJob::NoError) {
+        co_return;
+    }
+    content->thumbnail = EventContent::Thumbnail(job->contentUri(),
+                                                 preview.thumbnail.size(),
+                                                 QMimeDatabase().mimeTypeForName(preview.thumbnailMimeType),
+                                                 preview.thumbnailSize);
+}
+}
+
 QCoro::Task<void> NeoChatRoom::doUploadFile(QUrl url, QString body)
 {
     if (url.isEmpty()) {
@@ -232,16 +325,35 @@ QCoro::Task<void> NeoChatRoom::doUploadFile(QUrl url, QString body)
     QFileInfo fileInfo(url.isLocalFile() ? url.toLocalFile() : url.toString());
     EventContent::FileContentBase *content;
     if (mime.name().startsWith("image/"_L1)) {
-        QImage image(url.toLocalFile());
-        content = new EventContent::ImageContent(url, fileInfo.size(), mime, image.size(), fileInfo.fileName());
+        const auto preview = co_await UploadPreview::forImageFile(url.toLocalFile());
+        auto imageContent = new PreviewContent<EventContent::ImageContent>(url, fileInfo.size(), mime, preview.size, fileInfo.fileName());
+        co_await addUploadPreview(this, imageContent, preview);
+        content = imageContent;
     } else if (mime.name().startsWith("audio/"_L1)) {
         content = new EventContent::AudioContent(url, fileInfo.size(), mime, fileInfo.fileName());
     } else if (mime.name().startsWith("video/"_L1)) {
         QMediaPlayer player;
+        QVideoSink sink;
+        player.setVideoSink(&sink);
         player.setSource(url);
         co_await qCoro(&player, &QMediaPlayer::mediaStatusChanged);
         auto resolution = player.metaData().value(QMediaMetaData::Resolution).toSize();
-        content = new EventContent::VideoContent(url, fileInfo.size(), mime, resolution, fileInfo.fileName());
+
+        // Play until the first frame arrives to use it for the preview.
+        player.play();
+        const auto frame = co_await qCoro(&sink, &QVideoSink::videoFrameChanged, std::chrono::seconds(2));
+        player.stop();
+        UploadPreview::Preview preview;
+        if (frame && frame->isValid()) {
+            preview = co_await UploadPreview::forImage(frame->toImage());
+        }
+        if (!resolution.isValid()) {
+            resolution = preview.size;
+        }
+
+        auto videoContent = new PreviewContent<EventContent::VideoContent>(url, fileInfo.size(), mime, resolution, fileInfo.fileName());
+        co_await addUploadPreview(this, videoContent, preview);
+        content = videoContent;
     } else {
         content = new EventContent::FileContent(url, fileInfo.size(), mime, fileInfo.fileName());
     }
@@ -308,66 +420,108 @@ void NeoChatRoom::sendTypingNotification(bool isTyping)
 
 const RoomEvent *NeoChatRoom::lastEvent() const
 {
-    for (auto timelineItem = messageEvents().rbegin(); timelineItem < messageEvents().rend(); timelineItem++) {
-        const RoomEvent *event = timelineItem->get();
+    if (!m_lastEventValid) {
+        m_lastEventIndex = findLastEventIndex(messageEvents().rbegin(), messageEvents().rend());
+        m_lastEventValid = true;
+    }
 
-        if (is<RedactionEvent>(*event) || is<ReactionEvent>(*event)) {
-            continue;
-        }
-        if (event->isRedacted()) {
-            continue;
+    if (m_lastEventIndex) {
+        if (const auto it = findInTimeline(*m_lastEventIndex); it != messageEvents().rend()) {
+            return it->get();
         }
+    }
 
-        if (event->isStateEvent() && !NeoChatConfig::showStateEvent()) {
-            continue;
-        }
+    if (m_cachedEvent != nullptr) {
+        return std::to_address(m_cachedEvent);
+    }
 
-        if (auto roomMemberEvent = eventCast<const RoomMemberEvent>(event)) {
-            if ((roomMemberEvent->isJoin() || roomMemberEvent->isLeave()) && !NeoChatConfig::showLeaveJoinEvent()) {
-                continue;
-            } else if (roomMemberEvent->isRename() && !roomMemberEvent->isJoin() && !roomMemberEvent->isLeave() && !NeoChatConfig::showRename()) {
-                continue;
-            } else if (roomMemberEvent->isAvatarUpdate() && !roomMemberEvent->isJoin() && !roomMemberEvent->isLeave() && !NeoChatConfig::showAvatarUpdate()) {
-                continue;
-            }
-        }
-        if (event->isStateEvent() && static_cast<const StateEvent &>(*event).repeatsState()) {
-            continue;
-        }
+    return nullptr;
+}
 
-        if (auto roomEvent = eventCast<const RoomMessageEvent>(event)) {
-            if (!roomEvent->replacedEvent().isEmpty() && roomEvent->replacedEvent() != roomEvent->id()) {
-                continue;
-            }
-        }
+bool NeoChatRoom::isLastEventCandidate(const RoomEvent *event) const
+{
+    if (is<RedactionEvent>(*event) || is<ReactionEvent>(*event)) {
+        return false;
+    }
+    if (event->isRedacted()) {
+        return false;
+    }
 
-        if (connection()->isIgnored(event->senderId())) {
-            continue;
-        }
+    if (event->isStateEvent() && !NeoChatConfig::showStateEvent()) {
+        return false;
+    }
 
-        if (auto lastEvent = eventCast<const StateEvent>(event)) {
-            return lastEvent;
+    if (auto roomMemberEvent = eventCast<const RoomMemberEvent>(event)) {
+        if ((roomMemberEvent->isJoin() || roomMemberEvent->isLeave()) && !NeoChatConfig::showLeaveJoinEvent()) {
+            return false;
+        } else if (roomMemberEvent->isRename() && !roomMemberEvent->isJoin() && !roomMemberEvent->isLeave() && !NeoChatConfig::showRename()) {
+            return false;
+        } else if (roomMemberEvent->isAvatarUpdate() && !roomMemberEvent->isJoin() && !roomMemberEvent->isLeave() && !NeoChatConfig::showAvatarUpdate()) {
+            return false;
         }
+    }
+    if (event->isStateEvent() && static_cast<const StateEvent &>(*event).repeatsState()) {
+        return false;
+    }
 
-        if (auto lastEvent = eventCast<const RoomMessageEvent>(event)) {
-            return lastEvent;
+    if (auto roomEvent = eventCast<const RoomMessageEvent>(event)) {
+        if (!roomEvent->replacedEvent().isEmpty() && roomEvent->replacedEvent() != roomEvent->id()) {
+            return false;
         }
-        if (auto lastEvent = eventCast<const PollStartEvent>(event)) {
-            return lastEvent;
+    }
+
+    if (connection()->isIgnored(event->senderId())) {
+        return false;
+    }
+
+    return is<StateEvent>(*event) || is<RoomMessageEvent>(*event) || is<PollStartEvent>(*event);
+}
+
+std::optional<TimelineItem::index_t> NeoChatRoom::findLastEventIndex(rev_iter_t from, rev_iter_t to) const
+{
+    for (auto timelineItem = from; timelineItem < to; timelineItem++) {
+        if (isLastEventCandidate(timelineItem->get())) {
+            return timelineItem->index();
         }
     }
+    return std::nullopt;
+}
 
-    if (m_cachedEvent != nullptr) {
-        return std::to_address(m_cachedEvent);
+bool NeoChatRoom::isTrackedLastEvent(const QString &eventId) const
+{
+    if (!m_lastEventValid || !m_lastEventIndex) {
+        return false;
     }
+    const auto it = findInTimeline(*m_lastEventIndex);
+    return it != messageEvents().rend() && (*it)->id() == eventId;
+}
 
-    return nullptr;
+void NeoChatRoom::invalidateLastEvent()
+{
+    m_lastEventValid = false;
+    Q_EMIT lastActiveTimeChanged();
+    invalidateSubtitleText();
+}
+
+QString NeoChatRoom::subtitleText() const
+{
+    if (!m_subtitleText) {
+        const auto event = lastEvent();
+        m_subtitleText = event == nullptr || lastEventIsSpoiler() ? QString() : EventHandler::subtitleText(this, event);
+    }
+    return *m_subtitleText;
+}
+
+void NeoChatRoom::invalidateSubtitleText()
+{
+    m_subtitleText.reset();
+    Q_EMIT subtitleTextChanged();
 }
 
 void NeoChatRoom::cacheLastEvent()
 {
     auto event = lastEvent();
-    if (event != nullptr) {
+    if (event != nullptr && event != std::to_address(m_cachedEvent)) {
         auto &roomLastMessageProvider = RoomLastMessageProvider::self();
 
         auto eventJson = QJsonDocument(event->fullJson()).toJson(QJsonDocument::Compact);
@@ -418,6 +572,13 @@ void NeoChatRoom::onAddNewTimelineEvents(timeline_iter_t from)
     std::for_each(from, messageEvents().cend(), [this](const TimelineItem &ti) {
         checkForHighlights(ti);
     });
+
+    // Only the new events need checking, if none of them qualify the tracked last event stays the same.
+    if (m_lastEventValid) {
+        if (const auto newIndex = findLastEventIndex(messageEvents().crbegin(), std::make_reverse_iterator(from))) {
+            m_lastEventIndex = newIndex;
+        }
+    }
 }
 
 void NeoChatRoom::onAddHistoricalTimelineEvents(rev_iter_t from)
@@ -425,10 +586,20 @@ void NeoChatRoom::onAddHistoricalTimelineEvents(rev_iter_t from)
     std::for_each(from, messageEvents().crend(), [this](const TimelineItem &ti) {
         checkForHighlights(ti);
     });
+
+    // Older events can only matter if nothing newer qualified.
+    if (m_lastEventValid && !m_lastEventIndex) {
+        m_lastEventIndex = findLastEventIndex(from, messageEvents().crend());
+    }
 }
 
-void NeoChatRoom::onRedaction(const RoomEvent &prevEvent, const RoomEvent & /*after*/)
+void NeoChatRoom::onRedaction(const RoomEvent &prevEvent, const RoomEvent &after)
 {
+    // Redacting any other event can't change which event is last as redacted events never qualify.
+    if (isTrackedLastEvent(after.id())) {
+        invalidateLastEvent();
+    }
+
     if (const auto &e = eventCast<const ReactionEvent>(&prevEvent)) {
         if (auto relatedEventId = e->eventId(); !relatedEventId.isEmpty()) {
             Q_EMIT updatedEvent(relatedEventId);
@@ -1314,16 +1485,16 @@ FileTransferInfo NeoChatRoom::cachedFileTransferInfo(const Quotient::RoomEvent *
         return transferInfo;
     }
 
-    auto config = KSharedConfig::openStateConfig(u"neochatdownloads"_s)->group(u"downloads"_s);
-    if (!config.hasKey(mxcUrl.mid(6))) {
+    const auto mxcId = mxcUrl.mid(6);
+    auto &downloadIndex = DownloadIndex::instance();
+    const auto path = downloadIndex.localPath(mxcId);
+    if (!path) {
         return transferInfo;
     }
-
-    const auto path = config.readPathEntry(mxcUrl.mid(6), QString());
-    QFileInfo info(path);
-    if (!info.isFile()) {
-        config.deleteEntry(mxcUrl);
-        return transferInfo;
+    // Until the index has checked that the file still exists assume that it does,
+    // if it doesn't cachedFileTransferInfoChanged() will be emitted for the event.
+    if (!downloadIndex.isVerified(mxcId) && !m_uncheckedDownloads.contains(mxcId, event->id())) {
+        m_uncheckedDownloads.insert(mxcId, event->id());
     }
     // TODO: we could check the hash here
     return FileTransferInfo{
@@ -1331,8 +1502,8 @@ FileTransferInfo NeoChatRoom::cachedFileTransferInfo(const Quotient::RoomEvent *
         .isUpload = false,
         .progress = total,
         .total = total,
-        .localDir = QUrl(info.dir().path()),
-        .localPath = QUrl::fromLocalFile(path),
+        .localDir = QUrl(QFileInfo(*path).dir().path()),
+        .localPath = QUrl::fromLocalFile(*path),
     };
 }
 
@@ -1351,6 +1522,11 @@ ChatBarCache *NeoChatRoom::threadCache() const
     return m_threadCache;
 }
 
+ContentModelDispatcher *NeoChatRoom::contentModelDispatcher() const
+{
+    return m_contentModelDispatcher;
+}
+
 void NeoChatRoom::replyLastMessage()
 {
     const auto &timelineBottom = messageEvents().rbegin();
@@ -1686,11 +1862,11 @@ MessageContentModel *NeoChatRoom::contentModelForEvent(const QString &eventId)
         return nullptr;
     }
 
-    if (!m_eventContentModels.contains(eventId)) {
-        return m_eventContentModels.emplace(eventId, std::make_unique<MessageContentModel>(this, eventId)).first->second.get();
+    if (const auto model = m_eventContentModels.object(eventId)) {
+        return model;
     }
 
-    return m_eventContentModels[eventId].get();
+    return m_eventContentModels.insert(eventId, std::make_unique<MessageContentModel>(this, eventId));
 }
 
 MessageContentModel *NeoChatRoom::contentModelForEvent(const Quotient::RoomEvent *event)
@@ -1698,12 +1874,8 @@ MessageContentModel *NeoChatRoom::contentModelForEvent(const Quotient::RoomEvent
     const auto roomMessageEvent = eventCast<const Quotient::RoomMessageEvent>(event);
     if (roomMessageEvent == nullptr) {
         // If for some reason a model is there remove.
-        if (m_eventContentModels.contains(event->id())) {
-            m_eventContentModels.erase(event->id());
-        }
-        if (m_eventContentModels.contains(event->transactionId())) {
-            m_eventContentModels.erase(event->transactionId());
-        }
+        m_eventContentModels.remove(event->id());
+        m_eventContentModels.remove(event->transactionId());
         return nullptr;
     }
 
@@ -1714,25 +1886,21 @@ MessageContentModel *NeoChatRoom::contentModelForEvent(const Quotient::RoomEvent
     auto eventId = event->id();
     const auto txnId = event->transactionId();
     if (!m_eventContentModels.contains(eventId) && !m_eventContentModels.contains(txnId)) {
-        return m_eventContentModels
-            .emplace(eventId.isEmpty() ? txnId : eventId,
-                     std::make_unique<MessageContentModel>(this, eventId.isEmpty() ? txnId : eventId, false, eventId.isEmpty()))
-            .first->second.get();
+        return m_eventContentModels.insert(eventId.isEmpty() ? txnId : eventId,
+                                           std::make_unique<MessageContentModel>(this, eventId.isEmpty() ? txnId : eventId, false, eventId.isEmpty()));
     }
 
     if (!eventId.isEmpty() && m_eventContentModels.contains(eventId)) {
-        return m_eventContentModels[eventId].get();
+        return m_eventContentModels.object(eventId);
     }
 
     if (!txnId.isEmpty() && m_eventContentModels.contains(txnId)) {
         if (eventId.isEmpty()) {
-            return m_eventContentModels[txnId].get();
+            return m_eventContentModels.object(txnId);
         }
 
         // If we now have an event ID use that as the map key instead of transaction ID.
-        auto txnModel = std::move(m_eventContentModels[txnId]);
-        m_eventContentModels.erase(txnId);
-        return m_eventContentModels.emplace(eventId, std::move(txnModel)).first->second.get();
+        return m_eventContentModels.insert(eventId, m_eventContentModels.take(txnId));
     }
 
     return nullptr;
@@ -1744,11 +1912,16 @@ ThreadModel *NeoChatRoom::modelForThread(const QString &threadRootId)
         return nullptr;
     }
 
-    if (!m_threadModels.contains(threadRootId)) {
-        return m_threadModels.emplace(threadRootId, std::make_unique<ThreadModel>(threadRootId, this)).first->second.get();
+    if (const auto model = m_threadModels.object(threadRootId)) {
+        return model;
     }
 
-    return m_threadModels[threadRootId].get();
+    return m_threadModels.insert(threadRootId, std::make_unique<ThreadModel>(threadRootId, this));
+}
+
+quint64 NeoChatRoom::modelCacheEvictions() const
+{
+    return m_eventContentModels.evictions() + m_threadModels.evictions();
 }
 
 #include "moc_neochatroom.cpp"
@@ -15,6 +15,7 @@
 
 #include "enums/messagetype.h"
 #include "enums/pushrule.h"
+#include "modelcache.h"
 #include "models/messagecontentmodel.h"
 #include "models/threadmodel.h"
 #include "neochatroommember.h"
@@ -26,6 +27,7 @@ class User;
 }
 
 class ChatBarCache;
+class ContentModelDispatcher;
 
 /**
  * @class NeoChatRoom
@@ -227,6 +229,20 @@ public:
      */
     [[nodiscard]] bool lastEventIsSpoiler() const;
 
+    /**
+     * @brief The text to show as the room subtitle in the room list.
+     *
+     * This is the author and plain text body of the last event, or an empty string
+     * if there is no last event or it looks like it has spoilers.
+     *
+     * The text is cached and only rebuilt after subtitleTextChanged() is emitted,
+     * i.e. when new messages are added, a pending event is merged, a member is
+     * renamed or the last event changes.
+     *
+     * @sa lastEvent(), lastEventIsSpoiler(), EventHandler::subtitleText()
+     */
+    [[nodiscard]] QString subtitleText() const;
+
     /**
      * @brief Return the notification count for the room accounting for tags and notification state.
      *
@@ -477,6 +493,11 @@ public:
 
     ChatBarCache *threadCache() const;
 
+    /**
+     * @brief The dispatcher routing this room's signals to its MessageContentModels.
+     */
+    ContentModelDispatcher *contentModelDispatcher() const;
+
     /**
      * @brief Reply to the last message sent in the timeline.
      *
@@ -549,7 +570,9 @@ public:
      * @brief Return the cached file transfer information for the event.
      *
      * If we downloaded the file previously, return a struct with Completed status
-     * and the local file path stored in KSharedCOnfig
+     * and the local file path stored in the DownloadIndex.
+     *
+     * @sa DownloadIndex, cachedFileTransferInfoChanged
      */
     Quotient::FileTransferInfo cachedFileTransferInfo(const Quotient::RoomEvent *event) const;
 
@@ -601,6 +624,16 @@ public:
      */
     Q_INVOKABLE ThreadModel *modelForThread(const QString &threadRootId);
 
+    /**
+     * @brief The number of content and thread models evicted from this room's caches.
+     *
+     * Models are evicted least recently used first once a cache is over capacity,
+     * models that are still in use are never evicted.
+     *
+     * @sa NeoChatConfig::roomModelCacheSize(), NeoChatConfig::globalModelCacheSize()
+     */
+    quint64 modelCacheEvictions() const;
+
 private:
     bool m_visible = false;
 
@@ -618,6 +651,41 @@ private:
     void onAddHistoricalTimelineEvents(rev_iter_t from) override;
     void onRedaction(const Quotient::RoomEvent &prevEvent, const Quotient::RoomEvent &after) override;
 
+    /**
+     * @brief Whether the given event is suitable to be shown as the room's last event.
+     *
+     * @sa lastEvent()
+     */
+    bool isLastEventCandidate(const Quotient::RoomEvent *event) const;
+
+    /**
+     * @brief Return the timeline index of the newest last event candidate in the given range.
+     *
+     * The range is searched newest to oldest.
+     */
+    std::optional<Quotient::TimelineItem::index_t> findLastEventIndex(rev_iter_t from, rev_iter_t to) const;
+
+    /**
+     * @brief Whether the event with the given ID is the currently tracked last event.
+     */
+    bool isTrackedLastEvent(const QString &eventId) const;
+
+    /**
+     * @brief Mark the tracked last event as stale so it is recalculated on next use.
+     */
+    void invalidateLastEvent();
+
+    void invalidateSubtitleText();
+    mutable std::optional<QString> m_subtitleText;
+
+    // The timeline index of the last event, std::nullopt if the loaded timeline has no candidate.
+    // Only meaningful while m_lastEventValid is true.
+    mutable std::optional<Quotient::TimelineItem::index_t> m_lastEventIndex;
+    mutable bool m_lastEventValid = false;
+
+    // The events that cachedFileTransferInfo() reported as downloaded before the file was checked, keyed by mxc ID.
+    mutable QMultiHash<QString, QString> m_uncheckedDownloads;
+
     QCoro::Task<void> doDeleteMessagesByUser(const QString &user, QString reason);
     QCoro::Task<void> doUploadFile(QUrl url, QString body = QString());
 
@@ -626,6 +694,7 @@ private:
     ChatBarCache *m_mainCache;
     ChatBarCache *m_editCache;
     ChatBarCache *m_threadCache;
+    ContentModelDispatcher *m_contentModelDispatcher;
 
     QCache<QString, PollHandler> m_polls;
     std::vector<Quotient::event_ptr_tt<Quotient::RoomEvent>> m_extraEvents;
@@ -633,8 +702,8 @@ private:
     void cleanupExtraEvent(const QString &eventId);
 
     std::unordered_map<QString, std::unique_ptr<NeochatRoomMember>> m_memberObjects;
-    std::unordered_map<QString, std::unique_ptr<MessageContentModel>> m_eventContentModels;
-    std::unordered_map<QString, std::unique_ptr<ThreadModel>> m_threadModels;
+    ModelCache<MessageContentModel> m_eventContentModels;
+    ModelCache<ThreadModel> m_threadModels;
 
 private Q_SLOTS:
     void updatePushNotificationState(QString type);
@@ -651,6 +720,13 @@ Q_SIGNALS:
     void parentIdsChanged();
     void canonicalParentChanged();
     void lastActiveTimeChanged();
+    void subtitleTextChanged();
+
+    /**
+     * @brief The result of cachedFileTransferInfo() for the given event has changed.
+     */
+    void cachedFileTransferInfoChanged(const QString &eventId);
+
     void childrenNotificationCountChanged();
     void childrenHaveHighlightNotificationsChanged();
     void isInviteChanged();
@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "notificationfetchpolicy.h"
+
+#include <QJsonObject>
+
+#include "seennotifications.h"
+
+using namespace Qt::StringLiterals;
+
+bool NotificationFetchPolicy::update(const QList<Room> &rooms)
+{
+    QHash<QString, State> states;
+    states.reserve(rooms.size());
+    bool changed = false;
+    for (const auto &room : rooms) {
+        const auto it = m_rooms.constFind(room.id);
+        const auto known = it != m_rooms.constEnd();
+        if (room.invite) {
+            // An invite doesn't have any counts but is a notification in itself.
+            changed |= !known || !it->invite;
+        } else if (room.notificationCount > 0) {
+            changed |= !known || it->lastEventId != room.lastEventId || room.notificationCount > it->notificationCount;
+        }
+        states.insert(room.id, {.lastEventId = room.lastEventId, .notificationCount = room.notificationCount, .invite = room.invite});
+    }
+    m_rooms = std::move(states);
+    return changed;
+}
+
+bool NotificationFetchPolicy::needsOlderPage(const QJsonArray &notifications,
+                                             const QString &nextToken,
+                                             int page,
+                                             const SeenNotifications &seen,
+                                             qint64 initialTimestamp)
+{
+    if (notifications.isEmpty() || nextToken.isEmpty() || page + 1 >= MaxCatchUpPages) {
+        return false;
+    }
+    for (const auto &notification : notifications) {
+        const auto eventId = notification["event"_L1]["event_id"_L1].toString();
+        const qint64 timestamp = notification["ts"_L1].toVariant().toLongLong();
+        if (timestamp < initialTimestamp || seen.contains(eventId, timestamp)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QHash>
+#include <QJsonArray>
+#include <QList>
+#include <QString>
+
+class SeenNotifications;
+
+/**
+ * @class NotificationFetchPolicy
+ *
+ * Decide when NotificationsManager needs to ask the server for notifications.
+ *
+ * A room may have a new notification when it has any notifications and its
+ * latest event changed since the last sync. The notification count alone can't
+ * be used: one notification being read while another arrives in the same sync,
+ * or the count being reset, leaves it the same or lower.
+ *
+ * @sa NotificationsManager, SeenNotifications
+ */
+class NotificationFetchPolicy
+{
+public:
+    /**
+     * @brief Older pages are only followed this far when catching up after a gap.
+     */
+    static constexpr int MaxCatchUpPages = 5;
+
+    struct Room {
+        QString id;
+        /**
+         * @brief The ID of the newest event in the room's timeline, empty if none is loaded.
+         */
+        QString lastEventId;
+        qsizetype notificationCount = 0;
+        bool invite = false;
+    };
+
+    /**
+     * @brief Record the state of the rooms after a sync.
+     *
+     * Rooms missing from the list are forgotten.
+     *
+     * @return whether any room may have a notification that hasn't been fetched.
+     */
+    bool update(const QList<Room> &rooms);
+
+    /**
+     * @brief Whether the next, older, page of notifications should be fetched.
+     *
+     * True when none of the notifications on the page had been seen before, so
+     * there may be unseen ones beyond it, and the server has more pages. Pages are
+     * counted from 0 and at most MaxCatchUpPages are fetched.
+     *
+     * @param notifications the page of notifications, newest first.
+     * @param nextToken the token for the next page given by the server.
+     * @param page the index of the page.
+     * @param seen the notifications that were seen before this page.
+     * @param initialTimestamp notifications before this count as seen.
+     */
+    static bool needsOlderPage(const QJsonArray &notifications, const QString &nextToken, int page, const SeenNotifications &seen, qint64 initialTimestamp);
+
+private:
+    struct State {
+        QString lastEventId;
+        qsizetype notificationCount = 0;
+        bool invite = false;
+    };
+    QHash<QString, State> m_rooms;
+};
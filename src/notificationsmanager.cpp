@@ -40,6 +40,17 @@ NotificationsManager::NotificationsManager(QObject *parent)
 
 void NotificationsManager::handleNotifications(QPointer<NeoChatConnection> connection)
 {
+    if (connection == nullptr) {
+        return;
+    }
+
+    // The rooms are checked on every sync, but the server is only asked for the
+    // notifications themselves once a room may have a new one.
+    const auto hasNewNotifications = updateFetchPolicy(connection);
+    if (!hasNewNotifications && m_seenNotifications.contains(connection->user()->id())) {
+        return;
+    }
+
     if (KNotificationPermission::checkPermission() == Qt::PermissionStatus::Granted) {
         startNotificationJob(connection);
     } else if (!permissionAsked) {
@@ -53,61 +64,94 @@ void NotificationsManager::handleNotifications(QPointer<NeoChatConnection> conne
     }
 }
 
-void NotificationsManager::startNotificationJob(QPointer<NeoChatConnection> connection)
+bool NotificationsManager::updateFetchPolicy(NeoChatConnection *connection)
+{
+    QList<NotificationFetchPolicy::Room> rooms;
+    for (const auto room : connection->allRooms()) {
+        if (room->joinState() == JoinState::Leave) {
+            continue;
+        }
+        const auto &timeline = room->messageEvents();
+        rooms.append({.id = room->id(),
+                      .lastEventId = timeline.empty() ? QString() : timeline.back()->id(),
+                      .notificationCount = std::max<qsizetype>(room->notificationCount(), room->highlightCount()),
+                      .invite = room->joinState() == JoinState::Invite});
+    }
+    return m_fetchPolicies[connection->user()->id()].update(rooms);
+}
+
+void NotificationsManager::startNotificationJob(QPointer<NeoChatConnection> connection, const QString &from, int page)
 {
     if (connection == nullptr) {
         return;
     }
 
-    if (!m_connActiveJob.contains(connection->user()->id())) {
-        auto job = connection->callApi<GetNotificationsJob>();
-        m_connActiveJob.append(connection->user()->id());
-        connect(job, &BaseJob::success, this, [this, job, connection]() {
-            m_connActiveJob.removeAll(connection->user()->id());
-            processNotificationJob(connection, job, !m_oldNotifications.contains(connection->user()->id()));
-        });
+    const auto connectionId = connection->user()->id();
+    if (m_connActiveJob.contains(connectionId)) {
+        // Fetch the newest page again once the current job is done, otherwise
+        // anything that arrived in the meantime would wait for the next new notification.
+        if (from.isEmpty()) {
+            m_pendingFetches.insert(connectionId);
+        }
+        return;
     }
+
+    auto job = connection->callApi<GetNotificationsJob>(from);
+    m_connActiveJob.append(connectionId);
+    const auto fetchPending = [this, connection, connectionId]() {
+        if (!m_connActiveJob.contains(connectionId) && m_pendingFetches.remove(connectionId)) {
+            startNotificationJob(connection);
+        }
+    };
+    connect(job, &BaseJob::success, this, [this, job, connection, connectionId, page, fetchPending]() {
+        m_connActiveJob.removeAll(connectionId);
+        processNotificationJob(connection, job, !m_seenNotifications.contains(connectionId), page);
+        fetchPending();
+    });
+    connect(job, &BaseJob::failure, this, [this, connectionId, fetchPending]() {
+        m_connActiveJob.removeAll(connectionId);
+        fetchPending();
+    });
 }
 
-void NotificationsManager::processNotificationJob(QPointer<NeoChatConnection> connection, Quotient::GetNotificationsJob *job, bool initialization)
+void NotificationsManager::processNotificationJob(QPointer<NeoChatConnection> connection, Quotient::GetNotificationsJob *job, bool initialization, int page)
 {
     if (!job || !connection || !connection->isLoggedIn()) {
         return;
     }
 
     const auto connectionId = connection->user()->id();
+    auto &seenNotifications = m_seenNotifications[connectionId];
 
     const auto notifications = job->jsonData()["notifications"_L1].toArray();
     if (initialization) {
         for (const auto &notification : notifications) {
-            if (!m_initialTimestamp.contains(connectionId)) {
-                m_initialTimestamp[connectionId] = notification["ts"_L1].toVariant().toLongLong();
-            } else {
-                qint64 timestamp = notification["ts"_L1].toVariant().toLongLong();
-                if (timestamp > m_initialTimestamp[connectionId]) {
-                    m_initialTimestamp[connectionId] = timestamp;
-                }
+            const qint64 timestamp = notification["ts"_L1].toVariant().toLongLong();
+            if (!m_initialTimestamp.contains(connectionId) || timestamp > m_initialTimestamp[connectionId]) {
+                m_initialTimestamp[connectionId] = timestamp;
             }
-
-            auto connectionNotifications = m_oldNotifications.value(connectionId);
-            connectionNotifications += notification["event"_L1]["event_id"_L1].toString();
-            m_oldNotifications[connectionId] = connectionNotifications;
+            seenNotifications.insert(notification["event"_L1]["event_id"_L1].toString(), timestamp);
         }
         return;
     }
 
+    // Notifications are newest first. If none of this page had been seen there
+    // may be more unseen ones on the next, e.g. after being offline for a while.
+    const auto nextToken = job->jsonData()["next_token"_L1].toString();
+    const auto fetchOlder = NotificationFetchPolicy::needsOlderPage(notifications, nextToken, page, seenNotifications, m_initialTimestamp.value(connectionId));
+
     QMap<QString, std::pair<qint64, QJsonObject>> notificationsToPost;
     for (const auto &n : notifications) {
         const auto notification = n.toObject();
-        if (notification["read"_L1].toBool()) {
+        const auto eventId = notification["event"_L1]["event_id"_L1].toString();
+        const qint64 timestamp = notification["ts"_L1].toVariant().toLongLong();
+        if (seenNotifications.contains(eventId, timestamp) || timestamp < m_initialTimestamp.value(connectionId)) {
             continue;
         }
-        auto connectionNotifications = m_oldNotifications.value(connectionId);
-        if (connectionNotifications.contains(notification["event"_L1]["event_id"_L1].toString())) {
+        if (notification["read"_L1].toBool()) {
             continue;
         }
-        connectionNotifications += notification["event"_L1]["event_id"_L1].toString();
-        m_oldNotifications[connectionId] = connectionNotifications;
+        seenNotifications.insert(eventId, timestamp);
 
         if (!shouldPostNotification(connection, n)) {
             continue;
@@ -119,6 +163,10 @@ void NotificationsManager::processNotificationJob(QPointer<NeoChatConnection> co
         }
     }
 
+    if (fetchOlder) {
+        startNotificationJob(connection, nextToken, page + 1);
+    }
+
     for (const auto &[roomId, pair] : notificationsToPost.asKeyValueRange()) {
         const auto &notification = pair.second;
         const auto room = connection->room(roomId);
@@ -9,10 +9,14 @@
 #include <QObject>
 #include <QPointer>
 #include <QQmlEngine>
+#include <QSet>
 #include <QString>
 #include <Quotient/csapi/notifications.h>
 #include <Quotient/jobs/basejob.h>
 
+#include "notificationfetchpolicy.h"
+#include "seennotifications.h"
+
 class NeoChatConnection;
 class KNotification;
 class NeoChatRoom;
@@ -62,10 +66,13 @@ public:
 
 private:
     QHash<QString, qint64> m_initialTimestamp;
-    QHash<QString, QStringList> m_oldNotifications;
+    QHash<QString, SeenNotifications> m_seenNotifications;
+    QHash<QString, NotificationFetchPolicy> m_fetchPolicies;
 
     QStringList m_connActiveJob;
-    void startNotificationJob(QPointer<NeoChatConnection> connection);
+    QSet<QString> m_pendingFetches;
+    bool updateFetchPolicy(NeoChatConnection *connection);
+    void startNotificationJob(QPointer<NeoChatConnection> connection, const QString &from = {}, int page = 0);
 
     QPixmap createNotificationImage(const QImage &icon, NeoChatRoom *room);
     bool shouldPostNotification(QPointer<NeoChatConnection> connection, const QJsonValue &notification);
@@ -85,5 +92,5 @@ private:
     bool permissionAsked = false;
 
 private Q_SLOTS:
-    void processNotificationJob(QPointer<NeoChatConnection> connection, Quotient::GetNotificationsJob *job, bool initialization);
+    void processNotificationJob(QPointer<NeoChatConnection> connection, Quotient::GetNotificationsJob *job, bool initialization, int page);
 };
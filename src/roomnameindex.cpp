@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "roomnameindex.h"
+
+#include <QCollator>
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+enum Rank {
+    Exact,
+    Prefix,
+    WordPrefix,
+    Contains,
+    NoMatch,
+};
+
+Rank rank(const QString &name, const QString &filter)
+{
+    auto position = name.indexOf(filter);
+    if (position < 0) {
+        return NoMatch;
+    }
+    if (position == 0) {
+        return name.size() == filter.size() ? Exact : Prefix;
+    }
+    for (; position >= 0; position = name.indexOf(filter, position + 1)) {
+        if (!name[position - 1].isLetterOrNumber()) {
+            return WordPrefix;
+        }
+    }
+    return Contains;
+}
+}
+
+RoomNameIndex::RoomNameIndex(QList<Entry> entries)
+{
+    QCollator collator;
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+    collator.setNumericMode(true);
+
+    std::vector<QCollatorSortKey> keys;
+    keys.reserve(entries.size());
+    for (const auto &entry : std::as_const(entries)) {
+        keys.push_back(collator.sortKey(entry.displayName));
+    }
+    std::vector<qsizetype> order(entries.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&keys](qsizetype left, qsizetype right) {
+        return keys[left].compare(keys[right]) < 0;
+    });
+
+    m_entries.reserve(entries.size());
+    m_foldedNames.reserve(entries.size());
+    for (const auto index : order) {
+        m_foldedNames.append(entries[index].displayName.toCaseFolded());
+        m_entries.append(std::move(entries[index]));
+    }
+}
+
+qsizetype RoomNameIndex::size() const
+{
+    return m_entries.size();
+}
+
+const RoomNameIndex::Entry &RoomNameIndex::entry(qsizetype index) const
+{
+    return m_entries.at(index);
+}
+
+QList<qsizetype> RoomNameIndex::search(const QString &filter, qsizetype limit) const
+{
+    QList<qsizetype> results;
+    if (filter.isEmpty()) {
+        const auto count = limit < 0 ? m_entries.size() : std::min(limit, m_entries.size());
+        results.reserve(count);
+        for (qsizetype index = 0; index < count; ++index) {
+            results.append(index);
+        }
+        return results;
+    }
+
+    const auto foldedFilter = filter.toCaseFolded();
+    // Entries are in name order so bucketing by rank keeps each bucket in name order.
+    std::array<QList<qsizetype>, NoMatch> ranked;
+    for (qsizetype index = 0; index < m_foldedNames.size(); ++index) {
+        const auto entryRank = rank(m_foldedNames[index], foldedFilter);
+        if (entryRank != NoMatch) {
+            ranked[entryRank].append(index);
+        }
+    }
+    for (const auto &indexes : ranked) {
+        for (const auto index : indexes) {
+            if (limit >= 0 && results.size() >= limit) {
+                return results;
+            }
+            results.append(index);
+        }
+    }
+    return results;
+}
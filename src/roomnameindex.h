@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QList>
+#include <QString>
+
+/**
+ * @class RoomNameIndex
+ *
+ * An immutable, case insensitive search index over the names of a list of rooms.
+ *
+ * The entries are sorted and case folded once when the index is built, so a
+ * search only has to compare the filter against each name rather than resort and
+ * refilter a model.
+ *
+ * @sa Runner
+ */
+class RoomNameIndex
+{
+public:
+    struct Entry {
+        QString roomId;
+        QString displayName;
+    };
+
+    RoomNameIndex() = default;
+    explicit RoomNameIndex(QList<Entry> entries);
+
+    [[nodiscard]] qsizetype size() const;
+
+    [[nodiscard]] const Entry &entry(qsizetype index) const;
+
+    /**
+     * @brief The indexes of the entries whose name contains the filter.
+     *
+     * Exact matches come first, then names that start with the filter, then names
+     * with a word that starts with the filter and finally any other match. Each
+     * group is in name order. An empty filter matches every entry.
+     *
+     * @param filter the text to search for.
+     * @param limit the maximum number of results, or -1 for all of them.
+     */
+    [[nodiscard]] QList<qsizetype> search(const QString &filter, qsizetype limit = -1) const;
+
+private:
+    QList<Entry> m_entries;
+    QList<QString> m_foldedNames;
+};
@@ -4,11 +4,13 @@
 #include "runner.h"
 
 #include <QDBusMetaType>
+#include <QSet>
 
 #include "controller.h"
+#include "neochatconnection.h"
+#include "neochatroom.h"
 #include "roomlistmodel.h"
 #include "roommanager.h"
-#include "sortfilterroomlistmodel.h"
 #include "windowcontroller.h"
 
 RemoteImage Runner::serializeImage(const QImage &image)
@@ -29,12 +31,32 @@ RemoteImage Runner::serializeImage(const QImage &image)
 Runner::Runner()
     : QObject()
     , m_sourceModel(new RoomListModel(this))
-    , m_model(new SortFilterRoomListModel(m_sourceModel, this))
 {
     connect(&Controller::instance(), &Controller::activeConnectionChanged, this, [this]() {
         m_sourceModel->setConnection(Controller::instance().activeConnection());
     });
 
+    // The index is rebuilt on the next search rather than on every change.
+    const auto invalidateIndex = [this]() {
+        m_index.reset();
+    };
+    connect(m_sourceModel, &RoomListModel::modelReset, this, invalidateIndex);
+    connect(m_sourceModel, &RoomListModel::rowsInserted, this, invalidateIndex);
+    connect(m_sourceModel, &RoomListModel::rowsRemoved, this, invalidateIndex);
+    connect(m_sourceModel,
+            &RoomListModel::dataChanged,
+            this,
+            [this](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles) {
+                if (roles.isEmpty() || roles.contains(RoomListModel::DisplayNameRole)) {
+                    m_index.reset();
+                }
+                if (roles.contains(RoomListModel::AvatarRole)) {
+                    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+                        m_avatars.remove(m_sourceModel->roomAt(row)->id());
+                    }
+                }
+            });
+
     qDBusRegisterMetaType<RemoteMatch>();
     qDBusRegisterMetaType<RemoteMatches>();
     qDBusRegisterMetaType<RemoteAction>();
@@ -42,6 +64,50 @@ Runner::Runner()
     qDBusRegisterMetaType<RemoteImage>();
 }
 
+std::shared_ptr<const RoomNameIndex> Runner::roomNameIndex()
+{
+    if (m_index) {
+        return m_index;
+    }
+
+    const auto connection = m_sourceModel->connection();
+    QList<RoomNameIndex::Entry> entries;
+    QSet<QString> roomIds;
+    entries.reserve(m_sourceModel->rowCount());
+    for (int row = 0; row < m_sourceModel->rowCount(); ++row) {
+        const auto room = m_sourceModel->roomAt(row);
+        // Same as SortFilterRoomListModel, skip spaces and rooms that have been replaced.
+        if (room->isSpace() || (!room->successorId().isEmpty() && connection->room(room->successorId()))) {
+            continue;
+        }
+        entries.append({.roomId = room->id(), .displayName = room->displayName()});
+        roomIds.insert(room->id());
+    }
+    m_index = std::make_shared<const RoomNameIndex>(std::move(entries));
+
+    m_avatars.removeIf([&roomIds](const decltype(m_avatars)::iterator &it) {
+        return !roomIds.contains(it.key());
+    });
+    return m_index;
+}
+
+RemoteImage Runner::roomAvatar(NeoChatRoom *room)
+{
+    const auto it = m_avatars.constFind(room->id());
+    // An invite and the joined room are different objects with the same ID.
+    if (it != m_avatars.constEnd() && it->room == room) {
+        return it->image;
+    }
+
+    const auto avatar = room->avatar(128);
+    const auto image = serializeImage(avatar);
+    // The avatar may still be downloading, avatarChanged is emitted once it is ready.
+    if (!avatar.isNull()) {
+        m_avatars.insert(room->id(), {.room = room, .image = image});
+    }
+    return image;
+}
+
 RemoteActions Runner::Actions()
 {
     return {};
@@ -49,24 +115,31 @@ RemoteActions Runner::Actions()
 
 RemoteMatches Runner::Match(const QString &searchTerm)
 {
-    m_model->setFilterText(searchTerm);
+    const auto index = roomNameIndex();
+    const auto connection = m_sourceModel->connection();
 
     RemoteMatches matches;
 
-    for (int i = 0; i < m_model->rowCount(); ++i) {
-        RemoteMatch match;
+    const auto results = index->search(searchTerm, MaxMatches);
+    for (const auto result : results) {
+        const auto &entry = index->entry(result);
+        const auto room = connection
+            ? static_cast<NeoChatRoom *>(connection->room(entry.roomId, Quotient::JoinState::Invite | Quotient::JoinState::Join | Quotient::JoinState::Leave))
+            : nullptr;
+        if (!room) {
+            continue;
+        }
 
-        const QString name = m_model->data(m_model->index(i, 0), RoomListModel::DisplayNameRole).toString();
+        RemoteMatch match;
 
         match.iconName = u"org.kde.neochat"_s;
-        match.id = m_model->data(m_model->index(i, 0), RoomListModel::RoomIdRole).toString();
-        match.text = name;
+        match.id = entry.roomId;
+        match.text = entry.displayName;
         match.relevance = 1;
-        const RemoteImage remoteImage = serializeImage(m_model->data(m_model->index(i, 0), RoomListModel::AvatarImageRole).value<QImage>());
-        match.properties.insert(u"icon-data"_s, QVariant::fromValue(remoteImage));
-        match.properties.insert(u"subtext"_s, m_model->data(m_model->index(i, 0), RoomListModel::TopicRole).toString());
+        match.properties.insert(u"icon-data"_s, QVariant::fromValue(roomAvatar(room)));
+        match.properties.insert(u"subtext"_s, room->topic());
 
-        if (name.compare(searchTerm, Qt::CaseInsensitive) == 0) {
+        if (entry.displayName.compare(searchTerm, Qt::CaseInsensitive) == 0) {
             match.type = ExactMatch;
         } else {
             match.type = CompletionMatch;
@@ -7,12 +7,15 @@
 #include <QObject>
 
 #include <QDBusArgument>
+#include <QHash>
 #include <QList>
 #include <QString>
 #include <QVariantMap>
 
+#include <memory>
+
 #include "models/roomlistmodel.h"
-#include "models/sortfilterroomlistmodel.h"
+#include "roomnameindex.h"
 
 /**
  * The type of match. Value is important here as it is used for sorting
@@ -194,9 +197,29 @@ Q_SIGNALS:
     void roomListModelChanged();
 
 private:
+    // KRunner only shows a handful of results.
+    static constexpr qsizetype MaxMatches = 20;
+
     RemoteImage serializeImage(const QImage &image);
 
+    /**
+     * @brief The index of the current rooms, rebuilt if the room list changed since the last search.
+     */
+    std::shared_ptr<const RoomNameIndex> roomNameIndex();
+
+    /**
+     * @brief The serialised avatar of the given room, cached until the avatar changes.
+     */
+    RemoteImage roomAvatar(NeoChatRoom *room);
+
     QPointer<RoomListModel> m_sourceModel;
-    QPointer<SortFilterRoomListModel> m_model;
+    std::shared_ptr<const RoomNameIndex> m_index;
+
+    struct CachedAvatar {
+        QPointer<NeoChatRoom> room;
+        RemoteImage image;
+    };
+    QHash<QString, CachedAvatar> m_avatars;
+
     Runner();
 };
@@ -0,0 +1,53 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "seennotifications.h"
+
+#include <QList>
+
+#include <algorithm>
+
+SeenNotifications::SeenNotifications(qsizetype capacity)
+    : m_capacity(std::max<qsizetype>(capacity, 1))
+{
+}
+
+bool SeenNotifications::contains(const QString &eventId, qint64 timestamp) const
+{
+    return timestamp <= m_watermark || m_events.contains(eventId);
+}
+
+void SeenNotifications::insert(const QString &eventId, qint64 timestamp)
+{
+    if (timestamp <= m_watermark) {
+        return;
+    }
+    m_events.insert(eventId, timestamp);
+    if (m_events.size() > m_capacity) {
+        prune();
+    }
+}
+
+qsizetype SeenNotifications::size() const
+{
+    return m_events.size();
+}
+
+qint64 SeenNotifications::watermark() const
+{
+    return m_watermark;
+}
+
+void SeenNotifications::prune()
+{
+    // Drop a quarter of the set at a time so that the cost is spread over many inserts.
+    QList<qint64> timestamps = m_events.values();
+    const auto cutoff = timestamps.begin() + (m_capacity / 4);
+    std::nth_element(timestamps.begin(), cutoff, timestamps.end());
+
+    // Events sharing the cutoff timestamp are dropped too, the watermark covers them.
+    m_watermark = *cutoff;
+    m_events.removeIf([this](const QHash<QString, qint64>::iterator &it) {
+        return it.value() <= m_watermark;
+    });
+}
@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QHash>
+#include <QString>
+
+#include <limits>
+
+/**
+ * @class SeenNotifications
+ *
+ * The notifications that have already been handled for an account.
+ *
+ * The set holds at most a fixed number of events. When it is full the oldest
+ * events are dropped and the watermark is raised to their timestamp, so that
+ * anything at or before the watermark still counts as seen.
+ *
+ * @sa NotificationsManager
+ */
+class SeenNotifications
+{
+public:
+    explicit SeenNotifications(qsizetype capacity = 1000);
+
+    /**
+     * @brief Whether the given notification has already been seen.
+     */
+    [[nodiscard]] bool contains(const QString &eventId, qint64 timestamp) const;
+
+    /**
+     * @brief Mark the given notification as seen, dropping the oldest ones if the set is full.
+     */
+    void insert(const QString &eventId, qint64 timestamp);
+
+    [[nodiscard]] qsizetype size() const;
+
+    /**
+     * @brief The timestamp at or before which every notification counts as seen.
+     */
+    [[nodiscard]] qint64 watermark() const;
+
+private:
+    QHash<QString, qint64> m_events;
+    qint64 m_watermark = std::numeric_limits<qint64>::min();
+    qsizetype m_capacity;
+
+    void prune();
+};
@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "shortcodematcher.h"
+
+#include <QQueue>
+
+#include <algorithm>
+
+void ShortcodeMatcher::setPatterns(const QList<QString> &patterns)
+{
+    clear();
+    m_nodes.emplace_back();
+    m_patternLengths.reserve(patterns.size());
+
+    // Build the trie of the patterns.
+    for (int i = 0; i < patterns.size(); ++i) {
+        const auto &pattern = patterns[i];
+        m_patternLengths.append(pattern.size());
+        if (pattern.isEmpty()) {
+            continue;
+        }
+        int node = 0;
+        for (const auto c : pattern) {
+            const auto it = m_nodes[node].next.constFind(c.unicode());
+            if (it != m_nodes[node].next.constEnd()) {
+                node = *it;
+                continue;
+            }
+            const int child = m_nodes.size();
+            m_nodes[node].next.insert(c.unicode(), child);
+            m_nodes.emplace_back();
+            node = child;
+        }
+        // Keep the first of any duplicate patterns.
+        if (m_nodes[node].pattern < 0) {
+            m_nodes[node].pattern = i;
+        }
+    }
+
+    // Breadth first so that every fail link points at an already finished node.
+    QQueue<int> queue;
+    for (const auto child : std::as_const(m_nodes[0].next)) {
+        queue.enqueue(child);
+    }
+    while (!queue.isEmpty()) {
+        const int node = queue.dequeue();
+        for (auto it = m_nodes[node].next.constBegin(); it != m_nodes[node].next.constEnd(); ++it) {
+            const int child = it.value();
+            auto &childNode = m_nodes[child];
+            childNode.fail = step(m_nodes[node].fail, it.key());
+            const auto &fail = m_nodes[childNode.fail];
+            childNode.output = fail.pattern >= 0 ? childNode.fail : fail.output;
+            queue.enqueue(child);
+        }
+    }
+}
+
+void ShortcodeMatcher::clear()
+{
+    m_nodes.clear();
+    m_patternLengths.clear();
+}
+
+bool ShortcodeMatcher::isEmpty() const
+{
+    return m_nodes.size() <= 1;
+}
+
+int ShortcodeMatcher::step(int state, char16_t c) const
+{
+    while (true) {
+        const auto &next = m_nodes[state].next;
+        const auto it = next.constFind(c);
+        if (it != next.constEnd()) {
+            return *it;
+        }
+        if (state == 0) {
+            return 0;
+        }
+        state = m_nodes[state].fail;
+    }
+}
+
+QList<ShortcodeMatcher::Match> ShortcodeMatcher::matches(QStringView text) const
+{
+    QList<Match> found;
+    if (isEmpty()) {
+        return found;
+    }
+
+    int state = 0;
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        state = step(state, text[i].unicode());
+        for (int node = m_nodes[state].pattern >= 0 ? state : m_nodes[state].output; node >= 0; node = m_nodes[node].output) {
+            const auto pattern = m_nodes[node].pattern;
+            const auto length = m_patternLengths[pattern];
+            found.append({.start = i - length + 1, .length = length, .pattern = pattern});
+        }
+    }
+    if (found.size() <= 1) {
+        return found;
+    }
+
+    // Matches are found in order of where they end, pick the leftmost longest
+    // ones that don't overlap.
+    std::stable_sort(found.begin(), found.end(), [](const Match &a, const Match &b) {
+        return a.start != b.start ? a.start < b.start : a.length > b.length;
+    });
+    QList<Match> result;
+    qsizetype end = 0;
+    for (const auto &match : std::as_const(found)) {
+        if (match.start >= end) {
+            result.append(match);
+            end = match.start + match.length;
+        }
+    }
+    return result;
+}
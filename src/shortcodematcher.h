@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include <vector>
+
+/**
+ * @class ShortcodeMatcher
+ *
+ * Find every occurrence of a set of strings, e.g. custom emoji shortcodes, in a
+ * single pass over some text.
+ *
+ * This is an Aho-Corasick automaton, so the cost of a search depends on the length
+ * of the text and the number of matches rather than the number of patterns.
+ *
+ * @sa CustomEmojiModel
+ */
+class ShortcodeMatcher
+{
+public:
+    struct Match {
+        qsizetype start;
+        qsizetype length;
+        /**
+         * @brief The index of the pattern in the list passed to setPatterns().
+         */
+        int pattern;
+
+        bool operator==(const Match &) const = default;
+    };
+
+    /**
+     * @brief Replace the patterns to look for.
+     *
+     * Empty patterns are ignored. Matching is case sensitive.
+     */
+    void setPatterns(const QList<QString> &patterns);
+
+    void clear();
+
+    [[nodiscard]] bool isEmpty() const;
+
+    /**
+     * @brief The non-overlapping matches in the given text, in order.
+     *
+     * Where matches overlap the one that starts first wins, and then the longest.
+     */
+    [[nodiscard]] QList<Match> matches(QStringView text) const;
+
+private:
+    struct Node {
+        QHash<char16_t, int> next;
+        int fail = 0;
+        // The pattern ending at this node, or -1.
+        int pattern = -1;
+        // The nearest node along the fail links that ends a pattern, or -1.
+        int output = -1;
+    };
+    std::vector<Node> m_nodes;
+    QList<qsizetype> m_patternLengths;
+
+    int step(int state, char16_t c) const;
+};
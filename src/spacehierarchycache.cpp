@@ -3,6 +3,8 @@
 
 #include "spacehierarchycache.h"
 
+#include <QSet>
+
 #include <Quotient/csapi/space_hierarchy.h>
 #include <Quotient/qt_connection_util.h>
 
@@ -16,6 +18,7 @@ using namespace Quotient;
 
 SpaceHierarchyCache::SpaceHierarchyCache(QObject *parent)
     : QObject{parent}
+    , m_storedHierarchy(SpaceHierarchyStore::defaultPath(), KSharedConfig::openStateConfig(u"SpaceHierarchy"_s))
 {
 }
 
@@ -36,21 +39,13 @@ void SpaceHierarchyCache::cacheSpaceHierarchy()
                 &Room::baseStateLoaded,
                 neoChatRoom,
                 [this, neoChatRoom]() {
-                    if (neoChatRoom->isSpace()) {
+                    // The cache may have moved on to another account since.
+                    if (neoChatRoom->isSpace() && neoChatRoom->connection() == m_connection.get()) {
                         populateSpaceHierarchy(neoChatRoom->id());
                     }
                 },
                 Qt::SingleShotConnection);
         }
-
-        connect(neoChatRoom, &NeoChatRoom::unreadStatsChanged, this, [this, neoChatRoom]() {
-            if (neoChatRoom != nullptr) {
-                const auto parents = parentSpaces(neoChatRoom->id());
-                if (parents.count() > 0) {
-                    Q_EMIT spaceNotifcationCountChanged(parents);
-                }
-            }
-        });
     }
 }
 
@@ -62,8 +57,14 @@ void SpaceHierarchyCache::populateSpaceHierarchy(const QString &spaceId)
 
     m_nextBatchTokens[spaceId] = QString();
     auto job = m_connection->callApi<GetSpaceHierarchyJob>(spaceId, std::nullopt, std::nullopt, std::nullopt, *m_nextBatchTokens[spaceId]);
-    auto group = KConfigGroup(KSharedConfig::openStateConfig("SpaceHierarchy"_L1), "Cache"_L1);
-    m_spaceHierarchy.insert(spaceId, group.readEntry(spaceId, QStringList()));
+    const auto storedChildren = m_storedHierarchy.hierarchy().value(spaceId);
+    const auto &previousChildren = m_spaceHierarchy.children(spaceId);
+    const QSet<QString> stored(storedChildren.cbegin(), storedChildren.cend());
+    const QSet<QString> previous(previousChildren.cbegin(), previousChildren.cend());
+    const auto changedRooms = (stored - previous) | (previous - stored);
+    if (m_spaceHierarchy.setChildren(spaceId, storedChildren)) {
+        hierarchyChanged(changedRooms.values());
+    }
 
     connect(job, &BaseJob::success, this, [this, job, spaceId]() {
         addBatch(spaceId, job);
@@ -73,19 +74,22 @@ void SpaceHierarchyCache::populateSpaceHierarchy(const QString &spaceId)
 void SpaceHierarchyCache::addBatch(const QString &spaceId, Quotient::GetSpaceHierarchyJob *job)
 {
     const auto rooms = job->rooms();
-    QStringList roomList = m_spaceHierarchy[spaceId];
+    QStringList childIds;
     for (unsigned long i = 0; i < rooms.size(); ++i) {
         for (const auto &state : rooms[i].childrenState) {
-            if (!roomList.contains(state->stateKey())) {
-                roomList.push_back(state->stateKey());
-            }
+            childIds.push_back(state->stateKey());
         }
     }
-    m_spaceHierarchy.insert(spaceId, roomList);
-    Q_EMIT spaceHierarchyChanged();
-    auto group = KConfigGroup(KSharedConfig::openStateConfig("SpaceHierarchy"_L1), "Cache"_L1);
-    group.writeEntry(spaceId, roomList);
-    group.sync();
+    QSet<QString> addedRooms;
+    for (const auto &childId : std::as_const(childIds)) {
+        if (!m_spaceHierarchy.isChild(spaceId, childId)) {
+            addedRooms.insert(childId);
+        }
+    }
+    if (m_spaceHierarchy.addChildren(spaceId, childIds)) {
+        hierarchyChanged(addedRooms.values());
+        m_storedHierarchy.setChildren(spaceId, m_spaceHierarchy.children(spaceId));
+    }
 
     const auto nextBatchToken = job->nextBatch();
     if (!nextBatchToken.isEmpty() && nextBatchToken != *m_nextBatchTokens[spaceId] && m_connection) {
@@ -117,75 +121,54 @@ void SpaceHierarchyCache::addSpaceToHierarchy(Quotient::Room *room)
 void SpaceHierarchyCache::removeSpaceFromHierarchy(Quotient::Room *room)
 {
     const auto neoChatRoom = static_cast<NeoChatRoom *>(room);
-    if (neoChatRoom->isSpace()) {
-        m_spaceHierarchy.remove(neoChatRoom->id());
+    if (!neoChatRoom->isSpace()) {
+        return;
+    }
+    const auto removedRooms = m_spaceHierarchy.children(neoChatRoom->id());
+    if (m_spaceHierarchy.removeSpace(neoChatRoom->id())) {
+        hierarchyChanged(removedRooms);
     }
 }
 
-QStringList SpaceHierarchyCache::parentSpaces(const QString &roomId)
+void SpaceHierarchyCache::hierarchyChanged(const QStringList &changedRooms)
 {
-    auto spaces = m_spaceHierarchy.keys();
-    QStringList parents;
-    for (const auto &space : spaces) {
-        if (m_spaceHierarchy[space].contains(roomId)) {
-            parents += space;
-        }
+    Q_EMIT spaceHierarchyChanged();
+    if (!changedRooms.isEmpty()) {
+        Q_EMIT spaceChildrenChanged(changedRooms);
     }
-    return parents;
 }
 
-bool SpaceHierarchyCache::isSpaceChild(const QString &spaceId, const QString &roomId)
+QStringList SpaceHierarchyCache::parentSpaces(const QString &roomId) const
 {
-    return getRoomListForSpace(spaceId, false).contains(roomId);
+    return m_spaceHierarchy.parents(roomId);
 }
 
-QList<QString> &SpaceHierarchyCache::getRoomListForSpace(const QString &spaceId, bool updateCache)
+bool SpaceHierarchyCache::isSpaceChild(const QString &spaceId, const QString &roomId) const
+{
+    return m_spaceHierarchy.isChild(spaceId, roomId);
+}
+
+const QList<QString> &SpaceHierarchyCache::getRoomListForSpace(const QString &spaceId, bool updateCache)
 {
     if (updateCache) {
         populateSpaceHierarchy(spaceId);
     }
-    return m_spaceHierarchy[spaceId];
+    return m_spaceHierarchy.children(spaceId);
 }
 
 qsizetype SpaceHierarchyCache::notificationCountForSpace(const QString &spaceId)
 {
-    qsizetype notifications = 0;
-    auto children = m_spaceHierarchy[spaceId];
-    QStringList added;
-
-    for (const auto &childId : children) {
-        if (const auto child = static_cast<NeoChatRoom *>(m_connection->room(childId))) {
-            if (!added.contains(child->id())) {
-                notifications += child->contextAwareNotificationCount();
-                added += child->id();
-            }
-        }
-    }
-    return notifications;
+    return m_connection ? m_connection->spaceNotifications(spaceId) : 0;
 }
 
 bool SpaceHierarchyCache::spaceHasHighlightNotifications(const QString &spaceId)
 {
-    auto children = m_spaceHierarchy[spaceId];
-    for (const auto &childId : children) {
-        if (const auto child = static_cast<NeoChatRoom *>(m_connection->room(childId))) {
-            if (child->highlightCount() > 0) {
-                return true;
-            }
-        }
-    }
-    return false;
+    return m_connection && m_connection->spaceHaveHighlightNotifications(spaceId);
 }
 
 bool SpaceHierarchyCache::isChild(const QString &roomId) const
 {
-    const auto childrens = m_spaceHierarchy.values();
-    for (const auto &children : childrens) {
-        if (children.contains(roomId)) {
-            return true;
-        }
-    }
-    return false;
+    return m_spaceHierarchy.hasParent(roomId);
 }
 
 NeoChatConnection *SpaceHierarchyCache::connection() const
@@ -198,12 +181,23 @@ void SpaceHierarchyCache::setConnection(NeoChatConnection *connection)
     if (m_connection == connection) {
         return;
     }
+    if (m_connection) {
+        disconnect(m_connection, nullptr, this, nullptr);
+    }
     m_connection = connection;
     Q_EMIT connectionChanged();
-    m_spaceHierarchy.clear();
+    if (!m_spaceHierarchy.isEmpty()) {
+        const auto childRooms = m_spaceHierarchy.childRooms();
+        m_spaceHierarchy.clear();
+        hierarchyChanged(childRooms);
+    }
+    if (!connection) {
+        return;
+    }
     cacheSpaceHierarchy();
     connect(connection, &Connection::joinedRoom, this, &SpaceHierarchyCache::addSpaceToHierarchy);
     connect(connection, &Connection::aboutToDeleteRoom, this, &SpaceHierarchyCache::removeSpaceFromHierarchy);
+    connect(connection, &NeoChatConnection::spaceNotificationsChanged, this, &SpaceHierarchyCache::spaceNotifcationCountChanged);
 }
 
 QString SpaceHierarchyCache::recommendedSpaceId() const
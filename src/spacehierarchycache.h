@@ -10,6 +10,9 @@
 #include <QQmlEngine>
 #include <QString>
 
+#include "spacehierarchyindex.h"
+#include "spacehierarchystore.h"
+
 namespace Quotient
 {
 class Room;
@@ -53,17 +56,17 @@ public:
     /**
      * @brief Returns the list of parent spaces for a child if any.
      */
-    QStringList parentSpaces(const QString &roomId);
+    QStringList parentSpaces(const QString &roomId) const;
 
     /**
      * @brief Whether the given room is a member of the given space.
      */
-    Q_INVOKABLE bool isSpaceChild(const QString &spaceId, const QString &roomId);
+    Q_INVOKABLE bool isSpaceChild(const QString &spaceId, const QString &roomId) const;
 
     /**
      * @brief Return the list of child rooms for the given space ID.
      */
-    [[nodiscard]] QList<QString> &getRoomListForSpace(const QString &spaceId, bool updateCache);
+    [[nodiscard]] const QList<QString> &getRoomListForSpace(const QString &spaceId, bool updateCache);
 
     /**
      * @brief Return the number of notifications for the child rooms in a given space ID.
@@ -97,6 +100,15 @@ public:
 
 Q_SIGNALS:
     void spaceHierarchyChanged();
+
+    /**
+     * @brief The parent spaces of the given rooms may have changed.
+     *
+     * Emitted along with spaceHierarchyChanged() so that anything depending on a
+     * room's spaces only has to update those rooms.
+     */
+    void spaceChildrenChanged(const QStringList &roomIds);
+
     void connectionChanged();
     void spaceNotifcationCountChanged(const QStringList &spaces);
     void recommendedSpaceHiddenChanged();
@@ -109,9 +121,16 @@ private:
     explicit SpaceHierarchyCache(QObject *parent = nullptr);
 
     QList<QString> m_activeSpaceRooms;
-    QHash<QString, QList<QString>> m_spaceHierarchy;
+    SpaceHierarchyIndex m_spaceHierarchy;
     void cacheSpaceHierarchy();
 
+    /**
+     * @brief Emit spaceHierarchyChanged() and spaceChildrenChanged() for the given rooms.
+     */
+    void hierarchyChanged(const QStringList &changedRooms);
+
+    SpaceHierarchyStore m_storedHierarchy;
+
     QHash<QString, std::optional<QString>> m_nextBatchTokens;
     void populateSpaceHierarchy(const QString &spaceId);
     void addBatch(const QString &spaceId, Quotient::GetSpaceHierarchyJob *job);
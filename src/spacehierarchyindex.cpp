@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "spacehierarchyindex.h"
+
+const QList<QString> &SpaceHierarchyIndex::children(const QString &spaceId) const
+{
+    static const QList<QString> empty;
+    const auto it = m_spaces.constFind(spaceId);
+    return it != m_spaces.constEnd() ? it->children : empty;
+}
+
+bool SpaceHierarchyIndex::setChildren(const QString &spaceId, const QList<QString> &children)
+{
+    const auto it = m_spaces.constFind(spaceId);
+    if (it != m_spaces.constEnd() && it->children == children) {
+        return false;
+    }
+    const auto existed = it != m_spaces.constEnd();
+    removeSpace(spaceId);
+    m_spaces.insert(spaceId, {});
+    addChildren(spaceId, children);
+    return existed || !children.isEmpty();
+}
+
+bool SpaceHierarchyIndex::addChildren(const QString &spaceId, const QList<QString> &children)
+{
+    auto &space = m_spaces[spaceId];
+    bool added = false;
+    for (const auto &child : children) {
+        if (space.childSet.contains(child)) {
+            continue;
+        }
+        space.childSet.insert(child);
+        space.children.append(child);
+        addParent(child, spaceId);
+        added = true;
+    }
+    return added;
+}
+
+bool SpaceHierarchyIndex::removeSpace(const QString &spaceId)
+{
+    const auto it = m_spaces.constFind(spaceId);
+    if (it == m_spaces.constEnd()) {
+        return false;
+    }
+    for (const auto &child : it->children) {
+        removeParent(child, spaceId);
+    }
+    m_spaces.erase(it);
+    return true;
+}
+
+void SpaceHierarchyIndex::clear()
+{
+    m_spaces.clear();
+    m_parents.clear();
+}
+
+bool SpaceHierarchyIndex::isEmpty() const
+{
+    return m_spaces.isEmpty();
+}
+
+bool SpaceHierarchyIndex::isChild(const QString &spaceId, const QString &roomId) const
+{
+    const auto it = m_spaces.constFind(spaceId);
+    return it != m_spaces.constEnd() && it->childSet.contains(roomId);
+}
+
+bool SpaceHierarchyIndex::hasParent(const QString &roomId) const
+{
+    return m_parents.contains(roomId);
+}
+
+QStringList SpaceHierarchyIndex::parents(const QString &roomId) const
+{
+    return m_parents.value(roomId);
+}
+
+QStringList SpaceHierarchyIndex::childRooms() const
+{
+    return m_parents.keys();
+}
+
+void SpaceHierarchyIndex::addParent(const QString &roomId, const QString &spaceId)
+{
+    m_parents[roomId].append(spaceId);
+}
+
+void SpaceHierarchyIndex::removeParent(const QString &roomId, const QString &spaceId)
+{
+    const auto it = m_parents.find(roomId);
+    if (it == m_parents.end()) {
+        return;
+    }
+    it->removeOne(spaceId);
+    if (it->isEmpty()) {
+        m_parents.erase(it);
+    }
+}
@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @class SpaceHierarchyIndex
+ *
+ * The child rooms of each space along with a reverse index of the parent spaces
+ * of each room.
+ *
+ * The ordered child list for each space is kept so that it can be stored and
+ * presented as received, while membership queries are answered from hashed sets
+ * so that they don't need to scan every space's child list.
+ *
+ * @sa SpaceHierarchyCache
+ */
+class SpaceHierarchyIndex
+{
+public:
+    /**
+     * @brief The child rooms of the given space in the order they were added.
+     */
+    [[nodiscard]] const QList<QString> &children(const QString &spaceId) const;
+
+    /**
+     * @brief Replace the child rooms of the given space.
+     *
+     * @return Whether the children changed.
+     */
+    bool setChildren(const QString &spaceId, const QList<QString> &children);
+
+    /**
+     * @brief Append any of the given rooms that aren't already children of the given space.
+     *
+     * @return Whether any children were added.
+     */
+    bool addChildren(const QString &spaceId, const QList<QString> &children);
+
+    /**
+     * @brief Remove the given space and its children from the index.
+     *
+     * @return Whether the space was in the index.
+     */
+    bool removeSpace(const QString &spaceId);
+
+    void clear();
+
+    [[nodiscard]] bool isEmpty() const;
+
+    /**
+     * @brief Whether the given room is a child of the given space.
+     */
+    [[nodiscard]] bool isChild(const QString &spaceId, const QString &roomId) const;
+
+    /**
+     * @brief Whether the given room is a child of any space.
+     */
+    [[nodiscard]] bool hasParent(const QString &roomId) const;
+
+    /**
+     * @brief The spaces that the given room is a child of.
+     */
+    [[nodiscard]] QStringList parents(const QString &roomId) const;
+
+    /**
+     * @brief Every room that is a child of at least one space.
+     */
+    [[nodiscard]] QStringList childRooms() const;
+
+private:
+    struct Space {
+        QList<QString> children;
+        QSet<QString> childSet;
+    };
+    QHash<QString, Space> m_spaces;
+    QHash<QString, QStringList> m_parents;
+
+    void addParent(const QString &roomId, const QString &spaceId);
+    void removeParent(const QString &roomId, const QString &spaceId);
+};
@@ -0,0 +1,139 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "spacehierarchystore.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <KConfigGroup>
+
+using namespace Qt::StringLiterals;
+
+namespace
+{
+constexpr quint32 Magic = 0x4e435348;
+constexpr quint32 Version = 1;
+}
+
+SpaceHierarchyStore::SpaceHierarchyStore(const QString &path, KSharedConfig::Ptr legacyConfig, QObject *parent)
+    : QObject(parent)
+    , m_path(path)
+    , m_legacyConfig(std::move(legacyConfig))
+{
+    // Pages of every space arrive in quick succession when logging in so gather them into one write.
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(1000);
+    connect(&m_saveTimer, &QTimer::timeout, this, &SpaceHierarchyStore::save);
+    if (const auto app = QCoreApplication::instance()) {
+        connect(app, &QCoreApplication::aboutToQuit, this, [this]() {
+            if (isSavePending()) {
+                save();
+            }
+        });
+    }
+}
+
+SpaceHierarchyStore::~SpaceHierarchyStore()
+{
+    if (isSavePending()) {
+        save();
+    }
+}
+
+QString SpaceHierarchyStore::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + u"/spacehierarchy"_s;
+}
+
+const QHash<QString, QStringList> &SpaceHierarchyStore::hierarchy()
+{
+    if (m_loaded) {
+        return m_hierarchy;
+    }
+    m_loaded = true;
+
+    QFile file(m_path);
+    if (file.open(QIODevice::ReadOnly)) {
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_6_5);
+        quint32 magic = 0;
+        quint32 version = 0;
+        stream >> magic >> version;
+        if (magic == Magic && version == Version) {
+            stream >> m_hierarchy;
+            if (stream.status() == QDataStream::Ok) {
+                return m_hierarchy;
+            }
+        }
+        qWarning() << "Ignoring invalid space hierarchy cache" << file.fileName();
+        m_hierarchy.clear();
+    }
+
+    // Earlier versions stored the hierarchy in a state config file, move it to the binary cache.
+    if (!m_legacyConfig) {
+        return m_hierarchy;
+    }
+    const auto group = m_legacyConfig->group(u"Cache"_s);
+    const auto spaceIds = group.keyList();
+    for (const auto &spaceId : spaceIds) {
+        m_hierarchy.insert(spaceId, group.readEntry(spaceId, QStringList()));
+    }
+    if (!spaceIds.isEmpty()) {
+        m_migrateLegacyConfig = true;
+        m_saveTimer.start();
+    }
+    return m_hierarchy;
+}
+
+void SpaceHierarchyStore::setChildren(const QString &spaceId, const QStringList &children)
+{
+    // Make sure the stored hierarchy is loaded before changing it.
+    hierarchy();
+    m_hierarchy.insert(spaceId, children);
+    if (!m_saveTimer.isActive()) {
+        m_saveTimer.start();
+    }
+}
+
+bool SpaceHierarchyStore::isSavePending() const
+{
+    return m_saveTimer.isActive();
+}
+
+bool SpaceHierarchyStore::save()
+{
+    m_saveTimer.stop();
+    // Nothing can have changed, don't replace the file with an empty hierarchy.
+    if (!m_loaded) {
+        return true;
+    }
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to save space hierarchy cache" << m_path << file.errorString();
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_5);
+    stream << Magic << Version << m_hierarchy;
+    if (!file.commit()) {
+        qWarning() << "Failed to save space hierarchy cache" << m_path << file.errorString();
+        return false;
+    }
+
+    if (m_migrateLegacyConfig) {
+        m_migrateLegacyConfig = false;
+        m_legacyConfig->deleteGroup(u"Cache"_s);
+        m_legacyConfig->sync();
+    }
+    return true;
+}
+
+#include "moc_spacehierarchystore.cpp"
@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include <KSharedConfig>
+
+/**
+ * @class SpaceHierarchyStore
+ *
+ * The child rooms of every space seen, persisted between runs.
+ *
+ * The hierarchy is kept in a binary QDataStream file which is read in one go the
+ * first time it is needed. Changes start a one second single-shot timer so that
+ * all the changes made in a burst of updates result in a single write. A pending
+ * write is done on quit and when the store is destroyed.
+ *
+ * Earlier versions stored the hierarchy in the "Cache" group of a state config.
+ * If the file doesn't exist that group is read instead, and removed once the
+ * hierarchy has been written to the file.
+ */
+class SpaceHierarchyStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param path the file the hierarchy is stored in.
+     * @param legacyConfig the state config earlier versions stored the hierarchy in.
+     */
+    explicit SpaceHierarchyStore(const QString &path, KSharedConfig::Ptr legacyConfig, QObject *parent = nullptr);
+    ~SpaceHierarchyStore() override;
+
+    /**
+     * @brief The file in the cache directory used by NeoChat.
+     */
+    static QString defaultPath();
+
+    /**
+     * @brief The child rooms of every space, loaded the first time this is called.
+     */
+    const QHash<QString, QStringList> &hierarchy();
+
+    /**
+     * @brief Set the child rooms of the given space and schedule a write.
+     */
+    void setChildren(const QString &spaceId, const QStringList &children);
+
+    /**
+     * @brief Whether there are changes that haven't been written yet.
+     */
+    [[nodiscard]] bool isSavePending() const;
+
+    /**
+     * @brief Write the hierarchy now.
+     *
+     * @return false if the file couldn't be written.
+     */
+    bool save();
+
+private:
+    QString m_path;
+    KSharedConfig::Ptr m_legacyConfig;
+
+    QHash<QString, QStringList> m_hierarchy;
+    bool m_loaded = false;
+    bool m_migrateLegacyConfig = false;
+
+    QTimer m_saveTimer;
+};
@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "statesavescheduler.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+#ifdef HAVE_KDBUSADDONS
+#include <QDBusConnection>
+#endif
+
+#include <Quotient/connection.h>
+#include <Quotient/room.h>
+
+#include "neochatconfig.h"
+#include "statesave_logging.h"
+
+using namespace Quotient;
+using namespace Qt::StringLiterals;
+
+StateSaveScheduler::StateSaveScheduler(Connection *connection)
+    : QObject(connection)
+    , m_connection(connection)
+{
+    Q_ASSERT(connection);
+
+    // Stop libQuotient from writing each room as soon as it changes, flush()
+    // turns caching back on while it writes the state.
+    connection->setCacheState(false);
+
+    // Not restarted by later changes, otherwise a busy account would never be saved.
+    m_saveTimer.setSingleShot(true);
+    setInterval(std::chrono::seconds(NeoChatConfig::stateSaveInterval()));
+    connect(&m_saveTimer, &QTimer::timeout, this, &StateSaveScheduler::flush);
+    connect(NeoChatConfig::self(), &NeoChatConfig::StateSaveIntervalChanged, this, [this]() {
+        setInterval(std::chrono::seconds(NeoChatConfig::stateSaveInterval()));
+    });
+
+    for (const auto room : connection->allRooms()) {
+        trackRoom(room);
+    }
+    connect(connection, &Connection::newRoom, this, &StateSaveScheduler::trackRoom);
+    connect(connection, &Connection::aboutToDeleteRoom, this, [this](Room *room) {
+        m_dirtyRooms.remove(room->id());
+    });
+    // The sync token and account data are in the top level state.
+    connect(connection, &Connection::syncDone, this, &StateSaveScheduler::markDirty);
+    // Don't write the cache of an account that is no longer logged in.
+    connect(connection, &Connection::loggedOut, this, &StateSaveScheduler::cancel);
+
+    if (const auto app = QCoreApplication::instance()) {
+        connect(app, &QCoreApplication::aboutToQuit, this, &StateSaveScheduler::flush);
+    }
+#ifdef HAVE_KDBUSADDONS
+    QDBusConnection::systemBus().connect(u"org.freedesktop.login1"_s,
+                                         u"/org/freedesktop/login1"_s,
+                                         u"org.freedesktop.login1.Manager"_s,
+                                         u"PrepareForSleep"_s,
+                                         this,
+                                         SLOT(prepareForSleep(bool)));
+#endif
+}
+
+void StateSaveScheduler::trackRoom(Room *room)
+{
+    connect(room, &Room::changed, this, [this, room]() {
+        m_dirtyRooms.insert(room->id(), room);
+        markDirty();
+    });
+}
+
+void StateSaveScheduler::markDirty()
+{
+    m_stateDirty = true;
+    if (!m_saveTimer.isActive()) {
+        m_saveTimer.start();
+    }
+}
+
+void StateSaveScheduler::cancel()
+{
+    m_saveTimer.stop();
+    m_dirtyRooms.clear();
+    m_stateDirty = false;
+    deleteLater();
+}
+
+bool StateSaveScheduler::isPending() const
+{
+    return m_stateDirty;
+}
+
+void StateSaveScheduler::setInterval(std::chrono::milliseconds interval)
+{
+    m_saveTimer.setInterval(std::max(interval, std::chrono::milliseconds::zero()));
+}
+
+void StateSaveScheduler::flush()
+{
+    m_saveTimer.stop();
+    if (!m_stateDirty || !m_connection) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QStringList roomIds;
+    m_connection->setCacheState(true);
+    for (auto it = m_dirtyRooms.cbegin(); it != m_dirtyRooms.cend(); ++it) {
+        if (it.value()) {
+            m_connection->saveRoomState(it.value());
+            roomIds += it.key();
+        }
+    }
+    m_connection->saveState();
+    m_connection->setCacheState(false);
+    m_dirtyRooms.clear();
+    m_stateDirty = false;
+
+    const auto msecs = timer.elapsed();
+    qCDebug(StateSave) << "Saved the state of" << m_connection->userId() << "and" << roomIds.size() << "rooms in" << msecs << "ms";
+    Q_EMIT saved(roomIds, msecs);
+}
+
+void StateSaveScheduler::prepareForSleep(bool sleeping)
+{
+    if (sleeping) {
+        flush();
+    }
+}
+
+#include "moc_statesavescheduler.cpp"
@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include <chrono>
+
+namespace Quotient
+{
+class Connection;
+class Room;
+}
+
+/**
+ * @class StateSaveScheduler
+ *
+ * Save the cached state of a connection in batches rather than after every sync.
+ *
+ * The rooms that changed since the last save are tracked so that only those are
+ * written. Changes are gathered for NeoChatConfig::stateSaveInterval() seconds
+ * before saving, and any pending changes are saved straight away when the
+ * application quits or the system is about to suspend. A pending save is
+ * dropped when the account logs out.
+ *
+ * libQuotient would otherwise write a room's state after every change to it,
+ * so the scheduler turns off the connection's cacheState and only turns it on
+ * while it saves.
+ *
+ * The scheduler is owned by the connection it saves.
+ */
+class StateSaveScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StateSaveScheduler(Quotient::Connection *connection);
+
+    /**
+     * @brief Whether there are changes that haven't been saved yet.
+     */
+    [[nodiscard]] bool isPending() const;
+
+    /**
+     * @brief Save any pending changes now.
+     */
+    void flush();
+
+    /**
+     * @brief Set the time to gather changes for before saving.
+     */
+    void setInterval(std::chrono::milliseconds interval);
+
+Q_SIGNALS:
+    /**
+     * @brief The pending changes have been saved.
+     *
+     * @param roomIds the IDs of the rooms that were saved.
+     * @param msecs how long the save took.
+     */
+    void saved(const QStringList &roomIds, qint64 msecs);
+
+private Q_SLOTS:
+    void prepareForSleep(bool sleeping);
+
+private:
+    QPointer<Quotient::Connection> m_connection;
+    QHash<QString, QPointer<Quotient::Room>> m_dirtyRooms;
+    bool m_stateDirty = false;
+    QTimer m_saveTimer;
+
+    void trackRoom(Quotient::Room *room);
+    void markDirty();
+    void cancel();
+};
@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "textfilepreview.h"
+
+#include <QFile>
+#include <QStringDecoder>
+
+#include <algorithm>
+
+#include "backgroundtask.h"
+
+namespace
+{
+constexpr qint64 ChunkSize = 64 * 1024;
+}
+
+TextFilePreview::Preview TextFilePreview::read(const QString &path, qint64 maxSize)
+{
+    Preview preview;
+    QFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return preview;
+    }
+
+    // The decoder keeps any multi-byte sequence split between chunks.
+    QStringDecoder decoder(QStringDecoder::Utf8);
+    QByteArray chunk;
+    qint64 remaining = maxSize;
+    while (remaining > 0) {
+        chunk = file.read(std::min(remaining, ChunkSize));
+        if (chunk.isEmpty()) {
+            break;
+        }
+        preview.text += decoder.decode(chunk);
+        remaining -= chunk.size();
+    }
+
+    preview.truncated = remaining <= 0 && !file.atEnd();
+    if (preview.truncated) {
+        // Don't end on half a line.
+        const auto lastNewline = preview.text.lastIndexOf(u'\n');
+        if (lastNewline >= 0) {
+            preview.text.truncate(lastNewline + 1);
+        }
+    }
+    return preview;
+}
+
+QFuture<TextFilePreview::Preview> TextFilePreview::forFile(const QString &path)
+{
+    return BackgroundTask::run([path]() {
+        return read(path);
+    });
+}
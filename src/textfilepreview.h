@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QFuture>
+#include <QString>
+
+/**
+ * @brief Read the start of a downloaded text file to show in the timeline.
+ *
+ * Only the first MaxSize bytes are read so that a large log or source file
+ * doesn't have to be loaded and laid out in full.
+ */
+namespace TextFilePreview
+{
+
+/**
+ * @brief The maximum number of bytes read from a file.
+ */
+constexpr qint64 MaxSize = 256 * 1024;
+
+struct Preview {
+    QString text;
+
+    /**
+     * @brief Whether the file is longer than the text.
+     */
+    bool truncated = false;
+};
+
+/**
+ * @brief Read up to maxSize bytes of the UTF-8 file at the given path.
+ *
+ * If the file is longer the text is cut at the last complete line. An empty
+ * preview is returned if the file can't be read.
+ */
+Preview read(const QString &path, qint64 maxSize = MaxSize);
+
+/**
+ * @brief Call read() on a thread pool thread.
+ */
+QFuture<Preview> forFile(const QString &path);
+}
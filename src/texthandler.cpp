@@ -10,6 +10,8 @@
 #include <QTextBlock>
 #include <QUrl>
 
+#include <utility>
+
 #include <Quotient/events/roommessageevent.h>
 #include <Quotient/util.h>
 
@@ -38,6 +40,65 @@ static const QStringList blockTags = {u"blockquote"_s, u"p"_s, u"ul"_s, u"ol"_s,
 
 static const QString customEmojiStyle = u"vertical-align:bottom"_s;
 
+/**
+ * Return the index of the first of any of the given characters in string at or after from, -1 if none are found.
+ */
+static qsizetype indexOfAny(QStringView string, QStringView characters, qsizetype from)
+{
+    for (qsizetype i = from; i < string.size(); ++i) {
+        if (characters.contains(string[i])) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Append text to output with < and > escaped, the same as escapeHtml() but without copying the text.
+ */
+static void appendEscapedHtml(QString &output, QStringView text)
+{
+    qsizetype runStart = 0;
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        if (text[i] == u'<' || text[i] == u'>') {
+            output.append(text.sliced(runStart, i - runStart));
+            output.append(text[i] == u'<' ? "&lt;"_L1 : "&gt;"_L1);
+            runStart = i + 1;
+        }
+    }
+    output.append(text.sliced(runStart));
+}
+
+/**
+ * Replace <del>...</del> pairs with <s>...</s> in output from the given position.
+ *
+ * This gives the same result as replacing "<del>(.*?)</del>" with "<s>\1</s>" once the
+ * output is complete but is done as each tag is appended. openDelPos holds the position
+ * of the first unmatched <del> and must persist between calls.
+ */
+static void convertStrikethrough(QString &output, qsizetype from, qsizetype &openDelPos)
+{
+    qsizetype pos = from;
+    while (pos < output.size()) {
+        if (openDelPos == -1) {
+            openDelPos = output.indexOf("<del>"_L1, pos);
+            if (openDelPos == -1) {
+                return;
+            }
+            pos = openDelPos + 5;
+        } else {
+            const auto closePos = output.indexOf("</del>"_L1, pos);
+            if (closePos == -1) {
+                return;
+            }
+            output.replace(closePos, 6, "</s>"_L1);
+            output.replace(openDelPos, 5, "<s>"_L1);
+            pos = closePos + 2;
+            openDelPos = -1;
+        }
+    }
+}
+
 QString TextHandler::data() const
 {
     return m_data;
@@ -51,40 +112,36 @@ void TextHandler::setData(const QString &string)
 
 QString TextHandler::handleSendText()
 {
-    m_pos = 0;
     m_dataBuffer = markdownToHTML(m_data);
 
-    m_nextTokenType = nextTokenType(m_dataBuffer, m_pos, m_nextToken, m_nextTokenType);
-
     // Strip any disallowed tags/attributes.
     QString outputString;
+    outputString.reserve(m_dataBuffer.size());
+    startTokens();
     while (m_pos < m_dataBuffer.length()) {
         next();
 
-        QString nextTokenBuffer = m_nextToken;
         switch (m_nextTokenType) {
         case Text:
-            nextTokenBuffer = escapeHtml(nextTokenBuffer);
-            nextTokenBuffer = CustomEmojiModel::instance().preprocessText(nextTokenBuffer);
+            outputString.append(CustomEmojiModel::instance().preprocessText(escapeHtml(m_nextToken.toString())));
             break;
         case TextCode:
-            nextTokenBuffer = escapeHtml(nextTokenBuffer);
+            appendEscapedHtml(outputString, m_nextToken);
             break;
         case Tag:
-            if (!isAllowedTag(getTagType(m_nextToken))) {
-                nextTokenBuffer = QString();
+            if (const auto tagType = getTagType(m_nextToken); isAllowedTag(tagType)) {
+                outputString.append(cleanAttributes(tagType, m_nextToken));
             }
-            nextTokenBuffer = cleanAttributes(getTagType(m_nextToken), nextTokenBuffer);
+            break;
         default:
+            outputString.append(m_nextToken);
             break;
         }
 
-        outputString.append(nextTokenBuffer);
-
         m_nextTokenType = nextTokenType(m_dataBuffer, m_pos, m_nextToken, m_nextTokenType);
     }
 
-    if (outputString.count("<p>"_L1) == 1 && outputString.count("</p>"_L1) == 1 && outputString.startsWith("<p>"_L1) && outputString.endsWith("</p>"_L1)) {
+    if (outputString.startsWith("<p>"_L1) && outputString.endsWith("</p>"_L1) && outputString.count("<p>"_L1) == 1 && outputString.count("</p>"_L1) == 1) {
         outputString.remove("<p>"_L1);
         outputString.remove("</p>"_L1);
     }
@@ -95,11 +152,14 @@ QString TextHandler::handleSendText()
 QString
 TextHandler::handleRecieveRichText(Qt::TextFormat inputFormat, const NeoChatRoom *room, const Quotient::RoomEvent *event, bool stripNewlines, bool isEdited)
 {
-    m_pos = 0;
     m_dataBuffer = m_data;
+    m_links.clear();
+    m_linkSet.clear();
 
     // Strip mx-reply if present.
-    m_dataBuffer.remove(TextRegex::removeRichReply);
+    if (m_dataBuffer.contains("<mx-reply>"_L1)) {
+        m_dataBuffer.remove(TextRegex::removeRichReply);
+    }
 
     // For plain text, convert links, escape html and convert line brakes.
     if (inputFormat == Qt::PlainText) {
@@ -111,10 +171,12 @@ TextHandler::handleRecieveRichText(Qt::TextFormat inputFormat, const NeoChatRoom
     m_dataBuffer = linkifyUrls(m_dataBuffer);
 
     // Apply user style
-    m_dataBuffer.replace(TextRegex::userPill, uR"(<b>\1</b>)"_s);
+    if (m_dataBuffer.contains("<a href=\"https://matrix.to/#/@"_L1)) {
+        m_dataBuffer.replace(TextRegex::userPill, uR"(<b>\1</b>)"_s);
+    }
 
     // Make all media URLs resolvable.
-    if (room && event) {
+    if (room && event && m_dataBuffer.contains("src=\"mxc://"_L1)) {
         QRegularExpressionMatchIterator i = TextRegex::mxcImage.globalMatch(m_dataBuffer);
         while (i.hasNext()) {
             const QRegularExpressionMatch match = i.next();
@@ -135,26 +197,37 @@ TextHandler::handleRecieveRichText(Qt::TextFormat inputFormat, const NeoChatRoom
         }
     }
 
-    // Strip any disallowed tags/attributes.
+    // Strip any disallowed tags/attributes, escape the text and replace <del> with <s>
+    // in a single pass, appending straight to the output.
+    //
+    // Note: <s> is still not a valid tag for the message from the server. We
+    // convert as that is what is needed for Qt::RichText.
     QString outputString;
-    m_nextTokenType = nextTokenType(m_dataBuffer, m_pos, m_nextToken, m_nextTokenType);
+    outputString.reserve(m_dataBuffer.size());
+    qsizetype openDelPos = -1;
+    startTokens();
     while (m_pos < m_dataBuffer.length()) {
         next();
 
-        QString nextTokenBuffer = m_nextToken;
         if (m_nextTokenType == Type::Text || m_nextTokenType == Type::TextCode) {
-            nextTokenBuffer = escapeHtml(nextTokenBuffer);
+            appendEscapedHtml(outputString, m_nextToken);
         } else if (m_nextTokenType == Type::Tag) {
-            if (!isAllowedTag(getTagType(m_nextToken))) {
-                nextTokenBuffer = QString();
-            } else if ((getTagType(m_nextToken) == u"br"_s && stripNewlines)) {
-                nextTokenBuffer = u' ';
+            const auto tagType = getTagType(m_nextToken);
+            if (tagType == "br"_L1 && stripNewlines) {
+                outputString.append(u' ');
+            } else if (isAllowedTag(tagType)) {
+                const auto tagStart = outputString.size();
+                if (m_nextToken.indexOf(u' ', 1) == -1) {
+                    outputString.append(m_nextToken);
+                } else {
+                    outputString.append(cleanAttributes(tagType, m_nextToken));
+                }
+                convertStrikethrough(outputString, tagStart, openDelPos);
             }
-            nextTokenBuffer = cleanAttributes(getTagType(m_nextToken), nextTokenBuffer);
+        } else {
+            outputString.append(m_nextToken);
         }
 
-        outputString.append(nextTokenBuffer);
-
         m_nextTokenType = nextTokenType(m_dataBuffer, m_pos, m_nextToken, m_nextTokenType);
     }
 
@@ -169,14 +242,7 @@ TextHandler::handleRecieveRichText(Qt::TextFormat inputFormat, const NeoChatRoom
         }
     }
 
-    /**
-     * Replace <del> with <s>
-     * Note: <s> is still not a valid tag for the message from the server. We
-     * convert as that is what is needed for Qt::RichText.
-     */
-    outputString.replace(TextRegex::strikethrough, u"<s>\\1</s>"_s);
-
-    if (outputString.count("<p>"_L1) == 1 && outputString.count("</p>"_L1) == 1 && outputString.startsWith("<p>"_L1) && outputString.endsWith("</p>"_L1)) {
+    if (outputString.startsWith("<p>"_L1) && outputString.endsWith("</p>"_L1) && outputString.count("<p>"_L1) == 1 && outputString.count("</p>"_L1) == 1) {
         outputString.remove("<p>"_L1);
         outputString.remove("</p>"_L1);
     }
@@ -186,11 +252,12 @@ TextHandler::handleRecieveRichText(Qt::TextFormat inputFormat, const NeoChatRoom
 
 QString TextHandler::handleRecievePlainText(Qt::TextFormat inputFormat, const bool &stripNewlines)
 {
-    m_pos = 0;
     m_dataBuffer = m_data;
 
     // Strip mx-reply if present.
-    m_dataBuffer.remove(TextRegex::removeRichReply);
+    if (m_dataBuffer.contains("<mx-reply>"_L1)) {
+        m_dataBuffer.remove(TextRegex::removeRichReply);
+    }
 
     // Escaping then unescaping allows < and > to be maintained in a plain text string
     // otherwise markdownToHTML will strip what it thinks is a bad html tag entirely.
@@ -218,23 +285,21 @@ QString TextHandler::handleRecievePlainText(Qt::TextFormat inputFormat, const bo
 
     // Strip all tags/attributes except code blocks which will be escaped.
     QString outputString;
-    m_nextTokenType = nextTokenType(m_dataBuffer, m_pos, m_nextToken, m_nextTokenType);
+    outputString.reserve(m_dataBuffer.size());
+    startTokens();
     while (m_pos < m_dataBuffer.length()) {
         next();
 
-        QString nextTokenBuffer = m_nextToken;
         if (m_nextTokenType == Type::TextCode) {
-            nextTokenBuffer = unescapeHtml(nextTokenBuffer);
+            outputString.append(unescapeHtml(m_nextToken.toString()));
         } else if (m_nextTokenType == Type::Tag) {
-            if (getTagType(m_nextToken) == u"br"_s && !stripNewlines) {
-                nextTokenBuffer = u'\n';
-            } else {
-                nextTokenBuffer = QString();
+            if (getTagType(m_nextToken) == "br"_L1 && !stripNewlines) {
+                outputString.append(u'\n');
             }
+        } else {
+            outputString.append(m_nextToken);
         }
 
-        outputString.append(nextTokenBuffer);
-
         m_nextTokenType = nextTokenType(m_dataBuffer, m_pos, m_nextToken, m_nextTokenType);
     }
 
@@ -246,37 +311,45 @@ QString TextHandler::handleRecievePlainText(Qt::TextFormat inputFormat, const bo
     return outputString;
 }
 
+void TextHandler::startTokens()
+{
+    m_pos = 0;
+    m_nextToken = {};
+    m_nextTokenType = nextTokenType(m_dataBuffer, m_pos, {}, Type::Text);
+}
+
 void TextHandler::next()
 {
-    QString searchStr;
+    QStringView searchStr;
     if (m_nextTokenType == Type::Tag) {
-        searchStr = u'>';
+        searchStr = u">";
     } else if (m_nextTokenType == Type::TextCode) {
         // Anything between code tags is assumed to be plain text
-        searchStr = u"</code>"_s;
+        searchStr = u"</code>";
     } else {
-        searchStr = u'<';
+        searchStr = u"<";
     }
 
-    int tokenEnd = m_dataBuffer.indexOf(searchStr, m_pos + 1);
+    const QStringView buffer(m_dataBuffer);
+    qsizetype tokenEnd = buffer.indexOf(searchStr, m_pos + 1);
     if (tokenEnd == -1) {
-        tokenEnd = m_dataBuffer.length();
+        tokenEnd = buffer.length();
     }
 
-    m_nextToken = m_dataBuffer.mid(m_pos, tokenEnd - m_pos + (m_nextTokenType == Type::Tag ? 1 : 0));
-    m_pos = tokenEnd + (m_nextTokenType == Type::Tag ? 1 : 0);
+    m_nextToken = buffer.mid(m_pos, tokenEnd - m_pos + (m_nextTokenType == Type::Tag ? 1 : 0));
+    m_pos = int(tokenEnd + (m_nextTokenType == Type::Tag ? 1 : 0));
 }
 
-TextHandler::Type TextHandler::nextTokenType(const QString &string, int currentPos, const QString &currentToken, Type currentTokenType) const
+TextHandler::Type TextHandler::nextTokenType(QStringView string, int currentPos, QStringView currentToken, Type currentTokenType) const
 {
     if (currentPos >= string.length()) {
         // This is to stop the function accessing an index outside the length of
         // string during the final loop.
         return Type::End;
-    } else if (currentTokenType == Type::Tag && getTagType(currentToken) == u"code"_s && !isCloseTag(currentToken)
-               && string.indexOf(u"</code>"_s, currentPos) != currentPos) {
+    } else if (currentTokenType == Type::Tag && getTagType(currentToken) == "code"_L1 && !isCloseTag(currentToken)
+               && !string.sliced(currentPos).startsWith(u"</code>")) {
         return Type::TextCode;
-    } else if (string[currentPos] == u'<' && string[currentPos + 1] != u' ') {
+    } else if (string[currentPos] == u'<' && (currentPos + 1 >= string.length() || string[currentPos + 1] != u' ')) {
         return Type::Tag;
     } else {
         return Type::Text;
@@ -299,7 +372,7 @@ int TextHandler::nextBlockPos(const QString &string)
             if (pos == -1) {
                 pos = string.size();
             } else {
-                const auto tagType = getTagType(string.mid(pos, string.indexOf(u'>', pos) - pos));
+                const auto tagType = getTagType(QStringView(string).mid(pos, string.indexOf(u'>', pos) - pos));
                 if (blockTags.contains(tagType)) {
                     return pos;
                 }
@@ -311,7 +384,7 @@ int TextHandler::nextBlockPos(const QString &string)
 
     int tagEndPos = string.indexOf(u'>');
     QString tag = string.first(tagEndPos + 1);
-    QString tagType = getTagType(tag);
+    QString tagType = getTagType(tag).toString();
     // If the start tag is not a block tag there can be only 1 block.
     if (!blockTags.contains(tagType)) {
         return string.size();
@@ -340,7 +413,7 @@ MessageComponent TextHandler::nextBlock(const QString &string,
 
     int tagEndPos = string.indexOf(u'>');
     QString tag = string.first(tagEndPos + 1);
-    QString tagType = getTagType(tag);
+    QString tagType = getTagType(tag).toString();
     const auto messageComponentType = MessageComponentType::typeForTag(tagType);
     QVariantMap attributes;
     if (messageComponentType == MessageComponentType::Code) {
@@ -349,14 +422,16 @@ MessageComponent TextHandler::nextBlock(const QString &string,
 
     auto content = stripBlockTags(string.first(nextBlockPos), tagType);
     setData(content);
+    QList<QUrl> links;
     switch (messageComponentType) {
     case MessageComponentType::Code:
         content = unescapeHtml(content);
         break;
     default:
         content = handleRecieveRichText(inputFormat, room, event, false, isEdited);
+        links = std::exchange(m_links, {});
     }
-    return MessageComponent{messageComponentType, content, attributes};
+    return MessageComponent{messageComponentType, content, attributes, links};
 }
 
 QString TextHandler::stripBlockTags(QString string, const QString &tagType) const
@@ -398,56 +473,51 @@ QString TextHandler::stripBlockTags(QString string, const QString &tagType) cons
     return string;
 }
 
-QString TextHandler::getTagType(const QString &tagToken) const
+QStringView TextHandler::getTagType(QStringView tagToken) const
 {
-    if (tagToken.isEmpty() || tagToken.length() < 2) {
-        return QString();
+    if (tagToken.length() < 2) {
+        return {};
     }
-    const int tagTypeStart = tagToken[1] == u'/' ? 2 : 1;
-    const int tagTypeEnd = tagToken.indexOf(TextRegex::endTagType, tagTypeStart);
-    return tagToken.mid(tagTypeStart, tagTypeEnd - tagTypeStart);
+    const qsizetype tagTypeStart = tagToken[1] == u'/' ? 2 : 1;
+    const qsizetype tagTypeEnd = indexOfAny(tagToken, u"> /", tagTypeStart);
+    if (tagTypeEnd == -1) {
+        return tagToken.sliced(tagTypeStart);
+    }
+    return tagToken.sliced(tagTypeStart, tagTypeEnd - tagTypeStart);
 }
 
-bool TextHandler::isCloseTag(const QString &tagToken) const
+bool TextHandler::isCloseTag(QStringView tagToken) const
 {
-    if (tagToken.isEmpty()) {
-        return false;
-    }
-    return tagToken[1] == u'/';
+    return tagToken.length() > 1 && tagToken[1] == u'/';
 }
 
-QString TextHandler::getAttributeType(const QString &string)
+QStringView TextHandler::getAttributeType(QStringView string)
 {
-    if (!string.contains(u'=')) {
+    const qsizetype equalsPos = string.indexOf(u'=');
+    if (equalsPos == -1) {
         return string;
     }
-    const int equalsPos = string.indexOf(u'=');
-    return string.left(equalsPos);
+    return string.first(equalsPos);
 }
 
-QString TextHandler::getAttributeData(const QString &string, bool stripQuotes)
+QString TextHandler::getAttributeData(QStringView string, bool stripQuotes)
 {
-    if (!string.contains(u'=')) {
+    const qsizetype equalsPos = string.indexOf(u'=');
+    if (equalsPos == -1) {
         return QString();
     }
-    const int equalsPos = string.indexOf(u'=');
-    auto data = string.right(string.length() - equalsPos - 1);
+    const auto data = string.sliced(equalsPos + 1);
     if (stripQuotes) {
-        data = TextRegex::attributeData.match(data).captured(1);
+        return TextRegex::attributeData.matchView(data).captured(1);
     }
-    return data;
+    return data.toString();
 }
 
-bool TextHandler::isAllowedTag(const QString &type)
+bool TextHandler::isAllowedTag(QStringView type)
 {
     return allowedTags.contains(type);
 }
 
-bool TextHandler::isAllowedAttribute(const QString &tag, const QString &attribute)
-{
-    return allowedAttributes[tag].contains(attribute);
-}
-
 bool TextHandler::isAllowedLink(const QString &link, bool isImg)
 {
     const QUrl linkUrl = QUrl(link);
@@ -459,53 +529,56 @@ bool TextHandler::isAllowedLink(const QString &link, bool isImg)
     }
 }
 
-QString TextHandler::cleanAttributes(const QString &tag, const QString &tagString)
+QString TextHandler::cleanAttributes(QStringView tag, QStringView tagString)
 {
-    int nextAttributeIndex = tagString.indexOf(u' ', 1);
+    qsizetype nextAttributeIndex = tagString.indexOf(u' ', 1);
 
     if (nextAttributeIndex != -1) {
-        QString outputString = tagString.left(nextAttributeIndex);
-        QString nextAttribute;
-        int nextSpaceIndex;
+        QString outputString = tagString.first(nextAttributeIndex).toString();
+        const auto tagAllowedAttributes = allowedAttributes.value(tag.toString());
+        QStringView nextAttribute;
+        qsizetype nextSpaceIndex;
         nextAttributeIndex += 1;
 
         while (nextAttributeIndex < tagString.length()) {
-            nextSpaceIndex = tagString.indexOf(TextRegex::endAttributeType, nextAttributeIndex);
+            nextSpaceIndex = indexOfAny(tagString, u"> ", nextAttributeIndex);
             if (nextSpaceIndex == -1) {
                 nextSpaceIndex = tagString.length();
             }
-            nextAttribute = tagString.mid(nextAttributeIndex, nextSpaceIndex - nextAttributeIndex);
+            nextAttribute = tagString.sliced(nextAttributeIndex, nextSpaceIndex - nextAttributeIndex);
+            const auto attributeType = getAttributeType(nextAttribute);
 
-            if (isAllowedAttribute(tag, getAttributeType(nextAttribute))) {
+            if (tagAllowedAttributes.contains(attributeType)) {
                 QString style;
-                if (tag == u"img"_s && getAttributeType(nextAttribute) == u"src"_s) {
-                    QString attributeData = TextRegex::attributeData.match(getAttributeData(nextAttribute)).captured(1);
-                    if (isAllowedLink(attributeData, true)) {
-                        outputString.append(u' ' + nextAttribute);
+                if (tag == "img"_L1 && attributeType == "src"_L1) {
+                    if (isAllowedLink(getAttributeData(nextAttribute, true), true)) {
+                        outputString.append(u' ');
+                        outputString.append(nextAttribute);
                     }
-                } else if (tag == u'a' && getAttributeType(nextAttribute) == u"href"_s) {
-                    QString attributeData = TextRegex::attributeData.match(getAttributeData(nextAttribute)).captured(1);
-                    if (isAllowedLink(attributeData)) {
-                        outputString.append(u' ' + nextAttribute);
+                } else if (tag == "a"_L1 && attributeType == "href"_L1) {
+                    if (const auto href = getAttributeData(nextAttribute, true); isAllowedLink(href)) {
+                        outputString.append(u' ');
+                        outputString.append(nextAttribute);
+                        addLink(href);
                     }
-                } else if (tag == u"code"_s && getAttributeType(nextAttribute) == u"class"_s) {
+                } else if (tag == "code"_L1 && attributeType == "class"_L1) {
                     if (getAttributeData(nextAttribute).remove(u'"').startsWith(u"language-"_s)) {
-                        outputString.append(u' ' + nextAttribute);
+                        outputString.append(u' ');
+                        outputString.append(nextAttribute);
                     }
-                } else if (tag == u"img"_s && getAttributeType(nextAttribute) == u"style"_s) {
-                    const QString attributeData = TextRegex::attributeData.match(getAttributeData(nextAttribute)).captured(1);
+                } else if (tag == "img"_L1 && attributeType == "style"_L1) {
                     // Ignore every other style attribute except for our own, which we use to align custom emoticons
-                    if (attributeData == customEmojiStyle) {
-                        outputString.append(u' ' + nextAttribute);
+                    if (getAttributeData(nextAttribute, true) == customEmojiStyle) {
+                        outputString.append(u' ');
+                        outputString.append(nextAttribute);
                     }
-                } else if (getAttributeType(nextAttribute) == u"data-mx-color"_s) {
-                    const QString attributeData = TextRegex::attributeData.match(getAttributeData(nextAttribute)).captured(1);
-                    style.append(u"color: "_s + attributeData + u';');
-                } else if (getAttributeType(nextAttribute) == u"data-mx-bg-color"_s) {
-                    const QString attributeData = TextRegex::attributeData.match(getAttributeData(nextAttribute)).captured(1);
-                    style.append(u"background-color: "_s + attributeData + u';');
+                } else if (attributeType == "data-mx-color"_L1) {
+                    style.append(u"color: "_s + getAttributeData(nextAttribute, true) + u';');
+                } else if (attributeType == "data-mx-bg-color"_L1) {
+                    style.append(u"background-color: "_s + getAttributeData(nextAttribute, true) + u';');
                 } else {
-                    outputString.append(u' ' + nextAttribute);
+                    outputString.append(u' ');
+                    outputString.append(nextAttribute);
                 }
 
                 if (!style.isEmpty()) {
@@ -519,43 +592,57 @@ QString TextHandler::cleanAttributes(const QString &tag, const QString &tagStrin
         return outputString;
     }
 
-    return tagString;
+    return tagString.toString();
 }
 
-QVariantMap TextHandler::getAttributes(const QString &tag, const QString &tagString)
+void TextHandler::addLink(const QString &href)
+{
+    // Only http(s) and www links are previewed and matrix.to links are shown as pills instead.
+    const auto match = TextRegex::url.match(href);
+    if (!match.hasMatch() || match.captured().contains(u"matrix.to"_s)) {
+        return;
+    }
+    const QUrl link(match.captured());
+    if (!m_linkSet.contains(link)) {
+        m_linkSet.insert(link);
+        m_links.append(link);
+    }
+}
+
+QVariantMap TextHandler::getAttributes(QStringView tag, QStringView tagString)
 {
     QVariantMap attributes;
-    int nextAttributeIndex = tagString.indexOf(u' ', 1);
+    qsizetype nextAttributeIndex = tagString.indexOf(u' ', 1);
 
     if (nextAttributeIndex != -1) {
-        QString nextAttribute;
-        int nextSpaceIndex;
+        const auto tagAllowedAttributes = allowedAttributes.value(tag.toString());
+        QStringView nextAttribute;
+        qsizetype nextSpaceIndex;
         nextAttributeIndex += 1;
 
         while (nextAttributeIndex < tagString.length()) {
-            nextSpaceIndex = tagString.indexOf(TextRegex::endAttributeType, nextAttributeIndex);
+            nextSpaceIndex = indexOfAny(tagString, u"> ", nextAttributeIndex);
             if (nextSpaceIndex == -1) {
                 nextSpaceIndex = tagString.length();
             }
-            nextAttribute = tagString.mid(nextAttributeIndex, nextSpaceIndex - nextAttributeIndex);
+            nextAttribute = tagString.sliced(nextAttributeIndex, nextSpaceIndex - nextAttributeIndex);
+            const auto attributeType = getAttributeType(nextAttribute);
 
-            if (isAllowedAttribute(tag, getAttributeType(nextAttribute))) {
-                if (tag == u"img"_s && getAttributeType(nextAttribute) == u"src"_s) {
-                    QString attributeData = TextRegex::attributeData.match(getAttributeData(nextAttribute)).captured(1);
-                    if (isAllowedLink(attributeData, true)) {
-                        attributes[getAttributeType(nextAttribute)] = getAttributeData(nextAttribute, true);
+            if (tagAllowedAttributes.contains(attributeType)) {
+                if (tag == "img"_L1 && attributeType == "src"_L1) {
+                    if (isAllowedLink(getAttributeData(nextAttribute, true), true)) {
+                        attributes[attributeType.toString()] = getAttributeData(nextAttribute, true);
                     }
-                } else if (tag == u'a' && getAttributeType(nextAttribute) == u"href"_s) {
-                    QString attributeData = TextRegex::attributeData.match(getAttributeData(nextAttribute)).captured(1);
-                    if (isAllowedLink(attributeData)) {
-                        attributes[getAttributeType(nextAttribute)] = getAttributeData(nextAttribute, true);
+                } else if (tag == "a"_L1 && attributeType == "href"_L1) {
+                    if (isAllowedLink(getAttributeData(nextAttribute, true))) {
+                        attributes[attributeType.toString()] = getAttributeData(nextAttribute, true);
                     }
-                } else if (tag == u"code"_s && getAttributeType(nextAttribute) == u"class"_s) {
+                } else if (tag == "code"_L1 && attributeType == "class"_L1) {
                     if (getAttributeData(nextAttribute).remove(u'"').startsWith(u"language-"_s)) {
-                        attributes[getAttributeType(nextAttribute)] = convertCodeLanguageString(getAttributeData(nextAttribute, true));
+                        attributes[attributeType.toString()] = convertCodeLanguageString(getAttributeData(nextAttribute, true));
                     }
                 } else {
-                    attributes[getAttributeType(nextAttribute)] = getAttributeData(nextAttribute, true);
+                    attributes[attributeType.toString()] = getAttributeData(nextAttribute, true);
                 }
             }
             nextAttributeIndex = nextSpaceIndex + 1;
@@ -648,12 +735,24 @@ QString TextHandler::unescapeHtml(QString stringIn)
 
 QString TextHandler::linkifyUrls(QString stringIn)
 {
+    // Whether the given index is outside of any <code> block. The tags before the
+    // index are counted incrementally as the index only ever moves forward and
+    // nothing replaced before it contains a code tag.
+    qsizetype countedTo = 0;
+    qsizetype codeTagBalance = 0;
+    const auto isOutsideCode = [&stringIn, &countedTo, &codeTagBalance](qsizetype index) {
+        const auto counted = QStringView(stringIn).sliced(countedTo, index - countedTo);
+        codeTagBalance += counted.count(u"<code>") - counted.count(u"</code>");
+        countedTo = index;
+        return codeTagBalance == 0;
+    };
+
     QRegularExpressionMatch match;
     int start = 0;
     for (int index = 0; index != -1; index = stringIn.indexOf(TextRegex::mxId, start, &match)) {
         int skip = 0;
         if (match.captured(0).size() > 0) {
-            if (stringIn.left(index).count(u"<code>"_s) == stringIn.left(index).count(u"</code>"_s)) {
+            if (isOutsideCode(index)) {
                 auto replacement = u"<a href=\"https://matrix.to/#/%1\">%1</a>"_s.arg(match.captured(1));
                 stringIn = stringIn.replace(index, match.captured(0).size(), replacement);
             } else {
@@ -665,10 +764,12 @@ QString TextHandler::linkifyUrls(QString stringIn)
     }
     start = 0;
     match = {};
+    countedTo = 0;
+    codeTagBalance = 0;
     for (int index = 0; index != -1; index = stringIn.indexOf(TextRegex::plainUrl, start, &match)) {
         int skip = 0;
         if (match.captured(0).size() > 0) {
-            if (stringIn.left(index).count(u"<code>"_s) == stringIn.left(index).count(u"</code>"_s)) {
+            if (isOutsideCode(index)) {
                 auto replacement = u"<a href=\"%1\">%1</a>"_s.arg(match.captured(1));
                 stringIn = stringIn.replace(index, match.captured(0).size(), replacement);
                 skip = replacement.length();
@@ -681,10 +782,12 @@ QString TextHandler::linkifyUrls(QString stringIn)
     }
     start = 0;
     match = {};
+    countedTo = 0;
+    codeTagBalance = 0;
     for (int index = 0; index != -1; index = stringIn.indexOf(TextRegex::emailAddress, start, &match)) {
         int skip = 0;
         if (match.captured(0).size() > 0) {
-            if (stringIn.left(index).count(u"<code>"_s) == stringIn.left(index).count(u"</code>"_s)) {
+            if (isOutsideCode(index)) {
                 auto replacement = u"<a href=\"mailto:%1\">%1</a>"_s.arg(match.captured(2));
                 stringIn = stringIn.replace(index, match.captured(0).size(), replacement);
                 skip = replacement.length();
@@ -4,7 +4,9 @@
 #pragma once
 
 #include <QObject>
+#include <QSet>
 #include <QString>
+#include <QUrl>
 
 #include "messagecomponent.h"
 #include "neochatroom.h"
@@ -111,10 +113,17 @@ private:
     QString m_dataBuffer;
     int m_pos;
     Type m_nextTokenType = Text;
-    QString m_nextToken;
+    // A view into m_dataBuffer, only valid while m_dataBuffer is unchanged.
+    QStringView m_nextToken;
 
+    // The previewable links found by the last call to handleRecieveRichText().
+    QList<QUrl> m_links;
+    QSet<QUrl> m_linkSet;
+    void addLink(const QString &href);
+
+    void startTokens();
     void next();
-    Type nextTokenType(const QString &string, int currentPos, const QString &currentToken, Type currentTokenType) const;
+    Type nextTokenType(QStringView string, int currentPos, QStringView currentToken, Type currentTokenType) const;
 
     int nextBlockPos(const QString &string);
     MessageComponent nextBlock(const QString &string,
@@ -125,15 +134,14 @@ private:
                                bool isEdited = false);
     QString stripBlockTags(QString string, const QString &tagType) const;
 
-    QString getTagType(const QString &tagToken) const;
-    bool isCloseTag(const QString &tagToken) const;
-    QString getAttributeType(const QString &string);
-    QString getAttributeData(const QString &string, bool stripQuotes = false);
-    bool isAllowedTag(const QString &type);
-    bool isAllowedAttribute(const QString &tag, const QString &attribute);
+    QStringView getTagType(QStringView tagToken) const;
+    bool isCloseTag(QStringView tagToken) const;
+    QStringView getAttributeType(QStringView string);
+    QString getAttributeData(QStringView string, bool stripQuotes = false);
+    bool isAllowedTag(QStringView type);
     bool isAllowedLink(const QString &link, bool isImg = false);
-    QString cleanAttributes(const QString &tag, const QString &tagString);
-    QVariantMap getAttributes(const QString &tag, const QString &tagString);
+    QString cleanAttributes(QStringView tag, QStringView tagString);
+    QVariantMap getAttributes(QStringView tag, QStringView tagString);
 
     QString markdownToHTML(const QString &markdown);
     QString escapeHtml(QString stringIn);
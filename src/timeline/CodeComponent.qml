@@ -58,7 +58,7 @@ QQC2.Control {
     Layout.maximumHeight: Kirigami.Units.gridUnit * 20
 
     topPadding: 0
-    bottomPadding: 0
+    bottomPadding: truncatedNote.visible ? truncatedNote.implicitHeight : 0
     leftPadding: 0
     rightPadding: 0
 
@@ -140,11 +140,28 @@ QQC2.Control {
         anchors {
             top: root.top
             bottom: root.bottom
+            bottomMargin: root.bottomPadding
             left: root.left
             leftMargin: lineNumberColumn.width + lineNumberColumn.anchors.leftMargin + Kirigami.Units.smallSpacing
         }
     }
 
+    QQC2.Label {
+        id: truncatedNote
+        anchors {
+            left: root.left
+            right: root.right
+            bottom: root.bottom
+        }
+        // Set for text file previews that only show the start of a long file.
+        visible: root.componentAttributes.truncated === true
+        padding: Kirigami.Units.smallSpacing
+        text: i18nc("@info", "Only the start of the file is shown.")
+        wrapMode: Text.Wrap
+        horizontalAlignment: Text.AlignHCenter
+        color: Kirigami.Theme.disabledTextColor
+    }
+
     RowLayout {
         anchors {
             top: parent.top
@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "uploadpreview.h"
+
+#include <QBuffer>
+#include <QImageReader>
+
+#include "backgroundtask.h"
+#include "blurhash.h"
+
+using namespace Qt::StringLiterals;
+
+namespace
+{
+bool fits(const QSize &size)
+{
+    return size.width() <= UploadPreview::MaxThumbnailSize && size.height() <= UploadPreview::MaxThumbnailSize;
+}
+
+void fillThumbnail(UploadPreview::Preview &preview, const QImage &image)
+{
+    if (fits(preview.size)) {
+        return;
+    }
+
+    // The image may already have been decoded at thumbnail size.
+    const auto thumbnail =
+        fits(image.size()) ? image : image.scaled(UploadPreview::MaxThumbnailSize, UploadPreview::MaxThumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    QBuffer buffer(&preview.thumbnail);
+    buffer.open(QIODevice::WriteOnly);
+    // Keep transparency, otherwise JPEG is much smaller for photos.
+    const auto hasAlpha = thumbnail.hasAlphaChannel();
+    if (!thumbnail.save(&buffer, hasAlpha ? "png" : "jpeg", hasAlpha ? -1 : 80)) {
+        preview.thumbnail.clear();
+        return;
+    }
+    preview.thumbnailMimeType = hasAlpha ? u"image/png"_s : u"image/jpeg"_s;
+    preview.thumbnailSize = thumbnail.size();
+}
+
+UploadPreview::Preview imagePreview(const QImage &image)
+{
+    UploadPreview::Preview preview;
+    if (image.isNull()) {
+        return preview;
+    }
+    preview.size = image.size();
+    fillThumbnail(preview, image);
+    preview.blurhash = UploadPreview::blurhash(image);
+    return preview;
+}
+
+UploadPreview::Preview imageFilePreview(const QString &path)
+{
+    QImageReader reader(path);
+    reader.setAutoTransform(true);
+
+    // This only reads the header, the size is before any EXIF rotation is applied.
+    const auto storedSize = reader.size();
+    if (!storedSize.isValid()) {
+        // Some formats can't report a size without decoding the image.
+        return imagePreview(reader.read());
+    }
+
+    UploadPreview::Preview preview;
+    preview.size = reader.transformation() & QImageIOHandler::TransformationRotate90 ? storedSize.transposed() : storedSize;
+
+    // Let the decoder produce a thumbnail sized image directly, e.g. JPEG can
+    // skip most of the work of decoding a full size photo.
+    if (reader.supportsOption(QImageIOHandler::ScaledSize) && !fits(storedSize)) {
+        reader.setScaledSize(storedSize.scaled(UploadPreview::MaxThumbnailSize, UploadPreview::MaxThumbnailSize, Qt::KeepAspectRatio));
+    }
+    const auto image = reader.read();
+    if (image.isNull()) {
+        return preview;
+    }
+
+    fillThumbnail(preview, image);
+    preview.blurhash = UploadPreview::blurhash(image);
+    return preview;
+}
+}
+
+QFuture<UploadPreview::Preview> UploadPreview::forImageFile(const QString &path)
+{
+    return BackgroundTask::run([path]() {
+        return imageFilePreview(path);
+    });
+}
+
+QFuture<UploadPreview::Preview> UploadPreview::forImage(const QImage &image)
+{
+    return BackgroundTask::run([image]() {
+        return imagePreview(image);
+    });
+}
+
+QString UploadPreview::blurhash(const QImage &image)
+{
+    if (image.isNull()) {
+        return {};
+    }
+
+    // The blurhash only holds a handful of components so a tiny image gives the
+    // same result as the full size one.
+    const auto source = image.scaled(BlurhashSourceSize, BlurhashSourceSize, Qt::KeepAspectRatio, Qt::SmoothTransformation).convertToFormat(QImage::Format_RGB888);
+    // More components along the longer side.
+    const auto xComponents = source.width() >= source.height() ? 4 : 3;
+    const auto yComponents = source.width() >= source.height() ? 3 : 4;
+    const auto hash = ::encode(source.constBits(), source.width(), source.height(), source.bytesPerLine(), 3, xComponents, yComponents);
+    return QString::fromLatin1(hash.data(), hash.size());
+}
@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QByteArray>
+#include <QFuture>
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+/**
+ * @brief Generate the thumbnail and blurhash for a file being uploaded.
+ *
+ * All the work is done on a thread pool thread so that decoding a large image
+ * doesn't block the GUI.
+ */
+namespace UploadPreview
+{
+
+/**
+ * @brief The largest dimension of a generated thumbnail.
+ *
+ * No thumbnail is generated for images that already fit within this.
+ */
+constexpr int MaxThumbnailSize = 800;
+
+/**
+ * @brief The largest dimension of the image the blurhash is calculated from.
+ */
+constexpr int BlurhashSourceSize = 32;
+
+struct Preview {
+    /**
+     * @brief The size of the original image or video frame.
+     */
+    QSize size;
+
+    /**
+     * @brief The encoded thumbnail, empty if no thumbnail is needed.
+     */
+    QByteArray thumbnail;
+    QString thumbnailMimeType;
+    QSize thumbnailSize;
+
+    QString blurhash;
+};
+
+/**
+ * @brief Generate the preview for the image file at the given path.
+ *
+ * The size is read from the image header and the image is decoded directly at
+ * thumbnail size where the format supports it.
+ */
+QFuture<Preview> forImageFile(const QString &path);
+
+/**
+ * @brief Generate the preview for an already decoded image, e.g. a video frame.
+ */
+QFuture<Preview> forImage(const QImage &image);
+
+/**
+ * @brief Calculate the blurhash for the given image.
+ *
+ * The image is scaled to BlurhashSourceSize first. Empty if the image is null.
+ */
+QString blurhash(const QImage &image);
+}